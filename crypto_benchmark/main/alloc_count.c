@@ -0,0 +1,73 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "alloc_count.h"
+
+static volatile uint32_t s_allocs;
+
+#if CONFIG_IDF_TARGET_LINUX
+
+/* Resolved by the linker to the libc functions (-Wl,--wrap=..., see CMakeLists.txt) */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+bool alloc_count_available(void)
+{
+    return true;
+}
+
+#else
+
+#include "esp_heap_caps.h"
+
+#if CONFIG_HEAP_USE_HOOKS
+/* Called by the heap for every successful allocation (may run in an ISR) */
+void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    (void)ptr;
+    (void)size;
+    (void)caps;
+    __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+}
+
+void esp_heap_trace_free_hook(void *ptr)
+{
+    (void)ptr;
+}
+#endif
+
+bool alloc_count_available(void)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
+
+uint32_t alloc_count(void)
+{
+    return __atomic_load_n(&s_allocs, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,12 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <stdbool.h>
+#include <stdint.h>   // uint32_t
+
+// Heap allocations made since boot (malloc / calloc / realloc, any task).
+// ESP32: heap hooks (CONFIG_HEAP_USE_HOOKS); linux: ld --wrap of libc.
+uint32_t alloc_count(void);
+bool     alloc_count_available(void);
+
+#endif // ALLOC_COUNT_H
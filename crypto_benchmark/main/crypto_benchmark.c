@@ -0,0 +1,444 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_idf_version.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "aes_cbc.h"
+#include "pkcs_7.h"
+#include "hashes.h"
+#include "sha_backend.h"
+#include "sha256_mb.h"
+#include "merkle.h"
+#include "hkdf.h"
+#include "alloc_count.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>              // __rdtsc()
+#endif
+#else
+#include "esp_timer.h"
+#include "esp_cpu.h"                // esp_cpu_get_cycle_count()
+#endif
+
+static const char *TAG = "CRYPTO_BENCH";
+
+/* One CSV row per (operation, key size, message size). Rows start with
+ * "csv," so they can be cut out of the monitor / stdout log:
+ *
+ *     idf.py monitor | grep '^csv,' > esp32.csv
+ *     ./build/crypto_benchmark.elf | grep '^csv,' > host.csv
+ *
+ * msgs_per_s: calls per second, the figure to read for short messages.
+ * cycles_per_byte: CPU cycles on the ESP32 (CCOUNT), TSC ticks on an x86
+ * host, empty where no cycle counter is available.
+ * allocs_per_op: heap allocations inside the measured call, empty if the
+ * build cannot count them.
+ */
+#define BENCH_MIN_SIZE     16
+#define BENCH_MAX_SIZE     (1024 * 1024)
+#define BENCH_MIN_ITERS    3
+#define BENCH_MIN_NS       200000000ull   // run every case for at least 200 ms
+#define BENCH_MAX_ITERS    100000
+
+typedef enum {
+    OP_CBC_ENCRYPT,
+    OP_CBC_DECRYPT,
+    OP_PKCS7_PAD,
+    OP_PKCS7_UNPAD,
+    OP_SHA1,
+    OP_SHA256,
+    OP_SHA256_MBEDTLS,
+    OP_SHA512,
+    OP_HASH_SHA256_CHUNKED,
+    OP_HASH_SHA512_CHUNKED,
+    OP_SHA256_BATCH_LOOP,
+    OP_SHA256_BATCH_MB,
+    OP_MERKLE_UPDATE,
+    OP_HKDF_SHA256,
+    OP_HMAC_SHA256,
+    OP_HMAC_SHA256_MIDSTATE,
+} bench_op_t;
+
+static const struct {
+    bench_op_t op;
+    const char *name;
+    bool keyed;                      // run once per AES key size
+    bool short_msgs;                 // also run at s_short_sizes (per-message cost)
+} s_ops[] = {
+    { OP_CBC_ENCRYPT, "aes_cbc_encrypt_pkcs7", true, false },
+    { OP_CBC_DECRYPT, "aes_cbc_decrypt_pkcs7", true, false },
+    { OP_PKCS7_PAD,   "pkcs7_pad_16",          false, false },
+    { OP_PKCS7_UNPAD, "pkcs7_unpad_16",        false, false },
+    { OP_SHA1,        "sha1_stream",           false, false },
+    { OP_SHA256,      "sha256_stream",         false, false },   // selected SHA backend
+    { OP_SHA256_MBEDTLS, "sha256_mbedtls",     false, false },   // portable path, for comparison
+    { OP_SHA512,      "sha512_stream",         false, false },
+    { OP_HASH_SHA256_CHUNKED, "hash_update_sha256", false, false },   // 4 KB chunks, reused context
+    { OP_HASH_SHA512_CHUNKED, "hash_update_sha512", false, false },
+    { OP_SHA256_BATCH_LOOP, "sha256_stream_x16", false, false },  // msg split in 16 messages, one by one
+    { OP_SHA256_BATCH_MB,   "sha256_mb_x16",     false, false },  // same 16 messages, multi-buffer
+    { OP_MERKLE_UPDATE, "merkle_update_4k",    false, false },   // new root after one 4 KB leaf changed
+    { OP_HKDF_SHA256, "hkdf_sha256",           false, false },   // size = IKM length, 32-byte OKM
+    { OP_HMAC_SHA256, "hmac_sha256",           false, true },   // 32-byte key, key blocks every call
+    { OP_HMAC_SHA256_MIDSTATE, "hmac_sha256_midstate", false, true },  // same key, cached midstates
+};
+
+static const unsigned s_keybits[] = { 128, 192, 256 };
+
+// Tokens / short records between the x4 steps of the sweep (16 and 64 are in it)
+static const size_t s_short_sizes[] = { 32, 48 };
+
+#define BENCH_HASH_CHUNK   4096     // hash_update() chunk: one flash sector at a time
+#define BENCH_MB_BATCH     16       // messages per multi-buffer batch, size / 16 bytes each
+#define BENCH_MERKLE_LEAF  4096
+
+/* Inputs of the current size, prepared outside the timed loop */
+typedef struct {
+    size_t size;
+    unsigned keybits;
+    uint8_t key[32];
+    uint8_t iv[16];
+    uint8_t *msg;                    // size bytes
+    uint8_t *ct;                     // CBC ciphertext of msg (decrypt input)
+    size_t ct_len;
+    uint8_t *padded;                 // msg + PKCS#7 padding (unpad input)
+    size_t padded_len;
+} bench_case_t;
+
+static uint64_t now_ns(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)esp_timer_get_time() * 1000ull;
+#endif
+}
+
+/* Cycle counter, 0 if there is none. The ESP32 counter is 32 bits
+ * (wraps every ~17 s at 240 MHz): only differences of short runs are used.
+ */
+static uint64_t now_cycles(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    return esp_cpu_get_cycle_count();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static bool have_cycles(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX || defined(__x86_64__) || defined(__i386__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* Incremental hash of c->msg in BENCH_HASH_CHUNK pieces. The context is
+ * set up once and only reset per message, as a long-lived user would.
+ */
+static void hash_chunked(hash_alg_t alg, const bench_case_t *c, uint8_t *digest)
+{
+    static hash_ctx_t ctx[2];
+    static bool ready[2];
+    int i = (alg == HASH_SHA256) ? 0 : 1;
+
+    if (!ready[i]) {
+        hash_init(&ctx[i], alg);
+        ready[i] = true;
+    } else {
+        hash_reset(&ctx[i]);
+    }
+    for (size_t off = 0; off < c->size; off += BENCH_HASH_CHUNK) {
+        size_t n = c->size - off;
+        hash_update(&ctx[i], c->msg + off, n < BENCH_HASH_CHUNK ? n : BENCH_HASH_CHUNK);
+    }
+    hash_finish(&ctx[i], digest);
+}
+
+/* c->msg cut into BENCH_MB_BATCH equal messages (the remainder is not
+ * hashed), hashed either one by one or in one sha256_mb() call.
+ */
+static int sha256_batch(const bench_case_t *c, bool multi_buffer)
+{
+    static uint8_t digests[BENCH_MB_BATCH][32];
+    sha256_mb_job_t jobs[BENCH_MB_BATCH];
+    size_t len = c->size / BENCH_MB_BATCH;
+
+    if (!multi_buffer) {
+        int ret = 0;
+        for (size_t i = 0; i < BENCH_MB_BATCH && ret == 0; i++) {
+            ret = sha256_stream(c->msg + i * len, len, digests[i]);
+        }
+        return ret;
+    }
+
+    for (size_t i = 0; i < BENCH_MB_BATCH; i++) {
+        jobs[i].data = c->msg + i * len;
+        jobs[i].len = len;
+        jobs[i].out = digests[i];
+    }
+    return sha256_mb(jobs, BENCH_MB_BATCH);
+}
+
+/* Keep the digest of c->msg current after its middle leaf was rewritten.
+ * The tree is built on the first (untimed) call for each message, so the
+ * row compares with sha256_stream of the same size: bytes covered per op.
+ */
+static int merkle_update_mid(const bench_case_t *c)
+{
+    static merkle_tree_t tree;
+    static uint8_t *nodes;
+    static const uint8_t *built_for;
+
+    if (built_for != c->msg || tree.blob_len != c->size) {
+        size_t nodes_size = merkle_nodes_size(c->size, BENCH_MERKLE_LEAF);
+        free(nodes);
+        nodes = malloc(nodes_size);
+        built_for = NULL;
+        if (nodes == NULL ||
+            merkle_init(&tree, c->size, BENCH_MERKLE_LEAF, nodes, nodes_size) != 0 ||
+            merkle_build(&tree, c->msg) != 0) {
+            return -1;
+        }
+        built_for = c->msg;
+    }
+
+    size_t off = (tree.n_leaves / 2) * BENCH_MERKLE_LEAF;
+    size_t len = c->size - off < BENCH_MERKLE_LEAF ? c->size - off : BENCH_MERKLE_LEAF;
+    return merkle_update(&tree, off, c->msg + off, len);
+}
+
+/* MAC with the midstates of c->key, computed once per key */
+static int hmac_midstate(const bench_case_t *c, uint8_t *mac)
+{
+    static hmac_sha256_key_t k;
+    static uint8_t keyed_with[32];
+    static bool ready;
+
+    if (!ready || memcmp(keyed_with, c->key, sizeof(keyed_with)) != 0) {
+        if (ready) {
+            hmac_sha256_key_free(&k);
+        }
+        ready = (hmac_sha256_key_init(&k, c->key, sizeof(c->key)) == 0);
+        if (!ready) {
+            return -1;
+        }
+        memcpy(keyed_with, c->key, sizeof(keyed_with));
+    }
+    return hmac_sha256_key_mac(&k, c->msg, c->size, mac);
+}
+
+/* One call of the operation under test; outputs are freed as the caller of
+ * the API would, so their allocation shows up in allocs_per_op.
+ */
+static int run_once(bench_op_t op, const bench_case_t *c)
+{
+    uint8_t *out = NULL;
+    size_t out_len = 0;
+    uint8_t digest[64];
+    int ret = 0;
+
+    switch (op) {
+    case OP_CBC_ENCRYPT:
+        ret = aes_cbc_encrypt_pkcs7(c->key, c->keybits, c->iv, c->msg, c->size, &out, &out_len);
+        break;
+    case OP_CBC_DECRYPT:
+        ret = aes_cbc_decrypt_pkcs7(c->key, c->keybits, c->iv, c->ct, c->ct_len, &out, &out_len);
+        break;
+    case OP_PKCS7_PAD:
+        ret = pkcs7_pad_16(c->msg, c->size, &out, &out_len);
+        break;
+    case OP_PKCS7_UNPAD:
+        ret = pkcs7_unpad_16(c->padded, c->padded_len, &out, &out_len);
+        break;
+    case OP_SHA1:
+        ret = sha1_stream(c->msg, c->size, digest);
+        break;
+    case OP_SHA256:
+        ret = sha256_stream(c->msg, c->size, digest);
+        break;
+    case OP_SHA256_MBEDTLS:
+        ret = sha_backend_mbedtls.sha256(c->msg, c->size, digest);
+        break;
+    case OP_SHA512:
+        ret = sha512_stream(c->msg, c->size, digest);
+        break;
+    case OP_HASH_SHA256_CHUNKED:
+        hash_chunked(HASH_SHA256, c, digest);
+        break;
+    case OP_HASH_SHA512_CHUNKED:
+        hash_chunked(HASH_SHA512, c, digest);
+        break;
+    case OP_SHA256_BATCH_LOOP:
+        ret = sha256_batch(c, false);
+        break;
+    case OP_SHA256_BATCH_MB:
+        ret = sha256_batch(c, true);
+        break;
+    case OP_MERKLE_UPDATE:
+        ret = merkle_update_mid(c);
+        break;
+    case OP_HKDF_SHA256:
+        ret = hkdf_sha256(c->iv, sizeof(c->iv), c->msg, c->size,
+                          (const uint8_t *)"bench", 5, digest, 32);
+        break;
+    case OP_HMAC_SHA256:
+        ret = hmac_sha256(c->key, sizeof(c->key), c->msg, c->size, digest);
+        break;
+    case OP_HMAC_SHA256_MIDSTATE:
+        ret = hmac_midstate(c, digest);
+        break;
+    }
+
+    free(out);
+    return ret;
+}
+
+/* Time one case and print its CSV row */
+static int run_case(bench_op_t op, const char *name, const bench_case_t *c)
+{
+    unsigned iters = 0;
+    uint64_t ns = 0;
+    uint64_t cycles = 0;
+
+    if (run_once(op, c) != 0) {      // warm-up + sanity check
+        printf("# %s %u %zu failed\n", name, c->keybits, c->size);
+        return -1;
+    }
+
+    uint32_t a0 = alloc_count();
+    uint64_t t0 = now_ns();
+    uint64_t k0 = now_cycles();
+    do {
+        run_once(op, c);
+        iters++;
+        ns = now_ns() - t0;
+    } while ((iters < BENCH_MIN_ITERS || ns < BENCH_MIN_NS) && iters < BENCH_MAX_ITERS);
+#if CONFIG_IDF_TARGET_LINUX
+    cycles = now_cycles() - k0;
+#else
+    cycles = (uint32_t)((uint32_t)now_cycles() - (uint32_t)k0);
+    if (ns > 15000000000ull) {
+        cycles = 0;                  // counter wrapped at least once
+    }
+#endif
+    uint32_t allocs = alloc_count() - a0;
+
+    double bytes = (double)c->size * iters;
+    printf("csv,%s,%s,%u,%zu,%u,%.3f,%.0f,", CONFIG_IDF_TARGET, name, c->keybits, c->size, iters,
+           bytes * 1e3 / (double)ns,                        // bytes/ns * 1e3 = MB/s
+           (double)iters * 1e9 / (double)ns);
+    if (have_cycles() && cycles != 0) {
+        printf("%.2f,", (double)cycles / bytes);
+    } else {
+        printf(",");
+    }
+    if (alloc_count_available()) {
+        printf("%.2f\n", (double)allocs / iters);
+    } else {
+        printf("\n");
+    }
+    return 0;
+}
+
+static void case_free(bench_case_t *c)
+{
+    free(c->msg);
+    free(c->ct);
+    free(c->padded);
+    memset(c, 0, sizeof(*c));
+}
+
+/* Inputs for one message size; -1 if they do not fit in memory */
+static int case_prepare(bench_case_t *c, size_t size)
+{
+    memset(c, 0, sizeof(*c));
+    c->size = size;
+    esp_fill_random(c->key, sizeof(c->key));
+    esp_fill_random(c->iv, sizeof(c->iv));
+
+    c->msg = malloc(size);
+    if (c->msg == NULL) {
+        return -1;
+    }
+    esp_fill_random(c->msg, size);
+
+    if (pkcs7_pad_16(c->msg, size, &c->padded, &c->padded_len) != 0) {
+        case_free(c);
+        return -1;
+    }
+    return 0;
+}
+
+void app_main(void)
+{
+    bench_case_t c;
+
+    ESP_LOGI(TAG, "crypto micro-benchmarks, %u..%u bytes, ESP-IDF %s",
+             BENCH_MIN_SIZE, BENCH_MAX_SIZE, esp_get_idf_version());
+    ESP_LOGI(TAG, "sha256_mb kernel: %s, %d lanes", sha256_mb_kernel(), sha256_mb_lanes());
+    ESP_LOGI(TAG, "SHA backends: sha1 %s, sha256 %s, sha512 %s",
+             sha_backend_active(SHA_BACKEND_SHA1)->name,
+             sha_backend_active(SHA_BACKEND_SHA256)->name,
+             sha_backend_active(SHA_BACKEND_SHA512)->name);
+    printf("csv,target,op,key_bits,size,iterations,mb_per_s,msgs_per_s,cycles_per_byte,allocs_per_op\n");
+
+    for (size_t size = BENCH_MIN_SIZE; size <= BENCH_MAX_SIZE; size *= 4) {
+        if (case_prepare(&c, size) != 0) {
+            printf("# size %zu skipped: out of memory\n", size);
+            continue;
+        }
+
+        for (size_t o = 0; o < sizeof(s_ops) / sizeof(s_ops[0]); o++) {
+            size_t nkeys = s_ops[o].keyed ? sizeof(s_keybits) / sizeof(s_keybits[0]) : 1;
+
+            for (size_t k = 0; k < nkeys; k++) {
+                c.keybits = s_ops[o].keyed ? s_keybits[k] : 0;
+
+                if (s_ops[o].op == OP_CBC_DECRYPT) {
+                    free(c.ct);
+                    c.ct = NULL;
+                    if (aes_cbc_encrypt_pkcs7(c.key, c.keybits, c.iv, c.msg, size,
+                                              &c.ct, &c.ct_len) != 0) {
+                        printf("# %s %u %zu skipped: out of memory\n", s_ops[o].name, c.keybits, size);
+                        continue;
+                    }
+                }
+
+                run_case(s_ops[o].op, s_ops[o].name, &c);
+                vTaskDelay(1);       // let the idle task run between cases
+            }
+        }
+        case_free(&c);
+    }
+
+    for (size_t s = 0; s < sizeof(s_short_sizes) / sizeof(s_short_sizes[0]); s++) {
+        if (case_prepare(&c, s_short_sizes[s]) != 0) {
+            printf("# size %zu skipped: out of memory\n", s_short_sizes[s]);
+            continue;
+        }
+        for (size_t o = 0; o < sizeof(s_ops) / sizeof(s_ops[0]); o++) {
+            if (s_ops[o].short_msgs) {
+                run_case(s_ops[o].op, s_ops[o].name, &c);
+                vTaskDelay(1);
+            }
+        }
+        case_free(&c);
+    }
+
+    ESP_LOGI(TAG, "done");
+}
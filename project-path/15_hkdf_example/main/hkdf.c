@@ -0,0 +1,211 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "mbedtls/md.h"
+#include "mbedtls/hkdf.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "hkdf.h"
+
+/* HKDF-SHA256 wrapper */
+int hkdf_sha256(const uint8_t *salt, size_t salt_len,
+                const uint8_t *ikm,  size_t ikm_len,
+                const uint8_t *info, size_t info_len,
+                uint8_t *okm, size_t okm_len)
+{
+    const mbedtls_md_info_t *md =
+        mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+
+    if (md == NULL) {
+        return -1;
+    }
+
+    return mbedtls_hkdf(md,
+                        salt, salt_len,
+                        ikm,  ikm_len,
+                        info, info_len,
+                        okm,  okm_len);
+}
+
+/* HMAC-SHA256 wrapper: the key blocks are re-hashed on every call */
+int hmac_sha256(const uint8_t *key, size_t key_len,
+                const uint8_t *msg, size_t msg_len, uint8_t out[32])
+{
+    const mbedtls_md_info_t *md =
+        mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+
+    if (md == NULL || key == NULL || (msg == NULL && msg_len != 0) || out == NULL) {
+        return -1;
+    }
+
+    return mbedtls_md_hmac(md, key, key_len, msg, msg_len, out);
+}
+
+/**
+ * @brief Precompute the HMAC-SHA256 midstates of a fixed key.
+ *
+ * HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m)). Both padded keys are
+ * one 64-byte block, so their compression is the same for every message:
+ * it is done here once instead of twice per MAC. For 32..64 byte messages
+ * that is about half of the SHA-256 blocks of a plain hmac_sha256() call.
+ *
+ * IMPORTANT NOTES:
+ *  - The midstates are as secret as the key; hmac_sha256_key_free() wipes them
+ *  - The object is only read by hmac_sha256_key_mac(), so several tasks can
+ *    share one key
+ *  - Each pad is hashed in a temporary context and cloned into k, then the
+ *    temporary is freed: with CONFIG_MBEDTLS_HARDWARE_SHA the SHA engine is
+ *    released here instead of staying locked for the life of the key
+ *    (clone copies the state out of the engine)
+ *
+ * @param[out] k        Keyed object (caller memory)
+ * @param[in]  key      Key bytes (keys longer than 64 bytes are hashed first)
+ * @param[in]  key_len  Key length in bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hmac_sha256_key_init(hmac_sha256_key_t *k, const uint8_t *key, size_t key_len)
+{
+    int ret = 0;
+    uint8_t kb[64];                  // key block, zero padded
+    uint8_t pad[64];
+    mbedtls_sha256_context tmp;
+
+    if (k == NULL || (key == NULL && key_len != 0)) {
+        return -1;
+    }
+
+    mbedtls_sha256_init(&k->inner);
+    mbedtls_sha256_init(&k->outer);
+    mbedtls_sha256_init(&tmp);
+
+    memset(kb, 0, sizeof(kb));
+    if (key_len > sizeof(kb)) {
+        ret = mbedtls_sha256(key, key_len, kb, 0);
+        if (ret != 0) {
+            goto cleanup;
+        }
+    } else if (key_len > 0) {
+        memcpy(kb, key, key_len);
+    }
+
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = kb[i] ^ 0x36;
+    }
+    if ((ret = mbedtls_sha256_starts(&tmp, 0)) != 0 ||
+        (ret = mbedtls_sha256_update(&tmp, pad, sizeof(pad))) != 0) {
+        goto cleanup;
+    }
+    mbedtls_sha256_clone(&k->inner, &tmp);
+    mbedtls_sha256_free(&tmp);
+    mbedtls_sha256_init(&tmp);
+
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = kb[i] ^ 0x5c;
+    }
+    if ((ret = mbedtls_sha256_starts(&tmp, 0)) != 0 ||
+        (ret = mbedtls_sha256_update(&tmp, pad, sizeof(pad))) != 0) {
+        goto cleanup;
+    }
+    mbedtls_sha256_clone(&k->outer, &tmp);
+
+cleanup:
+    mbedtls_sha256_free(&tmp);
+    mbedtls_platform_zeroize(kb, sizeof(kb));
+    mbedtls_platform_zeroize(pad, sizeof(pad));
+    if (ret != 0) {
+        hmac_sha256_key_free(k);
+    }
+    return ret;
+}
+
+/**
+ * @brief HMAC-SHA256 of one message with a precomputed key.
+ *
+ * Costs the message blocks plus one final block for the inner hash and a
+ * single block for the outer hash; same result as hmac_sha256().
+ *
+ * @param[in]  k        Object from hmac_sha256_key_init()
+ * @param[in]  msg      Message bytes
+ * @param[in]  msg_len  Message length in bytes
+ * @param[out] out      32-byte MAC
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hmac_sha256_key_mac(const hmac_sha256_key_t *k,
+                        const uint8_t *msg, size_t msg_len, uint8_t out[32])
+{
+    int ret = 0;
+    mbedtls_sha256_context ctx;
+    uint8_t ih[32];                  // inner hash
+
+    if (k == NULL || (msg == NULL && msg_len != 0) || out == NULL) {
+        return -1;
+    }
+
+    mbedtls_sha256_init(&ctx);
+
+    mbedtls_sha256_clone(&ctx, &k->inner);
+    if ((ret = mbedtls_sha256_update(&ctx, msg, msg_len)) != 0 ||
+        (ret = mbedtls_sha256_finish(&ctx, ih)) != 0) {
+        goto cleanup;
+    }
+
+    mbedtls_sha256_clone(&ctx, &k->outer);
+    if ((ret = mbedtls_sha256_update(&ctx, ih, sizeof(ih))) != 0 ||
+        (ret = mbedtls_sha256_finish(&ctx, out)) != 0) {
+        goto cleanup;
+    }
+
+cleanup:
+    mbedtls_sha256_free(&ctx);
+    mbedtls_platform_zeroize(ih, sizeof(ih));
+    return ret;
+}
+
+/**
+ * @brief Recompute the MAC and compare it with a received tag.
+ *
+ * The comparison runs over all tag_len bytes (no early exit).
+ *
+ * @return 0 tag valid
+ *         -1 invalid args (tag_len outside 16..32)
+ *         -2 tag mismatch
+ *         otherwise: mbedTLS error code
+ */
+int hmac_sha256_key_verify(const hmac_sha256_key_t *k, const uint8_t *msg, size_t msg_len,
+                           const uint8_t *tag, size_t tag_len)
+{
+    uint8_t expected[32];
+    uint8_t diff = 0;
+
+    if (tag == NULL || tag_len < 16 || tag_len > sizeof(expected)) {
+        return -1;
+    }
+
+    int ret = hmac_sha256_key_mac(k, msg, msg_len, expected);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (size_t i = 0; i < tag_len; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+
+    return diff == 0 ? 0 : -2;
+}
+
+void hmac_sha256_key_free(hmac_sha256_key_t *k)
+{
+    if (k == NULL) {
+        return;
+    }
+    mbedtls_sha256_free(&k->inner);
+    mbedtls_sha256_free(&k->outer);
+    mbedtls_platform_zeroize(k, sizeof(*k));
+}
@@ -0,0 +1,34 @@
+#ifndef HKDF_H
+#define HKDF_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "mbedtls/sha256.h"
+
+// RFC 5869 HKDF with SHA-256 (extract + expand). okm_len <= 255 * 32
+int hkdf_sha256(const uint8_t *salt, size_t salt_len,
+                const uint8_t *ikm,  size_t ikm_len,
+                const uint8_t *info, size_t info_len,
+                uint8_t *okm, size_t okm_len);
+
+// RFC 2104 HMAC-SHA256, one-shot (mbedTLS md layer)
+int hmac_sha256(const uint8_t *key, size_t key_len,
+                const uint8_t *msg, size_t msg_len, uint8_t out[32]);
+
+/* HMAC-SHA256 for a fixed key: the (K ^ ipad) and (K ^ opad) blocks are
+ * compressed once, every message starts from copies of the two midstates.
+ * Treat as private; lives in caller memory. Holds key material.
+ */
+typedef struct {
+    mbedtls_sha256_context inner;    // after (K ^ ipad)
+    mbedtls_sha256_context outer;    // after (K ^ opad)
+} hmac_sha256_key_t;
+
+int  hmac_sha256_key_init(hmac_sha256_key_t *k, const uint8_t *key, size_t key_len);
+int  hmac_sha256_key_mac(const hmac_sha256_key_t *k,
+                         const uint8_t *msg, size_t msg_len, uint8_t out[32]);
+int  hmac_sha256_key_verify(const hmac_sha256_key_t *k, const uint8_t *msg, size_t msg_len,
+                            const uint8_t *tag, size_t tag_len);   // tag_len 16..32
+void hmac_sha256_key_free(hmac_sha256_key_t *k);                    // zeroizes
+
+#endif // HKDF_H
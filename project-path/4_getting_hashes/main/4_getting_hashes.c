@@ -2,33 +2,11 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
-#include "mbedtls/sha256.h"
-#include "mbedtls/sha512.h"
 #include "esp_log.h"
-
-void sha256_stream(const uint8_t *data, size_t len, uint8_t out[32])
-{
-    mbedtls_sha256_context ctx;
-
-    mbedtls_sha256_init(&ctx);
-    mbedtls_sha256_starts(&ctx, 0);   // 0 = SHA-256
-    mbedtls_sha256_update(&ctx, data, len);
-    mbedtls_sha256_finish(&ctx, out);
-    mbedtls_sha256_free(&ctx);
-}
-
-
-void sha512_stream(const uint8_t *data, size_t len, uint8_t out[64])
-{
-    mbedtls_sha512_context ctx;
-
-    mbedtls_sha512_init(&ctx);
-    mbedtls_sha512_starts(&ctx, 0);   // 0 = SHA-512
-    mbedtls_sha512_update(&ctx, data, len);
-    mbedtls_sha512_finish(&ctx, out);
-    mbedtls_sha512_free(&ctx);
-}
-
+#include "hashes.h"
+#include "sha_backend.h"
+#include "sha256_mb.h"
+#include "merkle.h"
 
 void print_hex(const char *tag, const uint8_t *buf, size_t len)
 {
@@ -51,11 +29,110 @@ void app_main(void)
     const char *msg = "hello esp32";
 
     uint8_t h256[32], h512[64];
-    sha256_stream((const uint8_t *)msg, strlen(msg), h256);
-    sha512_stream((const uint8_t *)msg, strlen(msg), h512);
+    if (sha256_stream((const uint8_t *)msg, strlen(msg), h256) != 0 ||
+        sha512_stream((const uint8_t *)msg, strlen(msg), h512) != 0) {
+        ESP_LOGE("SHA", "digest failed");
+        return;
+    }
 
     print_hex("SHA256", h256, sizeof(h256));
     print_hex("SHA512", h512, sizeof(h512));
+
+    // Every SHA-256 backend usable here must give the same digest
+    for (size_t i = 0; i < sha_backend_count(); i++) {
+        const sha_backend_t *b = sha_backend_get(i);
+        uint8_t d[32];
+        if (b->sha256 != NULL && b->sha256((const uint8_t *)msg, strlen(msg), d) == 0) {
+            ESP_LOGI("SHA256", "backend %-8s agrees: %s", b->name, memcmp(d, h256, 32) == 0 ? "yes" : "NO");
+        }
+    }
+
+    // Single hashing task: keep the peripheral, no lock per digest
+    uint8_t h1[20];
+    sha_backend_claim();
+    int ret = sha1_stream((const uint8_t *)msg, strlen(msg), h1);
+    if (ret == 0) {
+        ret = sha256_stream((const uint8_t *)msg, strlen(msg), h256);
+    }
+    sha_backend_release();
+    if (ret != 0) {
+        ESP_LOGE("SHA", "claimed digest failed: %d", ret);
+        return;
+    }
+    print_hex("SHA1 (claimed)", h1, sizeof(h1));
+    print_hex("SHA256 (claimed)", h256, sizeof(h256));
+
+    // Same digests fed in small chunks, plus the prefix "hello" from a clone
+    hash_ctx_t ctx, prefix;
+    uint8_t chunked[HASH_MAX_DIGEST_LEN], h_prefix[32];
+    size_t len = strlen(msg);
+
+    hash_init(&ctx, HASH_SHA256);
+    for (size_t off = 0; off < len; off += 3) {
+        hash_update(&ctx, (const uint8_t *)msg + off, (len - off < 3) ? len - off : 3);
+        if (off == 3) {                          // "hello " (6 bytes) absorbed so far
+            hash_clone(&prefix, &ctx);
+        }
+    }
+    hash_finish(&ctx, chunked);
+    ESP_LOGI("SHA256", "chunked == one-shot: %s", memcmp(chunked, h256, 32) == 0 ? "yes" : "NO");
+
+    hash_finish(&prefix, h_prefix);
+    print_hex("SHA256(\"hello \")", h_prefix, sizeof(h_prefix));
+    hash_free(&prefix);
+
+    hash_free(&ctx);
+    hash_init(&ctx, HASH_SHA512);
+    hash_update(&ctx, (const uint8_t *)"discarded", 9);
+    hash_reset(&ctx);                            // reuse the context, no re-init
+    hash_update(&ctx, (const uint8_t *)msg, len);
+    hash_finish(&ctx, chunked);
+    ESP_LOGI("SHA512", "after reset == one-shot: %s", memcmp(chunked, h512, 64) == 0 ? "yes" : "NO");
+    hash_free(&ctx);
+
+    // Several independent messages in one multi-buffer call
+    static const char *batch[] = { "hello esp32", "", "abc", "hello esp32 hello esp32 hello esp32 "
+                                   "hello esp32 hello esp32 hello esp32" };
+    sha256_mb_job_t jobs[4];
+    uint8_t mb_out[4][32];
+    for (size_t i = 0; i < 4; i++) {
+        jobs[i].data = (const uint8_t *)batch[i];
+        jobs[i].len = strlen(batch[i]);
+        jobs[i].out = mb_out[i];
+    }
+    sha256_mb(jobs, 4);
+    ESP_LOGI("SHA256_MB", "%s kernel, %d lanes", sha256_mb_kernel(), sha256_mb_lanes());
+    ESP_LOGI("SHA256_MB", "batch[0] == one-shot: %s", memcmp(mb_out[0], h256, 32) == 0 ? "yes" : "NO");
+    print_hex("SHA256_MB(\"abc\")", mb_out[2], 32);
+
+    // Merkle tree over a 16 KB blob, 1 KB leaves: patch one leaf, check one leaf
+    static uint8_t blob[16 * 1024];
+    static uint8_t nodes[31 * MERKLE_HASH_LEN];            // 16 + 8 + 4 + 2 + 1 nodes
+    merkle_tree_t tree;
+    uint8_t root[MERKLE_HASH_LEN];
+
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = (uint8_t)(i * 7);
+    }
+    merkle_init(&tree, sizeof(blob), 1024, nodes, sizeof(nodes));
+    merkle_build(&tree, blob);
+
+    memset(blob + 5 * 1024, 0xAA, 1024);                    // rewrite leaf 5 only
+    merkle_update(&tree, 5 * 1024, blob + 5 * 1024, 1024);  // 1 leaf + 4 node hashes
+    merkle_root(&tree, root);
+    print_hex("MERKLE root", root, sizeof(root));
+
+    // The nodes are plain bytes: store them next to the blob (a copy stands in
+    // for flash / NVS here), keep only the root trusted, load them back later
+    static uint8_t stored[sizeof(nodes)];
+    merkle_tree_t loaded;
+    memcpy(stored, nodes, sizeof(nodes));
+    merkle_init(&loaded, sizeof(blob), 1024, stored, sizeof(stored));  // no rebuild
+    ESP_LOGI("MERKLE", "leaf 9 verifies after reload: %s",
+             merkle_verify_leaf(&loaded, 9, blob + 9 * 1024, 1024, root) == 0 ? "yes" : "NO");
+    blob[9 * 1024] ^= 1;
+    ESP_LOGI("MERKLE", "tampered leaf 9 rejected: %s",
+             merkle_verify_leaf(&loaded, 9, blob + 9 * 1024, 1024, root) == -5 ? "yes" : "NO");
     }
 
 /**
@@ -0,0 +1,270 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "hashes.h"
+#include "sha_backend.h"
+
+/* One-shot digests go through the backend picked at startup (SHA-NI /
+ * ARMv8 on hosts, the ESP32 SHA peripheral, mbedTLS otherwise).
+ * 0, -1 bad args, or the backend (mbedTLS) error code.
+ */
+int sha1_stream(const uint8_t *data, size_t len, uint8_t out[20])
+{
+    return sha_backend_digest(SHA_BACKEND_SHA1, data, len, out);
+}
+
+
+int sha256_stream(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    return sha_backend_digest(SHA_BACKEND_SHA256, data, len, out);
+}
+
+
+int sha512_stream(const uint8_t *data, size_t len, uint8_t out[64])
+{
+    return sha_backend_digest(SHA_BACKEND_SHA512, data, len, out);
+}
+
+
+/* Digest size in bytes, 0 for an unknown algorithm */
+size_t hash_digest_len(hash_alg_t alg)
+{
+    switch (alg) {
+    case HASH_SHA256: return 32;
+    case HASH_SHA512: return 64;
+    default:          return 0;
+    }
+}
+
+/**
+ * @brief Set up a context and start a new message.
+ *
+ * The context holds only the algorithm state (~100 / ~200 bytes), so any
+ * amount of data can be hashed chunk by chunk with hash_update(): a 1 MB
+ * partition can be read and hashed 4 KB at a time.
+ *
+ * @param[out] ctx  Context (caller memory)
+ * @param[in]  alg  HASH_SHA256 or HASH_SHA512
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hash_init(hash_ctx_t *ctx, hash_alg_t alg)
+{
+    if (ctx == NULL || hash_digest_len(alg) == 0) {
+        return -1;
+    }
+
+    ctx->alg = alg;
+    ctx->blocks = NULL;
+    if (alg == HASH_SHA256) {
+        ctx->blocks = sha_backend_blocks(SHA_BACKEND_SHA256);
+        if (ctx->blocks == NULL) {
+            mbedtls_sha256_init(&ctx->u.sha256);
+        }
+    } else {
+        mbedtls_sha512_init(&ctx->u.sha512);
+    }
+    return hash_reset(ctx);
+}
+
+/**
+ * @brief Start over with an empty message, keeping the context.
+ *
+ * Only re-runs the algorithm's starts(): no free / init cycle, so a
+ * long-lived context (e.g. one per NVS record stream) costs nothing to
+ * reuse. Also the way to reuse a context after hash_finish().
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hash_reset(hash_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        return -1;
+    }
+
+    if (ctx->blocks != NULL) {
+        memcpy(ctx->u.md32.state, sha256_iv, sizeof(ctx->u.md32.state));
+        ctx->u.md32.len = 0;
+        return 0;
+    }
+
+    switch (ctx->alg) {
+    case HASH_SHA256: return mbedtls_sha256_starts(&ctx->u.sha256, 0);   // 0 = SHA-256
+    case HASH_SHA512: return mbedtls_sha512_starts(&ctx->u.sha512, 0);   // 0 = SHA-512
+    default:          return -1;
+    }
+}
+
+/* hash_update() on a backend block function: full blocks are compressed
+ * straight from data, only a partial block is buffered.
+ */
+static void md32_update(hash_ctx_t *ctx, const uint8_t *data, size_t len)
+{
+    size_t used = (size_t)(ctx->u.md32.len % 64);
+
+    ctx->u.md32.len += len;
+    if (used > 0) {
+        size_t take = 64 - used;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->u.md32.buf + used, data, take);
+        data += take;
+        len -= take;
+        if (used + take < 64) {
+            return;
+        }
+        ctx->blocks(ctx->u.md32.state, ctx->u.md32.buf, 1);
+    }
+    if (len >= 64) {
+        ctx->blocks(ctx->u.md32.state, data, len / 64);
+        data += len - (len % 64);
+        len %= 64;
+    }
+    memcpy(ctx->u.md32.buf, data, len);
+}
+
+/* Padding + big-endian bit length, then the state as the digest */
+static void md32_finish(hash_ctx_t *ctx, uint8_t out[32])
+{
+    size_t used = (size_t)(ctx->u.md32.len % 64);
+    uint64_t bits = ctx->u.md32.len * 8;
+
+    ctx->u.md32.buf[used++] = 0x80;
+    if (used > 56) {
+        memset(ctx->u.md32.buf + used, 0, 64 - used);
+        ctx->blocks(ctx->u.md32.state, ctx->u.md32.buf, 1);
+        used = 0;
+    }
+    memset(ctx->u.md32.buf + used, 0, 56 - used);
+    for (int i = 0; i < 8; i++) {
+        ctx->u.md32.buf[63 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    ctx->blocks(ctx->u.md32.state, ctx->u.md32.buf, 1);
+
+    for (size_t i = 0; i < 8; i++) {
+        out[4 * i + 0] = (uint8_t)(ctx->u.md32.state[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(ctx->u.md32.state[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(ctx->u.md32.state[i] >> 8);
+        out[4 * i + 3] = (uint8_t)ctx->u.md32.state[i];
+    }
+}
+
+/**
+ * @brief Add the next chunk (any length, including 0).
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hash_update(hash_ctx_t *ctx, const uint8_t *data, size_t len)
+{
+    if (ctx == NULL || (data == NULL && len != 0)) {
+        return -1;
+    }
+
+    if (ctx->blocks != NULL) {
+        if (len > 0) {
+            md32_update(ctx, data, len);
+        }
+        return 0;
+    }
+
+    switch (ctx->alg) {
+    case HASH_SHA256: return mbedtls_sha256_update(&ctx->u.sha256, data, len);
+    case HASH_SHA512: return mbedtls_sha512_update(&ctx->u.sha512, data, len);
+    default:          return -1;
+    }
+}
+
+/**
+ * @brief Write the digest of everything fed since init / reset.
+ *
+ * The context must be reset (hash_reset) before it hashes a new message.
+ *
+ * @param[in,out] ctx  Context
+ * @param[out]    out  hash_digest_len(ctx->alg) bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int hash_finish(hash_ctx_t *ctx, uint8_t *out)
+{
+    if (ctx == NULL || out == NULL) {
+        return -1;
+    }
+
+    if (ctx->blocks != NULL) {
+        md32_finish(ctx, out);
+        return 0;
+    }
+
+    switch (ctx->alg) {
+    case HASH_SHA256: return mbedtls_sha256_finish(&ctx->u.sha256, out);
+    case HASH_SHA512: return mbedtls_sha512_finish(&ctx->u.sha512, out);
+    default:          return -1;
+    }
+}
+
+/**
+ * @brief Fork a running hash: dst continues from exactly where src is.
+ *
+ * Used for prefix hashes: hash the common prefix once, clone, and finish
+ * the clone while src keeps absorbing data.
+ *
+ * Example: H(header) and H(header || body) with one pass over header:
+ *     hash_update(&ctx, header, n);
+ *     hash_clone(&prefix, &ctx);  hash_finish(&prefix, h_header);
+ *     hash_update(&ctx, body, m); hash_finish(&ctx, h_all);
+ *
+ * @param[out] dst  Destination (uninitialized, or released with hash_free())
+ * @param[in]  src  Running context
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ */
+int hash_clone(hash_ctx_t *dst, const hash_ctx_t *src)
+{
+    if (dst == NULL || src == NULL || hash_digest_len(src->alg) == 0) {
+        return -1;
+    }
+
+    dst->alg = src->alg;
+    dst->blocks = src->blocks;
+    if (src->blocks != NULL) {
+        dst->u.md32 = src->u.md32;
+    } else if (src->alg == HASH_SHA256) {
+        mbedtls_sha256_init(&dst->u.sha256);
+        mbedtls_sha256_clone(&dst->u.sha256, &src->u.sha256);
+    } else {
+        mbedtls_sha512_init(&dst->u.sha512);
+        mbedtls_sha512_clone(&dst->u.sha512, &src->u.sha512);
+    }
+    return 0;
+}
+
+/* Release a context (mbedTLS wipes the state). NULL is ignored. */
+void hash_free(hash_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    if (ctx->blocks != NULL) {
+        mbedtls_platform_zeroize(&ctx->u.md32, sizeof(ctx->u.md32));
+    } else if (ctx->alg == HASH_SHA256) {
+        mbedtls_sha256_free(&ctx->u.sha256);
+    } else if (ctx->alg == HASH_SHA512) {
+        mbedtls_sha512_free(&ctx->u.sha512);
+    }
+    ctx->alg = 0;
+    ctx->blocks = NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef HASHES_H
+#define HASHES_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "sha_backend.h"  // sha_md32_blocks_t
+
+// One-shot digests of a buffer (fastest backend, see sha_backend.h). 0 or error
+int sha1_stream(const uint8_t *data, size_t len, uint8_t out[20]);
+int sha256_stream(const uint8_t *data, size_t len, uint8_t out[32]);
+int sha512_stream(const uint8_t *data, size_t len, uint8_t out[64]);
+
+/* Incremental hashing: feed chunks of any size, fork a running state with
+ * hash_clone() (prefix hashes), restart with hash_reset() (no re-init).
+ * SHA-256 runs on the block function of the digest backend when it has one
+ * (SHA-NI / ARMv8), on mbedTLS otherwise; SHA-512 always on mbedTLS.
+ */
+typedef enum {
+    HASH_SHA256 = 1,
+    HASH_SHA512 = 2,
+} hash_alg_t;
+
+#define HASH_MAX_DIGEST_LEN 64
+
+/* Treat as private; lives in caller memory (stack, struct member) */
+typedef struct {
+    hash_alg_t alg;
+    sha_md32_blocks_t blocks;        // SHA-256 on u.md32 when set, mbedTLS when NULL
+    union {
+        mbedtls_sha256_context sha256;
+        mbedtls_sha512_context sha512;
+        struct {
+            uint32_t state[8];
+            uint8_t buf[64];         // partial block
+            uint64_t len;            // bytes fed so far
+        } md32;
+    } u;
+} hash_ctx_t;
+
+int    hash_init(hash_ctx_t *ctx, hash_alg_t alg);
+int    hash_update(hash_ctx_t *ctx, const uint8_t *data, size_t len);
+int    hash_finish(hash_ctx_t *ctx, uint8_t *out);          // hash_digest_len() bytes
+int    hash_reset(hash_ctx_t *ctx);                         // same alg, empty message
+int    hash_clone(hash_ctx_t *dst, const hash_ctx_t *src);  // dst: uninitialized or freed
+void   hash_free(hash_ctx_t *ctx);                          // zeroizes
+size_t hash_digest_len(hash_alg_t alg);
+
+#endif // HASHES_H
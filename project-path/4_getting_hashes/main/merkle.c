@@ -0,0 +1,339 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "hashes.h"
+#include "merkle.h"
+
+#define NODE(t, lvl, i)  ((t)->nodes + ((t)->level_off[lvl] + (i)) * MERKLE_HASH_LEN)
+
+/* Shape of the tree: node count per level, -1 if it is not a valid one */
+static int merkle_shape(size_t blob_len, size_t leaf_size,
+                        size_t cnt[MERKLE_MAX_LEVELS], size_t *n_levels, size_t *n_nodes)
+{
+    if (blob_len == 0 || leaf_size < MERKLE_MIN_LEAF || (leaf_size & (leaf_size - 1)) != 0) {
+        return -1;
+    }
+
+    size_t n = blob_len / leaf_size + (blob_len % leaf_size != 0);
+    size_t total = 0;
+    size_t lvl = 0;
+
+    for (;;) {
+        if (lvl == MERKLE_MAX_LEVELS) {
+            return -1;               // blob too large for leaf_size
+        }
+        cnt[lvl++] = n;
+        total += n;
+        if (n == 1) {
+            break;
+        }
+        n = (n + 1) / 2;
+    }
+    if (total > SIZE_MAX / MERKLE_HASH_LEN) {
+        return -1;                   // node storage size would not fit in a size_t
+    }
+
+    *n_levels = lvl;
+    *n_nodes = total;
+    return 0;
+}
+
+size_t merkle_nodes_size(size_t blob_len, size_t leaf_size)
+{
+    size_t cnt[MERKLE_MAX_LEVELS];
+    size_t n_levels = 0;
+    size_t n_nodes = 0;
+
+    if (merkle_shape(blob_len, leaf_size, cnt, &n_levels, &n_nodes) != 0) {
+        return 0;
+    }
+    return n_nodes * MERKLE_HASH_LEN;
+}
+
+/**
+ * @brief Describe a tree over a blob of blob_len bytes.
+ *
+ * Only the geometry is set up; the node buffer is left as it is, so a tree
+ * stored earlier can be loaded into it and used directly. A new tree is
+ * filled with merkle_build(), or merkle_set_leaf() on every leaf followed
+ * by merkle_build_parents() when the blob is read piece by piece (flash).
+ *
+ * @param[out] t           Tree descriptor
+ * @param[in]  blob_len    Blob size in bytes (> 0)
+ * @param[in]  leaf_size   Leaf size, power of two >= 64 (4096 = one flash sector)
+ * @param[in]  nodes       Node storage
+ * @param[in]  nodes_size  Its size, at least merkle_nodes_size()
+ *
+ * @return 0 on success
+ *         -1 invalid args / geometry
+ *         -2 node buffer too small
+ */
+int merkle_init(merkle_tree_t *t, size_t blob_len, size_t leaf_size,
+                uint8_t *nodes, size_t nodes_size)
+{
+    if (t == NULL || nodes == NULL) {
+        return -1;
+    }
+
+    memset(t, 0, sizeof(*t));
+    if (merkle_shape(blob_len, leaf_size, t->level_cnt, &t->n_levels, &t->n_nodes) != 0) {
+        return -1;
+    }
+    if (nodes_size < t->n_nodes * MERKLE_HASH_LEN) {
+        return -2;
+    }
+
+    for (size_t l = 1; l < t->n_levels; l++) {
+        t->level_off[l] = t->level_off[l - 1] + t->level_cnt[l - 1];
+    }
+    t->blob_len = blob_len;
+    t->leaf_size = leaf_size;
+    t->n_leaves = t->level_cnt[0];
+    t->nodes = nodes;
+    return 0;
+}
+
+/* Length of leaf idx: leaf_size, except for the tail of the blob */
+static size_t leaf_len(const merkle_tree_t *t, size_t idx)
+{
+    size_t off = idx * t->leaf_size;
+    size_t rest = t->blob_len - off;
+    return rest < t->leaf_size ? rest : t->leaf_size;
+}
+
+/* SHA256(prefix || a || b); out may alias a or b (written last) */
+static int hash_prefixed(uint8_t prefix, const uint8_t *a, size_t a_len,
+                         const uint8_t *b, size_t b_len, uint8_t out[MERKLE_HASH_LEN])
+{
+    hash_ctx_t ctx;
+    int ret;
+
+    ret = hash_init(&ctx, HASH_SHA256);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = hash_update(&ctx, &prefix, 1);
+    if (ret == 0) {
+        ret = hash_update(&ctx, a, a_len);
+    }
+    if (ret == 0 && b_len > 0) {
+        ret = hash_update(&ctx, b, b_len);
+    }
+    if (ret == 0) {
+        ret = hash_finish(&ctx, out);
+    }
+    hash_free(&ctx);
+    return ret;
+}
+
+/* Leaf hash, 0x00 prefix: a leaf can never be taken for an interior node */
+static int hash_leaf(const uint8_t *data, size_t len, uint8_t out[MERKLE_HASH_LEN])
+{
+    return hash_prefixed(0x00, data, len, NULL, 0, out);
+}
+
+static int hash_pair(const uint8_t *left, const uint8_t *right, uint8_t out[MERKLE_HASH_LEN])
+{
+    return hash_prefixed(0x01, left, MERKLE_HASH_LEN, right, MERKLE_HASH_LEN, out);
+}
+
+/* Recompute node i of level lvl (>= 1) from its children */
+static int update_node(merkle_tree_t *t, size_t lvl, size_t i)
+{
+    size_t left = 2 * i;
+
+    if (left + 1 < t->level_cnt[lvl - 1]) {
+        return hash_pair(NODE(t, lvl - 1, left), NODE(t, lvl - 1, left + 1), NODE(t, lvl, i));
+    }
+    memmove(NODE(t, lvl, i), NODE(t, lvl - 1, left), MERKLE_HASH_LEN);
+    return 0;
+}
+
+/**
+ * @brief Hash one leaf into the tree without touching its parents.
+ *
+ * @param[in,out] t     Tree from merkle_init()
+ * @param[in]     idx   Leaf index
+ * @param[in]     data  Leaf bytes
+ * @param[in]     len   Must be the exact leaf length (shorter for the last leaf)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -4 idx / len out of range
+ *         otherwise: mbedTLS error code
+ */
+int merkle_set_leaf(merkle_tree_t *t, size_t idx, const uint8_t *data, size_t len)
+{
+    if (t == NULL || t->nodes == NULL || data == NULL) {
+        return -1;
+    }
+    if (idx >= t->n_leaves || len != leaf_len(t, idx)) {
+        return -4;
+    }
+
+    return hash_leaf(data, len, NODE(t, 0, idx));
+}
+
+/* Every interior node, bottom-up: n_leaves - 1 pair hashes at most.
+ * Returns 0, -1 (invalid args) or the hash error code.
+ */
+int merkle_build_parents(merkle_tree_t *t)
+{
+    if (t == NULL || t->nodes == NULL) {
+        return -1;
+    }
+
+    for (size_t lvl = 1; lvl < t->n_levels; lvl++) {
+        for (size_t i = 0; i < t->level_cnt[lvl]; i++) {
+            int ret = update_node(t, lvl, i);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Whole tree from a blob held in memory */
+int merkle_build(merkle_tree_t *t, const uint8_t *blob)
+{
+    int ret;
+
+    if (t == NULL || t->nodes == NULL || blob == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < t->n_leaves; i++) {
+        ret = merkle_set_leaf(t, i, blob + i * t->leaf_size, leaf_len(t, i));
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return merkle_build_parents(t);
+}
+
+/**
+ * @brief Re-hash a rewritten range of the blob and refresh the root.
+ *
+ * Only the leaves inside the range and the nodes above them are
+ * recomputed: changing one 4 KB leaf of a 1 MB blob costs one leaf hash
+ * plus 8 pair hashes instead of hashing the whole megabyte again.
+ *
+ * IMPORTANT NOTES:
+ *  - The range must start on a leaf boundary and hold whole leaves
+ *    (it may end at the end of the blob)
+ *  - data is the new content of the range, not of the whole blob
+ *
+ * @param[in,out] t       Tree from merkle_init(), already built or loaded
+ * @param[in]     offset  Start of the range in the blob (multiple of leaf_size)
+ * @param[in]     data    New content of the range
+ * @param[in]     len     Range length (multiple of leaf_size or up to blob_len)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -3 range not aligned on leaves
+ *         -4 range outside the blob
+ *         otherwise: mbedTLS error code
+ */
+int merkle_update(merkle_tree_t *t, size_t offset, const uint8_t *data, size_t len)
+{
+    if (t == NULL || t->nodes == NULL || data == NULL || len == 0) {
+        return -1;
+    }
+    if (offset >= t->blob_len || len > t->blob_len - offset) {
+        return -4;
+    }
+    if (offset % t->leaf_size != 0 ||
+        (len % t->leaf_size != 0 && offset + len != t->blob_len)) {
+        return -3;
+    }
+
+    size_t first = offset / t->leaf_size;
+    size_t last = (offset + len - 1) / t->leaf_size;
+
+    for (size_t i = first; i <= last; i++) {
+        int ret = hash_leaf(data + (i - first) * t->leaf_size, leaf_len(t, i), NODE(t, 0, i));
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    for (size_t lvl = 1; lvl < t->n_levels; lvl++) {
+        first /= 2;
+        last /= 2;
+        for (size_t i = first; i <= last; i++) {
+            int ret = update_node(t, lvl, i);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Check one leaf read back from storage against a trusted root.
+ *
+ * The leaf is hashed and combined with the stored siblings on its path up
+ * to the root (log2(n_leaves) pair hashes), the rest of the blob is never
+ * read. Tampering with the leaf, or with any stored node on the path,
+ * changes the computed root.
+ *
+ * @param[in] t     Tree from merkle_init() (nodes built or loaded)
+ * @param[in] idx   Leaf index
+ * @param[in] data  Leaf bytes as read
+ * @param[in] len   Leaf length
+ * @param[in] root  Root kept in trusted storage
+ *
+ * @return 0 leaf is authentic
+ *         -1 invalid args
+ *         -4 idx / len out of range
+ *         -5 mismatch
+ *         otherwise: mbedTLS error code
+ */
+int merkle_verify_leaf(const merkle_tree_t *t, size_t idx, const uint8_t *data, size_t len,
+                       const uint8_t root[MERKLE_HASH_LEN])
+{
+    uint8_t h[MERKLE_HASH_LEN];
+    uint8_t diff = 0;
+
+    if (t == NULL || t->nodes == NULL || data == NULL || root == NULL) {
+        return -1;
+    }
+    if (idx >= t->n_leaves || len != leaf_len(t, idx)) {
+        return -4;
+    }
+
+    int ret = hash_leaf(data, len, h);
+    if (ret != 0) {
+        return ret;
+    }
+
+    size_t i = idx;
+    for (size_t lvl = 0; lvl + 1 < t->n_levels; lvl++) {
+        size_t sib = i ^ 1;
+        if (sib < t->level_cnt[lvl]) {
+            ret = (i & 1) ? hash_pair(NODE(t, lvl, sib), h, h)
+                          : hash_pair(h, NODE(t, lvl, sib), h);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        i /= 2;
+    }
+
+    for (size_t k = 0; k < MERKLE_HASH_LEN; k++) {
+        diff |= h[k] ^ root[k];
+    }
+    return diff == 0 ? 0 : -5;
+}
+
+int merkle_root(const merkle_tree_t *t, uint8_t root[MERKLE_HASH_LEN])
+{
+    if (t == NULL || t->nodes == NULL || root == NULL) {
+        return -1;
+    }
+
+    memcpy(root, NODE(t, t->n_levels - 1, 0), MERKLE_HASH_LEN);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef MERKLE_H
+#define MERKLE_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+
+/* Merkle tree over a blob cut into fixed-size leaves (SHA-256):
+ *
+ *     leaf = SHA256(0x00 || leaf bytes)    (last leaf may be shorter)
+ *     node = SHA256(0x01 || left || right) (an odd node moves up unchanged)
+ *
+ * The prefixes keep leaves and interior nodes apart (RFC 6962): a 64-byte
+ * leaf can not pass for the two children of a node.
+ *
+ * All nodes live in one caller buffer, level by level, leaves first and
+ * the root last. The buffer is plain bytes: store it next to the blob and
+ * load it back as-is; only the root has to be kept somewhere trusted.
+ *
+ * The root does not commit to blob_len or leaf_size: keep them in trusted
+ * storage with the root (or bind them into whatever signs it), or a
+ * different geometry can be paired with the same root.
+ */
+#define MERKLE_HASH_LEN    32
+#define MERKLE_MIN_LEAF    64
+#define MERKLE_MAX_LEVELS  48
+
+typedef struct {
+    size_t blob_len;
+    size_t leaf_size;
+    size_t n_leaves;
+    size_t n_levels;
+    size_t level_off[MERKLE_MAX_LEVELS];   // first node of each level
+    size_t level_cnt[MERKLE_MAX_LEVELS];
+    uint8_t *nodes;                        // n_nodes * MERKLE_HASH_LEN bytes
+    size_t n_nodes;
+} merkle_tree_t;
+
+// Bytes of node storage for a blob, 0 if the geometry is invalid
+size_t merkle_nodes_size(size_t blob_len, size_t leaf_size);
+
+int merkle_init(merkle_tree_t *t, size_t blob_len, size_t leaf_size,
+                uint8_t *nodes, size_t nodes_size);       // nodes are not touched
+int merkle_build(merkle_tree_t *t, const uint8_t *blob);  // whole blob in RAM
+int merkle_set_leaf(merkle_tree_t *t, size_t idx, const uint8_t *data, size_t len);
+int merkle_build_parents(merkle_tree_t *t);               // after merkle_set_leaf() on every leaf
+int merkle_update(merkle_tree_t *t, size_t offset, const uint8_t *data, size_t len);
+int merkle_verify_leaf(const merkle_tree_t *t, size_t idx, const uint8_t *data, size_t len,
+                       const uint8_t root[MERKLE_HASH_LEN]);
+int merkle_root(const merkle_tree_t *t, uint8_t root[MERKLE_HASH_LEN]);
+
+#endif // MERKLE_H
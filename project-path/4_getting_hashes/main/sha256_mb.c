@@ -0,0 +1,441 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "sha256_mb.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_MB_HAVE_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* State layout for every kernel: st[word * lanes + lane], so word i of all
+ * lanes is one contiguous vector. Message words are gathered per lane and
+ * byte swapped while they are loaded.
+ */
+typedef void (*sha256_mb_kernel_t)(uint32_t *st, const uint8_t *const blk[]);
+
+static const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t H256[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+#define ROTR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* ------------------------------------------------------- 4 scalar lanes */
+
+/* Plain C, the four lanes interleaved inside every round: four independent
+ * dependency chains keep an in-order core (ESP32 Xtensa LX6) busy while one
+ * lane waits on a load or an add.
+ */
+#define S4 4
+
+__attribute__((unused))
+static void kernel_scalar4(uint32_t *st, const uint8_t *const blk[])
+{
+    uint32_t w[16][S4];
+    uint32_t a[S4], b[S4], c[S4], d[S4], e[S4], f[S4], g[S4], h[S4];
+
+    for (int l = 0; l < S4; l++) {
+        a[l] = st[0 * S4 + l]; b[l] = st[1 * S4 + l];
+        c[l] = st[2 * S4 + l]; d[l] = st[3 * S4 + l];
+        e[l] = st[4 * S4 + l]; f[l] = st[5 * S4 + l];
+        g[l] = st[6 * S4 + l]; h[l] = st[7 * S4 + l];
+    }
+
+    for (int t = 0; t < 64; t++) {
+        for (int l = 0; l < S4; l++) {
+            uint32_t wt;
+            if (t < 16) {
+                wt = load_be32(blk[l] + 4 * t);
+            } else {
+                uint32_t w15 = w[(t - 15) & 15][l];
+                uint32_t w2 = w[(t - 2) & 15][l];
+                wt = w[t & 15][l] + w[(t - 7) & 15][l] +
+                     (ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3)) +
+                     (ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10));
+            }
+            w[t & 15][l] = wt;
+
+            uint32_t t1 = h[l] + (ROTR(e[l], 6) ^ ROTR(e[l], 11) ^ ROTR(e[l], 25)) +
+                          ((e[l] & f[l]) ^ (~e[l] & g[l])) + K256[t] + wt;
+            uint32_t t2 = (ROTR(a[l], 2) ^ ROTR(a[l], 13) ^ ROTR(a[l], 22)) +
+                          ((a[l] & b[l]) ^ (a[l] & c[l]) ^ (b[l] & c[l]));
+            h[l] = g[l]; g[l] = f[l]; f[l] = e[l]; e[l] = d[l] + t1;
+            d[l] = c[l]; c[l] = b[l]; b[l] = a[l]; a[l] = t1 + t2;
+        }
+    }
+
+    for (int l = 0; l < S4; l++) {
+        st[0 * S4 + l] += a[l]; st[1 * S4 + l] += b[l];
+        st[2 * S4 + l] += c[l]; st[3 * S4 + l] += d[l];
+        st[4 * S4 + l] += e[l]; st[5 * S4 + l] += f[l];
+        st[6 * S4 + l] += g[l]; st[7 * S4 + l] += h[l];
+    }
+}
+
+#ifdef SHA256_MB_HAVE_X86
+
+/* ------------------------------------------------------- x86 SSE2 / AVX2 */
+
+#define SSE2_TARGET  __attribute__((target("sse2")))
+#define AVX2_TARGET  __attribute__((target("avx2")))
+
+#define V4_ROTR(x, n)  _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+#define V8_ROTR(x, n)  _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+SSE2_TARGET
+static void kernel_sse2(uint32_t *st, const uint8_t *const blk[])
+{
+    __m128i w[16];
+    __m128i s[8];
+    __m128i a, b, c, d, e, f, g, h;
+
+    for (int i = 0; i < 8; i++) {
+        s[i] = _mm_loadu_si128((const __m128i *)(st + 4 * i));
+    }
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    for (int t = 0; t < 64; t++) {
+        __m128i wt;
+        if (t < 16) {
+            wt = _mm_set_epi32((int)load_be32(blk[3] + 4 * t), (int)load_be32(blk[2] + 4 * t),
+                               (int)load_be32(blk[1] + 4 * t), (int)load_be32(blk[0] + 4 * t));
+        } else {
+            __m128i w15 = w[(t - 15) & 15];
+            __m128i w2 = w[(t - 2) & 15];
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(V4_ROTR(w15, 7), V4_ROTR(w15, 18)),
+                                       _mm_srli_epi32(w15, 3));
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(V4_ROTR(w2, 17), V4_ROTR(w2, 19)),
+                                       _mm_srli_epi32(w2, 10));
+            wt = _mm_add_epi32(_mm_add_epi32(w[t & 15], w[(t - 7) & 15]), _mm_add_epi32(s0, s1));
+        }
+        w[t & 15] = wt;
+
+        __m128i S1 = _mm_xor_si128(_mm_xor_si128(V4_ROTR(e, 6), V4_ROTR(e, 11)), V4_ROTR(e, 25));
+        __m128i ch = _mm_xor_si128(_mm_and_si128(e, f), _mm_andnot_si128(e, g));
+        __m128i t1 = _mm_add_epi32(_mm_add_epi32(h, S1),
+                                   _mm_add_epi32(_mm_add_epi32(ch, wt), _mm_set1_epi32((int)K256[t])));
+        __m128i S0 = _mm_xor_si128(_mm_xor_si128(V4_ROTR(a, 2), V4_ROTR(a, 13)), V4_ROTR(a, 22));
+        __m128i maj = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_or_si128(a, b)));
+        __m128i t2 = _mm_add_epi32(S0, maj);
+        h = g; g = f; f = e; e = _mm_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm_add_epi32(t1, t2);
+    }
+
+    s[0] = _mm_add_epi32(s[0], a); s[1] = _mm_add_epi32(s[1], b);
+    s[2] = _mm_add_epi32(s[2], c); s[3] = _mm_add_epi32(s[3], d);
+    s[4] = _mm_add_epi32(s[4], e); s[5] = _mm_add_epi32(s[5], f);
+    s[6] = _mm_add_epi32(s[6], g); s[7] = _mm_add_epi32(s[7], h);
+    for (int i = 0; i < 8; i++) {
+        _mm_storeu_si128((__m128i *)(st + 4 * i), s[i]);
+    }
+}
+
+/* 8 lanes: the 16 message words of every lane are loaded as two 32-byte
+ * rows, byte swapped with one shuffle and transposed 8x8 in registers.
+ */
+AVX2_TARGET
+static void load_w8(__m256i w[16], const uint8_t *const blk[])
+{
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    for (int half = 0; half < 2; half++) {
+        __m256i r[8];
+        for (int l = 0; l < 8; l++) {
+            r[l] = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *)(blk[l] + 32 * half)), bswap);
+        }
+        /*  8x8 transpose of 32-bit words: r[l][i] -> w[8 * half + i][l] */
+        __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+        __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+        __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+        __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+        __m256i *o = w + 8 * half;
+        o[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        o[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        o[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        o[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        o[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        o[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        o[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        o[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+}
+
+AVX2_TARGET
+static void kernel_avx2(uint32_t *st, const uint8_t *const blk[])
+{
+    __m256i w[16];
+    __m256i s[8];
+    __m256i a, b, c, d, e, f, g, h;
+
+    for (int i = 0; i < 8; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *)(st + 8 * i));
+    }
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    load_w8(w, blk);
+
+    for (int t = 0; t < 64; t++) {
+        __m256i wt;
+        if (t < 16) {
+            wt = w[t];
+        } else {
+            __m256i w15 = w[(t - 15) & 15];
+            __m256i w2 = w[(t - 2) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(w15, 7), V8_ROTR(w15, 18)),
+                                          _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(w2, 17), V8_ROTR(w2, 19)),
+                                          _mm256_srli_epi32(w2, 10));
+            wt = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], w[(t - 7) & 15]),
+                                  _mm256_add_epi32(s0, s1));
+            w[t & 15] = wt;
+        }
+
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(e, 6), V8_ROTR(e, 11)), V8_ROTR(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1),
+                                      _mm256_add_epi32(_mm256_add_epi32(ch, wt),
+                                                       _mm256_set1_epi32((int)K256[t])));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(a, 2), V8_ROTR(a, 13)), V8_ROTR(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(S0, maj);
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+    }
+
+    s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)(st + 8 * i), s[i]);
+    }
+}
+
+static int cpu_has_avx2(void)
+{
+    unsigned a, b, c, d;
+    unsigned xcr0_lo, xcr0_hi;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d) || !(c & bit_OSXSAVE) || !(c & bit_AVX)) {
+        return 0;
+    }
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) {    // OS saves the YMM state
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        return 0;
+    }
+    return (b & bit_AVX2) != 0;
+}
+
+#endif // SHA256_MB_HAVE_X86
+
+/* ---------------------------------------------------------------- dispatch */
+
+/* Kernel, lane count and name travel together: a task that sees the
+ * pointer also sees a complete entry (release / acquire below).
+ */
+typedef struct {
+    sha256_mb_kernel_t kernel;
+    int lanes;
+    const char *name;
+} sha256_mb_impl_t;
+
+#ifdef SHA256_MB_HAVE_X86
+static const sha256_mb_impl_t s_impl_avx2 = { kernel_avx2, 8, "avx2" };
+static const sha256_mb_impl_t s_impl_sse2 = { kernel_sse2, 4, "sse2" };
+#else
+static const sha256_mb_impl_t s_impl_scalar4 = { kernel_scalar4, S4, "scalar4" };
+#endif
+
+static const sha256_mb_impl_t *s_impl;
+
+/* Pick once, on first use. Two tasks racing here both pick the same entry */
+static const sha256_mb_impl_t *select_kernel(void)
+{
+    const sha256_mb_impl_t *impl = __atomic_load_n(&s_impl, __ATOMIC_ACQUIRE);
+
+    if (impl != NULL) {
+        return impl;
+    }
+#ifdef SHA256_MB_HAVE_X86
+    impl = cpu_has_avx2() ? &s_impl_avx2 : &s_impl_sse2;
+#else
+    impl = &s_impl_scalar4;
+#endif
+    __atomic_store_n(&s_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+int sha256_mb_lanes(void)
+{
+    return select_kernel()->lanes;
+}
+
+const char *sha256_mb_kernel(void)
+{
+    return select_kernel()->name;
+}
+
+/* ---------------------------------------------------------------- scheduler */
+
+typedef struct {
+    const sha256_mb_job_t *job;      // NULL = idle lane
+    const uint8_t *next;             // next full block of the message
+    size_t full_left;                // full message blocks still to go
+    uint8_t tail[128];               // last partial block + padding + length
+    unsigned tail_blocks;            // 1 or 2
+    unsigned tail_done;
+} sha256_mb_lane_t;
+
+static void lane_start(sha256_mb_lane_t *ln, uint32_t *st, int lanes, int l,
+                       const sha256_mb_job_t *job)
+{
+    size_t rem = job->len % 64;
+    uint64_t bits = (uint64_t)job->len * 8;
+
+    ln->job = job;
+    ln->next = job->data;
+    ln->full_left = job->len / 64;
+    ln->tail_blocks = (rem + 9 <= 64) ? 1 : 2;
+    ln->tail_done = 0;
+
+    memset(ln->tail, 0, sizeof(ln->tail));
+    if (rem > 0) {
+        memcpy(ln->tail, job->data + job->len - rem, rem);
+    }
+    ln->tail[rem] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        ln->tail[64 * ln->tail_blocks - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    for (int i = 0; i < 8; i++) {
+        st[i * lanes + l] = H256[i];
+    }
+}
+
+/* Next block of a lane, NULL once the padded message is consumed */
+static const uint8_t *lane_block(sha256_mb_lane_t *ln)
+{
+    if (ln->full_left > 0) {
+        const uint8_t *p = ln->next;
+        ln->next += 64;
+        ln->full_left--;
+        return p;
+    }
+    if (ln->tail_done < ln->tail_blocks) {
+        return ln->tail + 64 * ln->tail_done++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief SHA-256 of n independent messages, several at a time.
+ *
+ * Every lane of the kernel hashes its own message; all lanes run the
+ * compression function in lockstep on one block each. When a message
+ * ends its digest is written and the lane is refilled with the next job,
+ * so messages of different lengths do not stall each other for long.
+ * Lanes without work hash a dummy block that is thrown away. Best when
+ * the messages have similar lengths (records, NVS blobs).
+ *
+ * IMPORTANT NOTES:
+ *  - Output is identical to sha256_stream() per message
+ *  - out buffers must not overlap any job's input
+ *  - Not for secrets: a lane's state stays on the stack until overwritten
+ *
+ * @param[in] jobs  n descriptors (data may be NULL when len == 0)
+ * @param[in] n     Number of messages
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ */
+int sha256_mb(const sha256_mb_job_t *jobs, size_t n)
+{
+    static const uint8_t zero_block[64];
+    uint32_t st[8 * SHA256_MB_MAX_LANES] = { 0 };   // idle lanes hash zeros, not stack garbage
+    sha256_mb_lane_t lane[SHA256_MB_MAX_LANES];
+    const uint8_t *blk[SHA256_MB_MAX_LANES];
+    size_t next_job = 0;
+    int active = 0;
+
+    if (jobs == NULL && n != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (jobs[i].out == NULL || (jobs[i].data == NULL && jobs[i].len != 0)) {
+            return -1;
+        }
+    }
+
+    const sha256_mb_impl_t *impl = select_kernel();
+    const int lanes = impl->lanes;
+
+    for (int l = 0; l < lanes; l++) {
+        lane[l].job = NULL;
+        if (next_job < n) {
+            lane_start(&lane[l], st, lanes, l, &jobs[next_job++]);
+            active++;
+        }
+    }
+
+    while (active > 0) {
+        for (int l = 0; l < lanes; l++) {
+            blk[l] = (lane[l].job != NULL) ? lane_block(&lane[l]) : zero_block;
+        }
+        impl->kernel(st, blk);
+
+        /*  Retire lanes whose last block was just hashed, refill them */
+        for (int l = 0; l < lanes; l++) {
+            sha256_mb_lane_t *ln = &lane[l];
+            if (ln->job == NULL || ln->full_left > 0 || ln->tail_done < ln->tail_blocks) {
+                continue;
+            }
+            for (int i = 0; i < 8; i++) {
+                store_be32(ln->job->out + 4 * i, st[i * lanes + l]);
+            }
+            ln->job = NULL;
+            active--;
+            if (next_job < n) {
+                lane_start(ln, st, lanes, l, &jobs[next_job++]);
+                active++;
+            }
+        }
+    }
+
+    return 0;
+}
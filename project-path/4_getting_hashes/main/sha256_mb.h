@@ -0,0 +1,23 @@
+#ifndef SHA256_MB_H
+#define SHA256_MB_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+
+/* Multi-buffer SHA-256: N independent messages hashed side by side, one
+ * message per lane (8 lanes AVX2 / 4 lanes SSE2 on x86 hosts, 4
+ * interleaved scalar lanes elsewhere). Same digests as sha256_stream().
+ */
+#define SHA256_MB_MAX_LANES 8
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    uint8_t *out;                    // 32 bytes
+} sha256_mb_job_t;
+
+int         sha256_mb(const sha256_mb_job_t *jobs, size_t n);
+int         sha256_mb_lanes(void);   // lanes of the kernel in use
+const char *sha256_mb_kernel(void);  // "avx2", "sse2" or "scalar4"
+
+#endif // SHA256_MB_H
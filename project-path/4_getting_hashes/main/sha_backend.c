@@ -0,0 +1,454 @@
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "sha_backend.h"
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sha/sha_parallel_engine.h" // esp_sha*, SHA peripheral driver (ESP32)
+#endif
+
+static const char *TAG = "SHA_BACKEND";
+
+const uint32_t sha1_iv[5] = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0,
+};
+
+const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/* Final 1..2 blocks: tail of the message, 0x80, zeros, bit length.
+ * Returns the number of padded bytes written to tail (block or 2 * block).
+ */
+static size_t md_pad(const uint8_t *data, size_t len, size_t block, uint8_t *tail)
+{
+    size_t rem = len % block;
+    size_t len_field = (block == 128) ? 16 : 8;
+    size_t n = (rem + 1 + len_field <= block) ? block : 2 * block;
+    uint64_t bits = (uint64_t)len * 8;
+
+    memset(tail, 0, n);
+    memcpy(tail, data + (len - rem), rem);
+    tail[rem] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        tail[n - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    return n;
+}
+
+/**
+ * @brief Merkle-Damgard driver for SHA-1 / SHA-256 block functions.
+ *
+ * The full blocks are compressed straight from the input, only the
+ * padded tail goes through a stack copy; state and tail are wiped
+ * before returning.
+ *
+ * @param[in]  blocks       Compression function of the backend
+ * @param[in]  iv           Initial state (sha1_iv / sha256_iv)
+ * @param[in]  state_words  5 (SHA-1) or 8 (SHA-256), also the digest size in words
+ * @param[in]  data         Message
+ * @param[in]  len          Message length in bytes
+ * @param[out] out          Digest (4 * state_words bytes)
+ *
+ * @return 0 on success, -1 invalid args
+ */
+int sha_md32_digest(sha_md32_blocks_t blocks, const uint32_t *iv, size_t state_words,
+                    const uint8_t *data, size_t len, uint8_t *out)
+{
+    uint32_t st[8];
+    uint8_t tail[128];
+
+    if (blocks == NULL || iv == NULL || state_words > 8 || (data == NULL && len != 0) || out == NULL) {
+        return -1;
+    }
+
+    memcpy(st, iv, state_words * sizeof(uint32_t));
+    if (len >= 64) {
+        blocks(st, data, len / 64);
+    }
+    size_t n = md_pad(data, len, 64, tail);
+    blocks(st, tail, n / 64);
+
+    for (size_t i = 0; i < state_words; i++) {
+        out[4 * i + 0] = (uint8_t)(st[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(st[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(st[i] >> 8);
+        out[4 * i + 3] = (uint8_t)st[i];
+    }
+    mbedtls_platform_zeroize(st, sizeof(st));
+    mbedtls_platform_zeroize(tail, sizeof(tail));
+    return 0;
+}
+
+/* ---- mbedTLS: whatever the sdkconfig selects (on the ESP32 with
+ *      CONFIG_MBEDTLS_HARDWARE_SHA this already ends in the peripheral,
+ *      taking its lock per block; on the linux host it is portable C).
+ */
+
+static int mbed_sha1(const uint8_t *data, size_t len, uint8_t out[20])
+{
+    return mbedtls_sha1(data, len, out);
+}
+
+static int mbed_sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    return mbedtls_sha256(data, len, out, 0);
+}
+
+static int mbed_sha512(const uint8_t *data, size_t len, uint8_t out[64])
+{
+    return mbedtls_sha512(data, len, out, 0);
+}
+
+const sha_backend_t sha_backend_mbedtls = {
+    .name      = "mbedtls",
+    .available = NULL,
+    .sha1      = mbed_sha1,
+    .sha256    = mbed_sha256,
+    .sha512    = mbed_sha512,
+};
+
+/* ---- ESP32 SHA peripheral through the esp_sha driver directly. Shared
+ *      mode: the engine lock is tried for every message, and a busy engine
+ *      (claimed, or in use by mbedTLS) sends the digest to mbedTLS instead
+ *      of blocking. Claimed mode (sha_backend_claim()): the owner task
+ *      already holds the locks, so its digests feed the engine block by
+ *      block without any.
+ */
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+
+static portMUX_TYPE s_owner_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_owner;         // task holding all engine locks, NULL = shared
+
+static void esp_owned_digest(esp_sha_type type, size_t block, size_t digest_len,
+                             const uint8_t *data, size_t len, uint8_t *out)
+{
+    uint8_t tail[256];
+    bool first = true;
+
+    for (size_t off = 0; off + block <= len; off += block) {
+        esp_sha_block(type, data + off, first);
+        first = false;
+    }
+    size_t n = md_pad(data, len, block, tail);
+    for (size_t off = 0; off < n; off += block) {
+        esp_sha_block(type, tail + off, first);
+        first = false;
+    }
+
+    /*  Engine state comes back in host word order (64-bit words for SHA-512) */
+    if (block == 128) {
+        uint64_t st[8];
+        esp_sha_read_digest_state(type, st);
+        for (size_t i = 0; i < digest_len; i++) {
+            out[i] = (uint8_t)(st[i / 8] >> (56 - 8 * (i % 8)));
+        }
+        mbedtls_platform_zeroize(st, sizeof(st));
+    } else {
+        uint32_t st[8];
+        esp_sha_read_digest_state(type, st);
+        for (size_t i = 0; i < digest_len; i++) {
+            out[i] = (uint8_t)(st[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        mbedtls_platform_zeroize(st, sizeof(st));
+    }
+    mbedtls_platform_zeroize(tail, sizeof(tail));
+}
+
+/* fallback: the mbedTLS digest used when the engine is busy */
+static int esp_digest(esp_sha_type type, size_t block, size_t digest_len,
+                      int (*fallback)(const uint8_t *, size_t, uint8_t *),
+                      const uint8_t *data, size_t len, uint8_t *out)
+{
+    /*  s_owner only ever equals this task if this task set it */
+    if (s_owner != NULL && s_owner == xTaskGetCurrentTaskHandle()) {
+        esp_owned_digest(type, block, digest_len, data, len, out);
+        return 0;
+    }
+
+    if (!esp_sha_try_lock_engine(type)) {
+        return fallback(data, len, out);
+    }
+    esp_owned_digest(type, block, digest_len, data, len, out);
+    esp_sha_unlock_engine(type);
+    return 0;
+}
+
+static int esp_sha1(const uint8_t *data, size_t len, uint8_t out[20])
+{
+    return esp_digest(SHA1, 64, 20, mbed_sha1, data, len, out);
+}
+
+static int esp_sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    return esp_digest(SHA2_256, 64, 32, mbed_sha256, data, len, out);
+}
+
+static int esp_sha512(const uint8_t *data, size_t len, uint8_t out[64])
+{
+    return esp_digest(SHA2_512, 128, 64, mbed_sha512, data, len, out);
+}
+
+const sha_backend_t sha_backend_esp_sha = {
+    .name      = "esp_sha",
+    .available = NULL,
+    .sha1      = esp_sha1,
+    .sha256    = esp_sha256,
+    .sha512    = esp_sha512,
+};
+
+#endif // SHA_BACKEND_HAVE_ESP_SHA
+
+/* ---- Registry: preference order, fastest first */
+static const sha_backend_t *const s_backends[] = {
+#ifdef SHA_BACKEND_HAVE_X86
+    &sha_backend_sha_ni,
+#endif
+#ifdef SHA_BACKEND_HAVE_ARMV8
+    &sha_backend_armv8,
+#endif
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+    &sha_backend_esp_sha,
+#endif
+    &sha_backend_mbedtls,
+};
+
+#define BACKEND_COUNT  (sizeof(s_backends) / sizeof(s_backends[0]))
+
+static const sha_backend_t *s_active[SHA_BACKEND_ALGS];
+
+static int backend_usable(const sha_backend_t *b)
+{
+    return b->available == NULL || b->available();
+}
+
+static int backend_offers(const sha_backend_t *b, sha_backend_alg_t alg)
+{
+    switch (alg) {
+    case SHA_BACKEND_SHA1:   return b->sha1 != NULL;
+    case SHA_BACKEND_SHA256: return b->sha256 != NULL;
+    case SHA_BACKEND_SHA512: return b->sha512 != NULL;
+    default:                 return 0;
+    }
+}
+
+/**
+ * @brief Backend that digests of alg go to.
+ *
+ * Chosen on the first call, per algorithm: the first usable entry of
+ * s_backends that offers it (SHA-NI / ARMv8, ESP32 peripheral, mbedTLS).
+ * Detection is a pure function of the CPU, so two tasks racing on the
+ * first call pick the same backend.
+ *
+ * @return Backend, NULL only for an unknown alg
+ */
+const sha_backend_t *sha_backend_active(sha_backend_alg_t alg)
+{
+    if ((unsigned)alg >= SHA_BACKEND_ALGS) {
+        return NULL;
+    }
+
+    const sha_backend_t *b = s_active[alg];
+    if (b == NULL) {
+        static const char *const alg_name[SHA_BACKEND_ALGS] = { "SHA-1", "SHA-256", "SHA-512" };
+
+        b = &sha_backend_mbedtls;
+        for (size_t i = 0; i < BACKEND_COUNT; i++) {
+            if (backend_offers(s_backends[i], alg) && backend_usable(s_backends[i])) {
+                b = s_backends[i];
+                break;
+            }
+        }
+        s_active[alg] = b;
+        ESP_LOGI(TAG, "using %s backend: %s", alg_name[alg], b->name);
+    }
+    return b;
+}
+
+/**
+ * @brief Block function of the backend bound to alg, for incremental hashing.
+ *
+ * NULL when that backend only does one-shot digests (mbedTLS, the ESP32
+ * peripheral, which cannot be loaded with a saved state) or for SHA-512.
+ */
+sha_md32_blocks_t sha_backend_blocks(sha_backend_alg_t alg)
+{
+    const sha_backend_t *b = sha_backend_active(alg);
+
+    if (b == NULL) {
+        return NULL;
+    }
+    switch (alg) {
+    case SHA_BACKEND_SHA1:   return b->sha1_blocks;
+    case SHA_BACKEND_SHA256: return b->sha256_blocks;
+    default:                 return NULL;
+    }
+}
+
+/**
+ * @brief Digest of a whole buffer through the selected backend.
+ *
+ * @param[in]  alg   SHA_BACKEND_SHA1 / SHA256 / SHA512
+ * @param[in]  data  Message (may be NULL when len == 0)
+ * @param[in]  len   Message length in bytes
+ * @param[out] out   20 / 32 / 64 bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: backend (mbedTLS) error code
+ */
+int sha_backend_digest(sha_backend_alg_t alg, const uint8_t *data, size_t len, uint8_t *out)
+{
+    const sha_backend_t *b = sha_backend_active(alg);
+    static const uint8_t empty[1];
+
+    if (b == NULL || (data == NULL && len != 0) || out == NULL) {
+        return -1;
+    }
+    if (data == NULL) {
+        data = empty;
+    }
+
+    switch (alg) {
+    case SHA_BACKEND_SHA1:   return b->sha1(data, len, out);
+    case SHA_BACKEND_SHA256: return b->sha256(data, len, out);
+    default:                 return b->sha512(data, len, out);
+    }
+}
+
+/**
+ * @brief Force a backend by name (tests, benchmarks, host tools).
+ *
+ * Rebinds every algorithm the backend offers; the others keep their
+ * current backend.
+ *
+ * @param[in] name  Backend name, see sha_backend.h
+ *
+ * @return 0 on success, -1 unknown or not usable on this machine
+ */
+int sha_backend_select(const char *name)
+{
+    if (name == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        const sha_backend_t *b = s_backends[i];
+        if (strcmp(b->name, name) != 0 || !backend_usable(b)) {
+            continue;
+        }
+        for (int alg = 0; alg < SHA_BACKEND_ALGS; alg++) {
+            if (backend_offers(b, (sha_backend_alg_t)alg)) {
+                s_active[alg] = b;
+            }
+        }
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Number of backends usable on this machine.
+ */
+size_t sha_backend_count(void)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        n += backend_usable(s_backends[i]) ? 1 : 0;
+    }
+    return n;
+}
+
+/**
+ * @brief index-th usable backend (0 .. sha_backend_count() - 1), NULL past the end.
+ */
+const sha_backend_t *sha_backend_get(size_t index)
+{
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (backend_usable(s_backends[i]) && index-- == 0) {
+            return s_backends[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reserve the SHA peripheral for the calling task.
+ *
+ * For the common case of a single task doing all the hashing (boot-time
+ * image check, Merkle updates): the engine locks are taken once here, and
+ * every esp_sha digest of this task then runs without lock / unlock.
+ *
+ * IMPORTANT NOTES:
+ *  - While claimed, SHA digests of other tasks (esp_sha backend and
+ *    mbedTLS alike) fall back to software. Only claim when one task uses SHA
+ *  - Never blocks: if another task claims at the same time, or an engine
+ *    is in use right now, this returns an error and nothing is held
+ *  - Not recursive; the owner must release it
+ *  - Without the ESP32 peripheral this does nothing
+ *
+ * @return 0 on success
+ *         -1 already claimed
+ *         -2 an engine is busy, try again later
+ */
+int sha_backend_claim(void)
+{
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+    static const esp_sha_type types[] = { SHA1, SHA2_256, SHA2_512 };
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    size_t locked = 0;
+
+    /*  Reserve s_owner first: of two tasks claiming at once, one gets -1 */
+    taskENTER_CRITICAL(&s_owner_mux);
+    if (s_owner != NULL) {
+        taskEXIT_CRITICAL(&s_owner_mux);
+        return -1;
+    }
+    s_owner = self;
+    taskEXIT_CRITICAL(&s_owner_mux);
+
+    while (locked < sizeof(types) / sizeof(types[0]) && esp_sha_try_lock_engine(types[locked])) {
+        locked++;
+    }
+    if (locked < sizeof(types) / sizeof(types[0])) {
+        while (locked > 0) {
+            esp_sha_unlock_engine(types[--locked]);
+        }
+        taskENTER_CRITICAL(&s_owner_mux);
+        s_owner = NULL;
+        taskEXIT_CRITICAL(&s_owner_mux);
+        return -2;
+    }
+#endif
+    return 0;
+}
+
+void sha_backend_release(void)
+{
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+    if (s_owner == NULL || s_owner != xTaskGetCurrentTaskHandle()) {
+        return;
+    }
+    esp_sha_unlock_engine(SHA2_512);
+    esp_sha_unlock_engine(SHA2_256);
+    esp_sha_unlock_engine(SHA1);
+    taskENTER_CRITICAL(&s_owner_mux);
+    s_owner = NULL;
+    taskEXIT_CRITICAL(&s_owner_mux);
+#endif
+}
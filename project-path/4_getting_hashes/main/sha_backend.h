@@ -0,0 +1,88 @@
+#ifndef SHA_BACKEND_H
+#define SHA_BACKEND_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "sdkconfig.h"
+
+/* Backends compiled into this build */
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA_BACKEND_HAVE_X86      1   // SHA-NI (used when CPUID reports it)
+#endif
+#if defined(__aarch64__)
+#define SHA_BACKEND_HAVE_ARMV8    1   // ARMv8 SHA1/SHA2 instructions (HWCAP checked)
+#endif
+#if CONFIG_MBEDTLS_HARDWARE_SHA && CONFIG_IDF_TARGET_ESP32 && !CONFIG_IDF_TARGET_LINUX
+#define SHA_BACKEND_HAVE_ESP_SHA  1   // ESP32 SHA peripheral, called directly
+#endif
+
+typedef enum {
+    SHA_BACKEND_SHA1 = 0,
+    SHA_BACKEND_SHA256,
+    SHA_BACKEND_SHA512,
+    SHA_BACKEND_ALGS,
+} sha_backend_alg_t;
+
+// Compression of nblocks 64-byte blocks into a SHA-1 (5 words) / SHA-256 (8 words) state
+typedef void (*sha_md32_blocks_t)(uint32_t *state, const uint8_t *data, size_t nblocks);
+
+/* Digest backend: one-shot digests of a whole buffer. A backend may offer
+ * only some of the algorithms (NULL = not offered); each algorithm is
+ * bound to the fastest backend that offers it, once, on first use.
+ * Backends that work on a state in memory also export their block
+ * function, so incremental hashing (hash_ctx_t) runs on it too.
+ */
+typedef struct sha_backend {
+    const char *name;
+    int (*available)(void);          // runtime check (CPUID, HWCAP), NULL = always
+    int (*sha1)(const uint8_t *data, size_t len, uint8_t out[20]);
+    int (*sha256)(const uint8_t *data, size_t len, uint8_t out[32]);
+    int (*sha512)(const uint8_t *data, size_t len, uint8_t out[64]);
+    sha_md32_blocks_t sha1_blocks;   // NULL = one-shot only
+    sha_md32_blocks_t sha256_blocks;
+} sha_backend_t;
+
+// Digest through the backend bound to alg. 0, -1 bad args, or backend error
+int sha_backend_digest(sha_backend_alg_t alg, const uint8_t *data, size_t len, uint8_t *out);
+
+// Backend bound to alg; picked once (fastest available) on first use
+const sha_backend_t *sha_backend_active(sha_backend_alg_t alg);
+
+// Block function of the backend bound to alg (SHA-1 / SHA-256), NULL if it has none
+sha_md32_blocks_t sha_backend_blocks(sha_backend_alg_t alg);
+
+// Override the choice by name ("sha_ni", "armv8", "esp_sha", "mbedtls") for
+// every algorithm the backend offers. Returns 0, or -1 if not available here.
+int sha_backend_select(const char *name);
+
+// Backends usable on this machine, fastest first (for reports / tests)
+size_t               sha_backend_count(void);
+const sha_backend_t *sha_backend_get(size_t index);
+
+// Reserve the SHA peripheral for the calling task: no lock per digest until
+// sha_backend_release(). Never blocks: -1 claimed by another task, -2 engine
+// busy. No-op (returns 0) where there is no peripheral.
+int  sha_backend_claim(void);
+void sha_backend_release(void);
+
+/* Implementations (sha_backend_*.c) */
+extern const sha_backend_t sha_backend_mbedtls;
+#ifdef SHA_BACKEND_HAVE_ESP_SHA
+extern const sha_backend_t sha_backend_esp_sha;
+#endif
+#ifdef SHA_BACKEND_HAVE_X86
+extern const sha_backend_t sha_backend_sha_ni;
+#endif
+#ifdef SHA_BACKEND_HAVE_ARMV8
+extern const sha_backend_t sha_backend_armv8;
+#endif
+
+// Padding + length for SHA-1 / SHA-256 backends that only compress blocks
+int sha_md32_digest(sha_md32_blocks_t blocks, const uint32_t *iv, size_t state_words,
+                    const uint8_t *data, size_t len, uint8_t *out);
+
+extern const uint32_t sha1_iv[5];
+extern const uint32_t sha256_iv[8];
+extern const uint32_t sha256_k[64];
+
+#endif // SHA_BACKEND_H
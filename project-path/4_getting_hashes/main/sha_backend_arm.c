@@ -0,0 +1,140 @@
+#include "sha_backend.h"
+
+#ifdef SHA_BACKEND_HAVE_ARMV8
+
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* ARMv8 Cryptography Extensions backend (aarch64 hosts: Raspberry Pi 4/5
+ * build servers, Apple silicon). SHA-1 and SHA-256; SHA-512 needs
+ * ARMv8.2-SHA and stays on mbedTLS.
+ */
+
+#if defined(__clang__)
+#define ARMV8_TARGET  __attribute__((target("sha2")))
+#else
+#define ARMV8_TARGET  __attribute__((target("+crypto")))
+#endif
+
+/* ---------------------------------------------------------------- detection */
+
+static int cpu_has_armv8_sha(void)
+{
+#if defined(__linux__)
+    unsigned long hw = getauxval(AT_HWCAP);
+    return (hw & HWCAP_SHA1) && (hw & HWCAP_SHA2);
+#else
+    return 1;                        // Apple silicon: always present
+#endif
+}
+
+static inline uint32x4_t load_be(const uint8_t *p)
+{
+    return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p)));
+}
+
+/* ------------------------------------------------------------------ SHA-256 */
+
+ARMV8_TARGET
+static void armv8_sha256_blocks(uint32_t *state, const uint8_t *data, size_t nblocks)
+{
+    uint32x4_t st0 = vld1q_u32(&state[0]);               // ABCD
+    uint32x4_t st1 = vld1q_u32(&state[4]);               // EFGH
+    uint32x4_t w[4];
+
+    while (nblocks--) {
+        uint32x4_t abcd = st0;
+        uint32x4_t efgh = st1;
+
+        for (int i = 0; i < 4; i++) {
+            w[i] = load_be(data + 16 * i);
+        }
+        for (int i = 0; i < 16; i++) {
+            uint32x4_t wk = vaddq_u32(w[i & 3], vld1q_u32(&sha256_k[4 * i]));
+            if (i < 12) {                // schedule of group i + 4
+                w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]),
+                                           w[(i + 2) & 3], w[(i + 3) & 3]);
+            }
+            uint32x4_t tmp = st0;
+            st0 = vsha256hq_u32(st0, st1, wk);
+            st1 = vsha256h2q_u32(st1, tmp, wk);
+        }
+
+        st0 = vaddq_u32(st0, abcd);
+        st1 = vaddq_u32(st1, efgh);
+        data += 64;
+    }
+
+    vst1q_u32(&state[0], st0);
+    vst1q_u32(&state[4], st1);
+}
+
+/* -------------------------------------------------------------------- SHA-1 */
+
+ARMV8_TARGET
+static void armv8_sha1_blocks(uint32_t *state, const uint8_t *data, size_t nblocks)
+{
+    static const uint32_t k[4] = { 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6 };
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32_t e0 = state[4];
+    uint32x4_t w[4];
+
+    while (nblocks--) {
+        uint32x4_t abcd_save = abcd;
+        uint32_t e = e0;
+
+        for (int i = 0; i < 4; i++) {
+            w[i] = load_be(data + 16 * i);
+        }
+        for (int i = 0; i < 20; i++) {
+            uint32x4_t wk = vaddq_u32(w[i & 3], vdupq_n_u32(k[i / 5]));
+            if (i < 16) {                // schedule of group i + 4
+                w[i & 3] = vsha1su1q_u32(vsha1su0q_u32(w[i & 3], w[(i + 1) & 3], w[(i + 2) & 3]),
+                                         w[(i + 3) & 3]);
+            }
+            uint32_t e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+            if (i < 5) {
+                abcd = vsha1cq_u32(abcd, e, wk);
+            } else if (i < 10 || i >= 15) {
+                abcd = vsha1pq_u32(abcd, e, wk);
+            } else {
+                abcd = vsha1mq_u32(abcd, e, wk);
+            }
+            e = e_next;
+        }
+
+        e0 += e;
+        abcd = vaddq_u32(abcd, abcd_save);
+        data += 64;
+    }
+
+    vst1q_u32(state, abcd);
+    state[4] = e0;
+}
+
+/* ---------------------------------------------------------------- backend */
+
+static int armv8_sha1(const uint8_t *data, size_t len, uint8_t out[20])
+{
+    return sha_md32_digest(armv8_sha1_blocks, sha1_iv, 5, data, len, out);
+}
+
+static int armv8_sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    return sha_md32_digest(armv8_sha256_blocks, sha256_iv, 8, data, len, out);
+}
+
+const sha_backend_t sha_backend_armv8 = {
+    .name      = "armv8",
+    .available = cpu_has_armv8_sha,
+    .sha1      = armv8_sha1,
+    .sha256    = armv8_sha256,
+    .sha512    = NULL,
+    .sha1_blocks   = armv8_sha1_blocks,
+    .sha256_blocks = armv8_sha256_blocks,
+};
+
+#endif // SHA_BACKEND_HAVE_ARMV8
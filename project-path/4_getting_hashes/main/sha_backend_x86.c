@@ -0,0 +1,147 @@
+#include "sha_backend.h"
+
+#ifdef SHA_BACKEND_HAVE_X86
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* x86 SHA extensions backend (linux host build: tools that hash firmware
+ * images and partition dumps, tests). SHA-1 and SHA-256 only; SHA-512 has
+ * no instructions on common CPUs and stays on mbedTLS. The message
+ * schedule is kept in four registers of four words each.
+ */
+
+#define NI_TARGET  __attribute__((target("sha,sse4.1")))
+
+/* ---------------------------------------------------------------- detection */
+
+static int cpu_has_sha_ni(void)
+{
+    unsigned a, b, c, d;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d) || !(c & bit_SSE4_1) || !(c & bit_SSSE3)) {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        return 0;
+    }
+    return (b & (1u << 29)) != 0;                        // CPUID.7.0:EBX[29] = SHA
+}
+
+/* ------------------------------------------------------------------ SHA-256 */
+
+NI_TARGET
+static void ni_sha256_blocks(uint32_t *state, const uint8_t *data, size_t nblocks)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i w[4];
+
+    /*  The instructions want the state as ABEF / CDGH */
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);   // CDAB
+    __m128i st1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B);   // EFGH
+    __m128i st0 = _mm_alignr_epi8(tmp, st1, 8);                                           // ABEF
+    st1 = _mm_blend_epi16(st1, tmp, 0xF0);                                                // CDGH
+
+    while (nblocks--) {
+        __m128i abef = st0;
+        __m128i cdgh = st1;
+
+        for (int i = 0; i < 4; i++) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), bswap);
+        }
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; i++) {
+            if (i >= 4) {
+                /*  W[t] = s1(W[t-2]) + W[t-7] + s0(W[t-15]) + W[t-16], 4 words at a time */
+                __m128i x = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+                x = _mm_add_epi32(x, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(x, w[(i + 3) & 3]);
+            }
+            __m128i wk = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&sha256_k[4 * i]));
+            st1 = _mm_sha256rnds2_epu32(st1, st0, wk);
+            st0 = _mm_sha256rnds2_epu32(st0, st1, _mm_shuffle_epi32(wk, 0x0E));
+        }
+
+        st0 = _mm_add_epi32(st0, abef);
+        st1 = _mm_add_epi32(st1, cdgh);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(st0, 0x1B);                  // FEBA
+    st1 = _mm_shuffle_epi32(st1, 0xB1);                  // DCHG
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, st1, 0xF0));   // DCBA
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(st1, tmp, 8));      // HGFE
+}
+
+/* -------------------------------------------------------------------- SHA-1 */
+
+/* Four rounds; the round function f is an immediate, hence the macro */
+#define SHA1_ROUNDS4(i, f)                                                               \
+    do {                                                                                 \
+        if ((i) >= 4) {                                                                  \
+            w[(i) & 3] = _mm_sha1msg2_epu32(                                              \
+                _mm_xor_si128(_mm_sha1msg1_epu32(w[(i) & 3], w[((i) + 1) & 3]),          \
+                              w[((i) + 2) & 3]),                                         \
+                w[((i) + 3) & 3]);                                                       \
+        }                                                                                \
+        __m128i e = ((i) == 0) ? _mm_add_epi32(e0, w[0])                                 \
+                               : _mm_sha1nexte_epu32(prev, w[(i) & 3]);                  \
+        prev = abcd;                                                                     \
+        abcd = _mm_sha1rnds4_epu32(abcd, e, f);                                          \
+    } while (0)
+
+NI_TARGET
+static void ni_sha1_blocks(uint32_t *state, const uint8_t *data, size_t nblocks)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+    __m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+    __m128i w[4];
+    __m128i prev;
+
+    while (nblocks--) {
+        __m128i abcd_save = abcd;
+        __m128i e0_save = e0;
+
+        for (int i = 0; i < 4; i++) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), bswap);
+        }
+
+        SHA1_ROUNDS4(0, 0);  SHA1_ROUNDS4(1, 0);  SHA1_ROUNDS4(2, 0);  SHA1_ROUNDS4(3, 0);
+        SHA1_ROUNDS4(4, 0);  SHA1_ROUNDS4(5, 1);  SHA1_ROUNDS4(6, 1);  SHA1_ROUNDS4(7, 1);
+        SHA1_ROUNDS4(8, 1);  SHA1_ROUNDS4(9, 1);  SHA1_ROUNDS4(10, 2); SHA1_ROUNDS4(11, 2);
+        SHA1_ROUNDS4(12, 2); SHA1_ROUNDS4(13, 2); SHA1_ROUNDS4(14, 2); SHA1_ROUNDS4(15, 3);
+        SHA1_ROUNDS4(16, 3); SHA1_ROUNDS4(17, 3); SHA1_ROUNDS4(18, 3); SHA1_ROUNDS4(19, 3);
+
+        e0 = _mm_sha1nexte_epu32(prev, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+        data += 64;
+    }
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+/* ---------------------------------------------------------------- backend */
+
+static int ni_sha1(const uint8_t *data, size_t len, uint8_t out[20])
+{
+    return sha_md32_digest(ni_sha1_blocks, sha1_iv, 5, data, len, out);
+}
+
+static int ni_sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    return sha_md32_digest(ni_sha256_blocks, sha256_iv, 8, data, len, out);
+}
+
+const sha_backend_t sha_backend_sha_ni = {
+    .name      = "sha_ni",
+    .available = cpu_has_sha_ni,
+    .sha1      = ni_sha1,
+    .sha256    = ni_sha256,
+    .sha512    = NULL,
+    .sha1_blocks   = ni_sha1_blocks,
+    .sha256_blocks = ni_sha256_blocks,
+};
+
+#endif // SHA_BACKEND_HAVE_X86
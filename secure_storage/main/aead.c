@@ -0,0 +1,299 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/md.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aead.h"
+#include "aes_gcm.h"
+#include "chacha_poly.h"
+
+struct aead_key {
+    aes_gcm_key_t *gcm;
+    chacha_poly_key_t *chacha;
+};
+
+/* subkey = HMAC-SHA256(master, "ss-aead" || alg): the same master key never
+ * drives two algorithms directly.
+ */
+static int aead_derive(const uint8_t key[AEAD_KEY_LEN], uint8_t alg, uint8_t out[32])
+{
+    uint8_t label[8] = { 's', 's', '-', 'a', 'e', 'a', 'd', alg };
+
+    return mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                           key, AEAD_KEY_LEN, label, sizeof(label), out);
+}
+
+/**
+ * @brief Create an AEAD handle with AES-256-GCM and ChaCha20-Poly1305 ready.
+ *
+ * Both key setups are paid once here, so aead_seal() / aead_open() can
+ * switch algorithm per record at no cost.
+ *
+ * @param[in] key  32-byte master key
+ *
+ * @return Handle on success, NULL on invalid args / no memory / mbedTLS error
+ */
+aead_key_t *aead_key_create(const uint8_t key[AEAD_KEY_LEN])
+{
+    aead_key_t *self;
+    uint8_t sub[32];
+
+    if (key == NULL) {
+        return NULL;
+    }
+
+    self = calloc(1, sizeof(*self));
+    if (self == NULL) {
+        return NULL;
+    }
+
+    if (aead_derive(key, AEAD_ALG_AES_GCM, sub) == 0) {
+        self->gcm = aes_gcm_key_create(sub, 256);
+    }
+    if (aead_derive(key, AEAD_ALG_CHACHA20_POLY1305, sub) == 0) {
+        self->chacha = chacha_poly_key_create(sub);
+    }
+    mbedtls_platform_zeroize(sub, sizeof(sub));
+
+    if (self->gcm == NULL || self->chacha == NULL) {
+        aead_key_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * @brief Wipe and free a handle from aead_key_create(). NULL is accepted.
+ */
+void aead_key_destroy(aead_key_t *self)
+{
+    if (self == NULL) {
+        return;
+    }
+    aes_gcm_key_destroy(self->gcm);
+    chacha_poly_key_destroy(self->chacha);
+    mbedtls_platform_zeroize(self, sizeof(*self));
+    free(self);
+}
+
+/* AAD of the inner AEAD = record header || caller AAD, fed as two AAD updates */
+static int aead_encrypt(const aead_key_t *key, uint8_t alg, const uint8_t *hdr,
+                        const uint8_t *aad, size_t aad_len,
+                        const uint8_t *in, size_t len, uint8_t *out, uint8_t *tag)
+{
+    int ret;
+
+    if (alg == AEAD_ALG_AES_GCM) {
+        aes_gcm_stream_t ctx;
+        ret = aes_gcm_stream_start(&ctx, key->gcm, AES_GCM_ENCRYPT, hdr + 1, AEAD_NONCE_LEN);
+        if (ret != 0) {
+            return ret;
+        }
+        ret = aes_gcm_stream_aad(&ctx, hdr, AEAD_HDR_LEN);
+        if (ret == 0) {
+            ret = aes_gcm_stream_aad(&ctx, aad, aad_len);
+        }
+        if (ret == 0) {
+            ret = aes_gcm_stream_update(&ctx, in, len, out);
+        }
+        if (ret == 0) {
+            return aes_gcm_stream_finish(&ctx, tag);
+        }
+        aes_gcm_stream_free(&ctx);
+        return ret;
+    }
+
+    if (alg == AEAD_ALG_CHACHA20_POLY1305) {
+        chacha_poly_stream_t ctx;
+        ret = chacha_poly_stream_start(&ctx, key->chacha, CHACHA_POLY_ENCRYPT, hdr + 1);
+        if (ret != 0) {
+            return ret;
+        }
+        ret = chacha_poly_stream_aad(&ctx, hdr, AEAD_HDR_LEN);
+        if (ret == 0) {
+            ret = chacha_poly_stream_aad(&ctx, aad, aad_len);
+        }
+        if (ret == 0) {
+            ret = chacha_poly_stream_update(&ctx, in, len, out);
+        }
+        if (ret == 0) {
+            return chacha_poly_stream_finish(&ctx, tag);
+        }
+        chacha_poly_stream_free(&ctx);
+        return ret;
+    }
+
+    return -4;
+}
+
+/* Same AAD as aead_encrypt(); *_stream_open() checks the tag before it decrypts */
+static int aead_decrypt(const aead_key_t *key, uint8_t alg, const uint8_t *hdr,
+                        const uint8_t *aad, size_t aad_len,
+                        const uint8_t *in, size_t len, const uint8_t *tag, uint8_t *out)
+{
+    int ret;
+
+    if (alg == AEAD_ALG_AES_GCM) {
+        aes_gcm_stream_t ctx;
+        ret = aes_gcm_stream_start(&ctx, key->gcm, AES_GCM_DECRYPT, hdr + 1, AEAD_NONCE_LEN);
+        if (ret != 0) {
+            return ret;
+        }
+        ret = aes_gcm_stream_aad(&ctx, hdr, AEAD_HDR_LEN);
+        if (ret == 0) {
+            ret = aes_gcm_stream_aad(&ctx, aad, aad_len);
+        }
+        if (ret == 0) {
+            ret = aes_gcm_stream_open(&ctx, in, len, tag, out);
+        }
+        aes_gcm_stream_free(&ctx);
+        return ret;
+    }
+
+    if (alg == AEAD_ALG_CHACHA20_POLY1305) {
+        chacha_poly_stream_t ctx;
+        ret = chacha_poly_stream_start(&ctx, key->chacha, CHACHA_POLY_DECRYPT, hdr + 1);
+        if (ret != 0) {
+            return ret;
+        }
+        ret = chacha_poly_stream_aad(&ctx, hdr, AEAD_HDR_LEN);
+        if (ret == 0) {
+            ret = chacha_poly_stream_aad(&ctx, aad, aad_len);
+        }
+        if (ret == 0) {
+            ret = chacha_poly_stream_open(&ctx, in, len, tag, out);
+        }
+        chacha_poly_stream_free(&ctx);
+        return ret;
+    }
+
+    return -4;
+}
+
+/**
+ * @brief Seal one record with the chosen algorithm.
+ *
+ * Output layout: [alg][nonce 12][ciphertext len][tag 16], AEAD_SEALED_LEN(len)
+ * bytes. The header is part of the authenticated data, so flipping the
+ * algorithm byte makes aead_open() fail instead of mis-decrypting.
+ *
+ * IMPORTANT NOTES:
+ *  - The nonce must be unique per key (shared by both algorithms).
+ *
+ * @param[in]  key       Handle from aead_key_create()
+ * @param[in]  alg       AEAD_ALG_AES_GCM or AEAD_ALG_CHACHA20_POLY1305
+ * @param[in]  nonce     12-byte nonce, copied into the header
+ * @param[in]  aad       Extra authenticated data, not stored (may be NULL if aad_len == 0)
+ * @param[in]  aad_len   AAD length in bytes
+ * @param[in]  plaintext Input bytes
+ * @param[in]  len       Input length in bytes
+ * @param[out] out       Output buffer (must not overlap plaintext)
+ * @param[in]  out_size  Output buffer size in bytes
+ * @param[out] out_len   Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small
+ *         -4 unknown algorithm
+ *         otherwise: mbedTLS error code
+ */
+int aead_seal(const aead_key_t *key, uint8_t alg, const uint8_t nonce[AEAD_NONCE_LEN],
+              const uint8_t *aad, size_t aad_len,
+              const uint8_t *plaintext, size_t len,
+              uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int ret;
+
+    if (key == NULL || nonce == NULL || out == NULL || out_len == NULL ||
+        (plaintext == NULL && len != 0) || (aad == NULL && aad_len != 0)) {
+        return -1;
+    }
+    if (alg != AEAD_ALG_AES_GCM && alg != AEAD_ALG_CHACHA20_POLY1305) {
+        return -4;
+    }
+    if (out_size < AEAD_SEALED_LEN(len)) {
+        return -2;
+    }
+
+    out[0] = alg;
+    memcpy(out + 1, nonce, AEAD_NONCE_LEN);
+
+    ret = aead_encrypt(key, alg, out, aad, aad_len,
+                       plaintext, len, out + AEAD_HDR_LEN, out + AEAD_HDR_LEN + len);
+    if (ret != 0) {
+        mbedtls_platform_zeroize(out, AEAD_SEALED_LEN(len));
+        return ret;
+    }
+
+    *out_len = AEAD_SEALED_LEN(len);
+    return 0;
+}
+
+/**
+ * @brief Open a record from aead_seal(), whatever algorithm it was sealed with.
+ *
+ * The tag is checked before anything is decrypted (aes_gcm_stream_open() /
+ * chacha_poly_stream_open()): a forged record costs one MAC pass and the
+ * plaintext buffer is never written. The header and the caller AAD go in
+ * as two AAD updates, no scratch copy is made.
+ *
+ * @param[in]  key       Handle from aead_key_create()
+ * @param[in]  aad       Same AAD as given to aead_seal()
+ * @param[in]  aad_len   AAD length in bytes
+ * @param[in]  in        Sealed record
+ * @param[in]  in_len    Sealed record length in bytes
+ * @param[out] plaintext Output buffer (may equal in + AEAD_HDR_LEN)
+ * @param[in]  pt_size   Output buffer size in bytes
+ * @param[out] pt_len    Plaintext length
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 record too short
+ *         -3 authentication failed (plaintext untouched)
+ *         -4 unknown algorithm byte
+ *         -5 output buffer too small
+ *         otherwise: mbedTLS error code
+ */
+int aead_open(const aead_key_t *key,
+              const uint8_t *aad, size_t aad_len,
+              const uint8_t *in, size_t in_len,
+              uint8_t *plaintext, size_t pt_size, size_t *pt_len)
+{
+    int ret;
+    size_t len;
+
+    if (key == NULL || in == NULL || pt_len == NULL ||
+        (aad == NULL && aad_len != 0)) {
+        return -1;
+    }
+    if (in_len < AEAD_SEALED_LEN(0)) {
+        return -2;
+    }
+
+    len = in_len - AEAD_SEALED_LEN(0);
+    if (pt_size < len || (plaintext == NULL && len != 0)) {
+        return -5;
+    }
+
+    ret = aead_decrypt(key, in[0], in, aad, aad_len,
+                       in + AEAD_HDR_LEN, len, in + AEAD_HDR_LEN + len, plaintext);
+    if (ret != 0) {
+        return ret;
+    }
+
+    *pt_len = len;
+    return 0;
+}
+
+/**
+ * @brief Printable name of an AEAD_ALG_* byte (for logs / benchmarks).
+ */
+const char *aead_alg_name(uint8_t alg)
+{
+    switch (alg) {
+    case AEAD_ALG_AES_GCM:           return "AES-256-GCM";
+    case AEAD_ALG_CHACHA20_POLY1305: return "ChaCha20-Poly1305";
+    default:                         return "unknown";
+    }
+}
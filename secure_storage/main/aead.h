@@ -0,0 +1,42 @@
+#ifndef AEAD_H
+#define AEAD_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+
+/* Algorithm byte, first byte of every sealed record */
+#define AEAD_ALG_AES_GCM            0x01
+#define AEAD_ALG_CHACHA20_POLY1305  0x02
+
+#define AEAD_KEY_LEN    32
+#define AEAD_NONCE_LEN  12
+#define AEAD_TAG_LEN    16
+#define AEAD_HDR_LEN    (1 + AEAD_NONCE_LEN)
+
+/* Sealed record: [alg][nonce 12][ciphertext len][tag 16] */
+#define AEAD_SEALED_LEN(len)  ((size_t)(len) + AEAD_HDR_LEN + AEAD_TAG_LEN)
+
+/* One handle for both algorithms (opaque), each keyed with its own subkey.
+ * Read-only after create, can be shared between tasks.
+ */
+typedef struct aead_key aead_key_t;
+
+aead_key_t *aead_key_create(const uint8_t key[AEAD_KEY_LEN]);
+void        aead_key_destroy(aead_key_t *self);
+
+// alg == AEAD_ALG_*, the algorithm byte and nonce are authenticated
+int aead_seal(const aead_key_t *key, uint8_t alg, const uint8_t nonce[AEAD_NONCE_LEN],
+              const uint8_t *aad, size_t aad_len,
+              const uint8_t *plaintext, size_t len,
+              uint8_t *out, size_t out_size, size_t *out_len);
+
+// Algorithm is taken from the record header, tag checked before decrypting
+// (plaintext is not written when it does not match)
+int aead_open(const aead_key_t *key,
+              const uint8_t *aad, size_t aad_len,
+              const uint8_t *in, size_t in_len,
+              uint8_t *plaintext, size_t pt_size, size_t *pt_len);
+
+const char *aead_alg_name(uint8_t alg);
+
+#endif // AEAD_H
@@ -0,0 +1,223 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "aes_backend.h"
+#ifdef AES_BACKEND_HAVE_ESP_AES
+#include "aes/esp_aes.h"            // esp_aes_* (AES peripheral driver)
+#endif
+
+static const char *TAG = "AES_BACKEND";
+
+/* ---- mbedTLS: whatever the sdkconfig selects (on the ESP32 with
+ *      CONFIG_MBEDTLS_HARDWARE_AES this already ends in the peripheral,
+ *      on the linux host it is mbedTLS' software AES).
+ */
+
+static int mbed_setkey(aes_backend_key_t *rk, const uint8_t *key, unsigned keybits, int which)
+{
+    int ret = 0;
+
+    mbedtls_aes_init(&rk->mbed.enc);
+    mbedtls_aes_init(&rk->mbed.dec);
+    if (which & AES_BACKEND_KEY_ENC) {
+        ret = mbedtls_aes_setkey_enc(&rk->mbed.enc, key, keybits);
+    }
+    if (ret == 0 && (which & AES_BACKEND_KEY_DEC)) {
+        ret = mbedtls_aes_setkey_dec(&rk->mbed.dec, key, keybits);
+    }
+    return ret;
+}
+
+static void mbed_clear(aes_backend_key_t *rk)
+{
+    mbedtls_aes_free(&rk->mbed.enc); // mbedTLS zeroizes the round keys
+    mbedtls_aes_free(&rk->mbed.dec);
+}
+
+/* mbedTLS takes non-const contexts but only reads the round keys */
+#define MBED_ENC(rk)  ((mbedtls_aes_context *)&(rk)->mbed.enc)
+#define MBED_DEC(rk)  ((mbedtls_aes_context *)&(rk)->mbed.dec)
+
+static int mbed_ecb(const aes_backend_key_t *rk, int mode, const uint8_t in[16], uint8_t out[16])
+{
+    return mbedtls_aes_crypt_ecb(mode ? MBED_ENC(rk) : MBED_DEC(rk),
+                                 mode ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT, in, out);
+}
+
+static int mbed_cbc(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    return mbedtls_aes_crypt_cbc(mode ? MBED_ENC(rk) : MBED_DEC(rk),
+                                 mode ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
+                                 len, iv, in, out);
+}
+
+static int mbed_ctr(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                    uint8_t counter[16], uint8_t stream_block[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    return mbedtls_aes_crypt_ctr(MBED_ENC(rk), len, nc_off, counter, stream_block, in, out);
+}
+
+const aes_backend_t aes_backend_mbedtls = {
+    .name      = "mbedtls",
+    .available = NULL,
+    .setkey    = mbed_setkey,
+    .clear     = mbed_clear,
+    .ecb       = mbed_ecb,
+    .cbc       = mbed_cbc,
+    .ctr       = mbed_ctr,
+    .cbc_multi = NULL,
+};
+
+/* ---- ESP32 AES peripheral through the esp_aes driver directly, whatever
+ *      mbedTLS is configured for. The peripheral expands the key itself,
+ *      so one context serves both directions.
+ */
+#ifdef AES_BACKEND_HAVE_ESP_AES
+
+static int esp_setkey(aes_backend_key_t *rk, const uint8_t *key, unsigned keybits, int which)
+{
+    (void)which;
+    esp_aes_init(&rk->mbed.enc);
+    return esp_aes_setkey(&rk->mbed.enc, key, keybits);
+}
+
+static void esp_clear(aes_backend_key_t *rk)
+{
+    esp_aes_free(&rk->mbed.enc);
+}
+
+static int esp_ecb(const aes_backend_key_t *rk, int mode, const uint8_t in[16], uint8_t out[16])
+{
+    return esp_aes_crypt_ecb(MBED_ENC(rk), mode, in, out);
+}
+
+static int esp_cbc(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                   const uint8_t *in, uint8_t *out)
+{
+    return esp_aes_crypt_cbc(MBED_ENC(rk), mode, len, iv, in, out);
+}
+
+static int esp_ctr(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                   uint8_t counter[16], uint8_t stream_block[16],
+                   const uint8_t *in, uint8_t *out)
+{
+    return esp_aes_crypt_ctr(MBED_ENC(rk), len, nc_off, counter, stream_block, in, out);
+}
+
+const aes_backend_t aes_backend_esp_aes = {
+    .name      = "esp_aes",
+    .available = NULL,
+    .setkey    = esp_setkey,
+    .clear     = esp_clear,
+    .ecb       = esp_ecb,
+    .cbc       = esp_cbc,
+    .ctr       = esp_ctr,
+    .cbc_multi = NULL,
+};
+
+#endif // AES_BACKEND_HAVE_ESP_AES
+
+/* ---- Registry: preference order, fastest first. "soft" is never picked
+ *      automatically, it is the portable baseline.
+ */
+static const aes_backend_t *const s_backends[] = {
+#ifdef AES_BACKEND_HAVE_X86
+    &aes_backend_vaes,
+    &aes_backend_aesni,
+#endif
+#ifdef AES_BACKEND_HAVE_ESP_AES
+    &aes_backend_esp_aes,
+#endif
+    &aes_backend_mbedtls,
+    &aes_backend_soft,
+};
+
+#define BACKEND_COUNT  (sizeof(s_backends) / sizeof(s_backends[0]))
+
+static const aes_backend_t *s_active;
+
+static int backend_usable(const aes_backend_t *b)
+{
+    return b->available == NULL || b->available();
+}
+
+/**
+ * @brief Backend that new keys are bound to.
+ *
+ * Chosen on the first call: the first usable entry of s_backends (VAES,
+ * AES-NI, ESP32 peripheral, mbedTLS). Detection is a pure function of the
+ * CPU, so two tasks racing on the first call pick the same backend.
+ *
+ * @return Backend (never NULL)
+ */
+const aes_backend_t *aes_backend_active(void)
+{
+    const aes_backend_t *b = s_active;
+
+    if (b == NULL) {
+        b = &aes_backend_mbedtls;
+        for (size_t i = 0; i < BACKEND_COUNT; i++) {
+            if (s_backends[i] != &aes_backend_soft && backend_usable(s_backends[i])) {
+                b = s_backends[i];
+                break;
+            }
+        }
+        s_active = b;
+        ESP_LOGI(TAG, "using AES backend: %s", b->name);
+    }
+    return b;
+}
+
+/**
+ * @brief Force a backend by name (tests, benchmarks, provisioning tools).
+ *
+ * IMPORTANT NOTES:
+ *  - Call it at startup: existing keys keep the backend they were
+ *    created with, only keys created afterwards use the new one.
+ *
+ * @param[in] name  Backend name, see aes_backend.h
+ *
+ * @return 0 on success, -1 unknown or not usable on this machine
+ */
+int aes_backend_select(const char *name)
+{
+    if (name == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (strcmp(s_backends[i]->name, name) == 0 && backend_usable(s_backends[i])) {
+            s_active = s_backends[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Number of backends usable on this machine.
+ */
+size_t aes_backend_count(void)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        n += backend_usable(s_backends[i]) ? 1 : 0;
+    }
+    return n;
+}
+
+/**
+ * @brief index-th usable backend (0 .. aes_backend_count() - 1), NULL past the end.
+ */
+const aes_backend_t *aes_backend_get(size_t index)
+{
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (backend_usable(s_backends[i]) && index-- == 0) {
+            return s_backends[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,86 @@
+#ifndef AES_BACKEND_H
+#define AES_BACKEND_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "sdkconfig.h"
+#include "mbedtls/aes.h"
+
+/* Backends compiled into this build */
+#if defined(__x86_64__) || defined(__i386__)
+#define AES_BACKEND_HAVE_X86      1   // AES-NI / VAES (used when CPUID reports them)
+#endif
+#if CONFIG_MBEDTLS_HARDWARE_AES && !CONFIG_IDF_TARGET_LINUX
+#define AES_BACKEND_HAVE_ESP_AES  1   // ESP32 AES peripheral, called directly
+#endif
+
+// Max independent streams per cbc_multi() call
+#define AES_BACKEND_MB_LANES  8
+
+// setkey() 'which' flags
+#define AES_BACKEND_KEY_ENC  0x1
+#define AES_BACKEND_KEY_DEC  0x2
+
+/* Round keys for any backend (lives inside aes_cbc_key_t) */
+typedef union {
+    struct {
+        mbedtls_aes_context enc;     // mbedtls / esp_aes backends
+        mbedtls_aes_context dec;
+    } mbed;
+    struct {
+        uint8_t enc[15 * 16] __attribute__((aligned(16)));   // FIPS-197 byte order
+        uint8_t dec[15 * 16] __attribute__((aligned(16)));   // AES-NI: InvMixColumns'ed
+        int rounds;                  // 10 / 12 / 14
+    } raw;                           // soft / aesni / vaes backends
+} aes_backend_key_t;
+
+/* Cipher backend: one block-cipher implementation behind the AES modes.
+ * The ops follow the mbedtls_aes_crypt_* contracts (mode = AES_CBC_ENCRYPT /
+ * AES_CBC_DECRYPT, iv / counter updated in place, CTR nc_off + stream block).
+ * Round keys are only read by the crypt ops, so a key can be shared.
+ *
+ * cbc_multi (optional, NULL = not supported) runs n <= AES_BACKEND_MB_LANES
+ * independent CBC streams in lockstep: same len (multiple of 16) and same
+ * key size for all lanes, one key / iv / in / out per lane.
+ */
+typedef struct aes_backend {
+    const char *name;
+    int  (*available)(void);         // runtime check (CPUID etc.), NULL = always
+    int  (*setkey)(aes_backend_key_t *rk, const uint8_t *key, unsigned keybits, int which);
+    void (*clear)(aes_backend_key_t *rk);
+    int  (*ecb)(const aes_backend_key_t *rk, int mode, const uint8_t in[16], uint8_t out[16]);
+    int  (*cbc)(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                const uint8_t *in, uint8_t *out);
+    int  (*ctr)(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                uint8_t counter[16], uint8_t stream_block[16],
+                const uint8_t *in, uint8_t *out);
+    int  (*cbc_multi)(const aes_backend_key_t *const rk[], int mode, size_t n, size_t len,
+                      uint8_t *const iv[], const uint8_t *const in[], uint8_t *const out[]);
+} aes_backend_t;
+
+// Backend used by new keys; picked once (fastest available) on first use
+const aes_backend_t *aes_backend_active(void);
+
+// Override the choice by name ("vaes", "aesni", "esp_aes", "mbedtls", "soft").
+// Only affects keys created afterwards. Returns 0, or -1 if not available here.
+int aes_backend_select(const char *name);
+
+// Backends usable on this machine, fastest first (for reports / tests)
+size_t               aes_backend_count(void);
+const aes_backend_t *aes_backend_get(size_t index);
+
+/* Implementations (aes_backend_*.c) */
+extern const aes_backend_t aes_backend_mbedtls;
+extern const aes_backend_t aes_backend_soft;
+#ifdef AES_BACKEND_HAVE_ESP_AES
+extern const aes_backend_t aes_backend_esp_aes;
+#endif
+#ifdef AES_BACKEND_HAVE_X86
+extern const aes_backend_t aes_backend_aesni;
+extern const aes_backend_t aes_backend_vaes;
+#endif
+
+// Portable FIPS-197 key expansion (byte order), returns rounds or 0 on bad size
+int aes_soft_expand_key(const uint8_t *key, unsigned keybits, uint8_t rk[15 * 16]);
+
+#endif // AES_BACKEND_H
@@ -0,0 +1,254 @@
+#include <string.h>
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_backend.h"
+#include "aes_cbc.h"                // AES_CBC_ENCRYPT / AES_CBC_DECRYPT
+
+/* Portable byte-oriented AES (FIPS-197). Always available, no tables
+ * beyond the two S-boxes, so it fits anywhere: the reference/baseline
+ * backend and the key schedule provider for AES-NI.
+ *
+ * NOTE: S-box lookups are indexed by secret data (cache timing), like
+ * any table-based software AES. Prefer the hardware backends.
+ */
+
+static const uint8_t sbox[256] = {
+    0x63,0x7c,0x77,0x7b,0xf2,0x6b,0x6f,0xc5,0x30,0x01,0x67,0x2b,0xfe,0xd7,0xab,0x76,
+    0xca,0x82,0xc9,0x7d,0xfa,0x59,0x47,0xf0,0xad,0xd4,0xa2,0xaf,0x9c,0xa4,0x72,0xc0,
+    0xb7,0xfd,0x93,0x26,0x36,0x3f,0xf7,0xcc,0x34,0xa5,0xe5,0xf1,0x71,0xd8,0x31,0x15,
+    0x04,0xc7,0x23,0xc3,0x18,0x96,0x05,0x9a,0x07,0x12,0x80,0xe2,0xeb,0x27,0xb2,0x75,
+    0x09,0x83,0x2c,0x1a,0x1b,0x6e,0x5a,0xa0,0x52,0x3b,0xd6,0xb3,0x29,0xe3,0x2f,0x84,
+    0x53,0xd1,0x00,0xed,0x20,0xfc,0xb1,0x5b,0x6a,0xcb,0xbe,0x39,0x4a,0x4c,0x58,0xcf,
+    0xd0,0xef,0xaa,0xfb,0x43,0x4d,0x33,0x85,0x45,0xf9,0x02,0x7f,0x50,0x3c,0x9f,0xa8,
+    0x51,0xa3,0x40,0x8f,0x92,0x9d,0x38,0xf5,0xbc,0xb6,0xda,0x21,0x10,0xff,0xf3,0xd2,
+    0xcd,0x0c,0x13,0xec,0x5f,0x97,0x44,0x17,0xc4,0xa7,0x7e,0x3d,0x64,0x5d,0x19,0x73,
+    0x60,0x81,0x4f,0xdc,0x22,0x2a,0x90,0x88,0x46,0xee,0xb8,0x14,0xde,0x5e,0x0b,0xdb,
+    0xe0,0x32,0x3a,0x0a,0x49,0x06,0x24,0x5c,0xc2,0xd3,0xac,0x62,0x91,0x95,0xe4,0x79,
+    0xe7,0xc8,0x37,0x6d,0x8d,0xd5,0x4e,0xa9,0x6c,0x56,0xf4,0xea,0x65,0x7a,0xae,0x08,
+    0xba,0x78,0x25,0x2e,0x1c,0xa6,0xb4,0xc6,0xe8,0xdd,0x74,0x1f,0x4b,0xbd,0x8b,0x8a,
+    0x70,0x3e,0xb5,0x66,0x48,0x03,0xf6,0x0e,0x61,0x35,0x57,0xb9,0x86,0xc1,0x1d,0x9e,
+    0xe1,0xf8,0x98,0x11,0x69,0xd9,0x8e,0x94,0x9b,0x1e,0x87,0xe9,0xce,0x55,0x28,0xdf,
+    0x8c,0xa1,0x89,0x0d,0xbf,0xe6,0x42,0x68,0x41,0x99,0x2d,0x0f,0xb0,0x54,0xbb,0x16,
+};
+
+static const uint8_t rsbox[256] = {
+    0x52,0x09,0x6a,0xd5,0x30,0x36,0xa5,0x38,0xbf,0x40,0xa3,0x9e,0x81,0xf3,0xd7,0xfb,
+    0x7c,0xe3,0x39,0x82,0x9b,0x2f,0xff,0x87,0x34,0x8e,0x43,0x44,0xc4,0xde,0xe9,0xcb,
+    0x54,0x7b,0x94,0x32,0xa6,0xc2,0x23,0x3d,0xee,0x4c,0x95,0x0b,0x42,0xfa,0xc3,0x4e,
+    0x08,0x2e,0xa1,0x66,0x28,0xd9,0x24,0xb2,0x76,0x5b,0xa2,0x49,0x6d,0x8b,0xd1,0x25,
+    0x72,0xf8,0xf6,0x64,0x86,0x68,0x98,0x16,0xd4,0xa4,0x5c,0xcc,0x5d,0x65,0xb6,0x92,
+    0x6c,0x70,0x48,0x50,0xfd,0xed,0xb9,0xda,0x5e,0x15,0x46,0x57,0xa7,0x8d,0x9d,0x84,
+    0x90,0xd8,0xab,0x00,0x8c,0xbc,0xd3,0x0a,0xf7,0xe4,0x58,0x05,0xb8,0xb3,0x45,0x06,
+    0xd0,0x2c,0x1e,0x8f,0xca,0x3f,0x0f,0x02,0xc1,0xaf,0xbd,0x03,0x01,0x13,0x8a,0x6b,
+    0x3a,0x91,0x11,0x41,0x4f,0x67,0xdc,0xea,0x97,0xf2,0xcf,0xce,0xf0,0xb4,0xe6,0x73,
+    0x96,0xac,0x74,0x22,0xe7,0xad,0x35,0x85,0xe2,0xf9,0x37,0xe8,0x1c,0x75,0xdf,0x6e,
+    0x47,0xf1,0x1a,0x71,0x1d,0x29,0xc5,0x89,0x6f,0xb7,0x62,0x0e,0xaa,0x18,0xbe,0x1b,
+    0xfc,0x56,0x3e,0x4b,0xc6,0xd2,0x79,0x20,0x9a,0xdb,0xc0,0xfe,0x78,0xcd,0x5a,0xf4,
+    0x1f,0xdd,0xa8,0x33,0x88,0x07,0xc7,0x31,0xb1,0x12,0x10,0x59,0x27,0x80,0xec,0x5f,
+    0x60,0x51,0x7f,0xa9,0x19,0xb5,0x4a,0x0d,0x2d,0xe5,0x7a,0x9f,0x93,0xc9,0x9c,0xef,
+    0xa0,0xe0,0x3b,0x4d,0xae,0x2a,0xf5,0xb0,0xc8,0xeb,0xbb,0x3c,0x83,0x53,0x99,0x61,
+    0x17,0x2b,0x04,0x7e,0xba,0x77,0xd6,0x26,0xe1,0x69,0x14,0x63,0x55,0x21,0x0c,0x7d,
+};
+
+static uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+/**
+ * @brief FIPS-197 key expansion into byte-ordered round keys.
+ *
+ * Shared with the AES-NI backend (its round keys use the same layout).
+ *
+ * @return number of rounds (10 / 12 / 14), or 0 for a bad key size
+ */
+int aes_soft_expand_key(const uint8_t *key, unsigned keybits, uint8_t rk[15 * 16])
+{
+    unsigned nk = keybits / 32;
+    unsigned rounds = nk + 6;
+    uint8_t rcon = 0x01;
+
+    if (keybits != 128 && keybits != 192 && keybits != 256) {
+        return 0;
+    }
+
+    memcpy(rk, key, 4 * nk);
+    for (unsigned i = nk; i < 4 * (rounds + 1); i++) {
+        uint8_t t[4];
+        memcpy(t, rk + 4 * (i - 1), 4);
+
+        if (i % nk == 0) {
+            uint8_t t0 = t[0];
+            t[0] = sbox[t[1]] ^ rcon;
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[t0];
+            rcon = xtime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            for (int j = 0; j < 4; j++) {
+                t[j] = sbox[t[j]];
+            }
+        }
+
+        for (int j = 0; j < 4; j++) {
+            rk[4 * i + j] = rk[4 * (i - nk) + j] ^ t[j];
+        }
+    }
+    return (int)rounds;
+}
+
+static void mix_column(uint8_t *c)
+{
+    uint8_t a0 = c[0], a1 = c[1], a2 = c[2], a3 = c[3];
+    uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+    c[0] = a0 ^ all ^ xtime(a0 ^ a1);
+    c[1] = a1 ^ all ^ xtime(a1 ^ a2);
+    c[2] = a2 ^ all ^ xtime(a2 ^ a3);
+    c[3] = a3 ^ all ^ xtime(a3 ^ a0);
+}
+
+static void soft_encrypt_block(const uint8_t *rk, int rounds, const uint8_t in[16], uint8_t out[16])
+{
+    uint8_t s[16], t[16];
+
+    for (int i = 0; i < 16; i++) {
+        s[i] = in[i] ^ rk[i];
+    }
+
+    for (int r = 1; r <= rounds; r++) {
+        /*  SubBytes + ShiftRows (row 'row' of column 'c' comes from column c + row) */
+        for (int c = 0; c < 4; c++) {
+            for (int row = 0; row < 4; row++) {
+                t[4 * c + row] = sbox[s[4 * ((c + row) & 3) + row]];
+            }
+        }
+        if (r != rounds) {
+            for (int c = 0; c < 4; c++) {
+                mix_column(t + 4 * c);
+            }
+        }
+        for (int i = 0; i < 16; i++) {
+            s[i] = t[i] ^ rk[16 * r + i];
+        }
+    }
+
+    memcpy(out, s, 16);
+}
+
+static void soft_decrypt_block(const uint8_t *rk, int rounds, const uint8_t in[16], uint8_t out[16])
+{
+    uint8_t s[16], t[16];
+
+    for (int i = 0; i < 16; i++) {
+        s[i] = in[i] ^ rk[16 * rounds + i];
+    }
+
+    for (int r = rounds - 1; r >= 0; r--) {
+        /*  InvShiftRows + InvSubBytes + AddRoundKey */
+        for (int c = 0; c < 4; c++) {
+            for (int row = 0; row < 4; row++) {
+                t[4 * c + row] = rsbox[s[4 * ((c - row + 4) & 3) + row]] ^ rk[16 * r + 4 * c + row];
+            }
+        }
+        if (r != 0) {
+            /*  InvMixColumns = MixColumns after a pre-multiplication */
+            for (int c = 0; c < 4; c++) {
+                uint8_t *col = t + 4 * c;
+                uint8_t u = xtime(xtime(col[0] ^ col[2]));
+                uint8_t v = xtime(xtime(col[1] ^ col[3]));
+                col[0] ^= u;
+                col[1] ^= v;
+                col[2] ^= u;
+                col[3] ^= v;
+                mix_column(col);
+            }
+        }
+        memcpy(s, t, 16);
+    }
+
+    memcpy(out, s, 16);
+}
+
+static int soft_setkey(aes_backend_key_t *rk, const uint8_t *key, unsigned keybits, int which)
+{
+    (void)which;                     // one schedule serves both directions
+    rk->raw.rounds = aes_soft_expand_key(key, keybits, rk->raw.enc);
+    return rk->raw.rounds ? 0 : MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+}
+
+static void soft_clear(aes_backend_key_t *rk)
+{
+    mbedtls_platform_zeroize(&rk->raw, sizeof(rk->raw));
+}
+
+static int soft_ecb(const aes_backend_key_t *rk, int mode, const uint8_t in[16], uint8_t out[16])
+{
+    if (mode == AES_CBC_ENCRYPT) {
+        soft_encrypt_block(rk->raw.enc, rk->raw.rounds, in, out);
+    } else {
+        soft_decrypt_block(rk->raw.enc, rk->raw.rounds, in, out);
+    }
+    return 0;
+}
+
+static int soft_cbc(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    uint8_t block[16];
+
+    if (len % 16 != 0) {
+        return MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH;
+    }
+
+    for (; len > 0; len -= 16, in += 16, out += 16) {
+        if (mode == AES_CBC_ENCRYPT) {
+            for (int i = 0; i < 16; i++) {
+                block[i] = in[i] ^ iv[i];
+            }
+            soft_encrypt_block(rk->raw.enc, rk->raw.rounds, block, out);
+            memcpy(iv, out, 16);
+        } else {
+            memcpy(block, in, 16);   // in may equal out
+            soft_decrypt_block(rk->raw.enc, rk->raw.rounds, in, out);
+            for (int i = 0; i < 16; i++) {
+                out[i] ^= iv[i];
+            }
+            memcpy(iv, block, 16);
+        }
+    }
+    return 0;
+}
+
+static int soft_ctr(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                    uint8_t counter[16], uint8_t stream_block[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    size_t n = *nc_off;
+
+    for (size_t i = 0; i < len; i++) {
+        if (n == 0) {
+            soft_encrypt_block(rk->raw.enc, rk->raw.rounds, counter, stream_block);
+            for (int j = 15; j >= 0; j--) {
+                if (++counter[j] != 0) {
+                    break;
+                }
+            }
+        }
+        out[i] = in[i] ^ stream_block[n];
+        n = (n + 1) & 0x0F;
+    }
+
+    *nc_off = n;
+    return 0;
+}
+
+const aes_backend_t aes_backend_soft = {
+    .name      = "soft",
+    .available = NULL,
+    .setkey    = soft_setkey,
+    .clear     = soft_clear,
+    .ecb       = soft_ecb,
+    .cbc       = soft_cbc,
+    .ctr       = soft_ctr,
+    .cbc_multi = NULL,
+};
@@ -0,0 +1,567 @@
+#include "aes_backend.h"
+
+#ifdef AES_BACKEND_HAVE_X86
+
+#include <string.h>
+#include <cpuid.h>
+#include <immintrin.h>
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc.h"                // AES_CBC_ENCRYPT / AES_CBC_DECRYPT
+
+/* x86 AES-NI and VAES backends (linux host build: provisioning tools, tests).
+ * Round keys come from the portable expansion; the decryption schedule is
+ * the reversed encryption schedule with AESIMC applied to the inner keys.
+ * Bulk CBC decryption and CTR keep 8 blocks in flight to hide the AESENC /
+ * AESDEC latency; CBC encryption is inherently one block at a time, so
+ * cbc_multi() gets its parallelism from independent streams instead.
+ */
+
+#define X86_TARGET       __attribute__((target("aes,sse4.1")))
+#define X86_VAES_TARGET  __attribute__((target("aes,sse4.1,avx2,vaes")))
+#define LANES            8
+
+/* ---------------------------------------------------------------- detection */
+
+static int cpu_has_aesni(void)
+{
+    unsigned a, b, c, d;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d)) {
+        return 0;
+    }
+    return (c & bit_AES) && (c & bit_SSE4_1);
+}
+
+static int cpu_has_vaes(void)
+{
+    unsigned a, b, c, d;
+    unsigned xcr0_lo, xcr0_hi;
+
+    if (!cpu_has_aesni() || !__get_cpuid(1, &a, &b, &c, &d) ||
+        !(c & bit_OSXSAVE) || !(c & bit_AVX)) {
+        return 0;
+    }
+
+    /*  The OS must save the YMM state (XCR0 bits 1 and 2) */
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) {
+        return 0;
+    }
+
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        return 0;
+    }
+    return (b & bit_AVX2) && (c & (1u << 9));            // CPUID.7.0:ECX[9] = VAES
+}
+
+/* ------------------------------------------------------------- key schedule */
+
+X86_TARGET
+static int ni_setkey(aes_backend_key_t *rk, const uint8_t *key, unsigned keybits, int which)
+{
+    int rounds = aes_soft_expand_key(key, keybits, rk->raw.enc);
+
+    if (rounds == 0) {
+        return MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+    }
+    rk->raw.rounds = rounds;
+
+    if (which & AES_BACKEND_KEY_DEC) {
+        const __m128i *ek = (const __m128i *)rk->raw.enc;
+        __m128i *dk = (__m128i *)rk->raw.dec;
+
+        dk[0] = ek[rounds];
+        for (int i = 1; i < rounds; i++) {
+            dk[i] = _mm_aesimc_si128(ek[rounds - i]);
+        }
+        dk[rounds] = ek[0];
+    }
+    return 0;
+}
+
+static void ni_clear(aes_backend_key_t *rk)
+{
+    mbedtls_platform_zeroize(&rk->raw, sizeof(rk->raw));
+}
+
+/* ---------------------------------------------------------- block helpers */
+
+X86_TARGET
+static inline __m128i ni_enc1(const __m128i *k, int rounds, __m128i m)
+{
+    m = _mm_xor_si128(m, k[0]);
+    for (int r = 1; r < rounds; r++) {
+        m = _mm_aesenc_si128(m, k[r]);
+    }
+    return _mm_aesenclast_si128(m, k[rounds]);
+}
+
+X86_TARGET
+static inline __m128i ni_dec1(const __m128i *k, int rounds, __m128i m)
+{
+    m = _mm_xor_si128(m, k[0]);
+    for (int r = 1; r < rounds; r++) {
+        m = _mm_aesdec_si128(m, k[r]);
+    }
+    return _mm_aesdeclast_si128(m, k[rounds]);
+}
+
+/* Counter block for 128-bit big-endian value (hi, lo) */
+X86_TARGET
+static inline __m128i ctr_block(uint64_t hi, uint64_t lo)
+{
+    return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+}
+
+static inline void ctr_load(const uint8_t counter[16], uint64_t *hi, uint64_t *lo)
+{
+    uint64_t h, l;
+    memcpy(&h, counter, 8);
+    memcpy(&l, counter + 8, 8);
+    *hi = __builtin_bswap64(h);
+    *lo = __builtin_bswap64(l);
+}
+
+static inline void ctr_store(uint8_t counter[16], uint64_t hi, uint64_t lo)
+{
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+    memcpy(counter, &hi, 8);
+    memcpy(counter + 8, &lo, 8);
+}
+
+static inline void ctr_inc(uint64_t *hi, uint64_t *lo)
+{
+    if (++*lo == 0) {
+        ++*hi;
+    }
+}
+
+/* ------------------------------------------------------------- AES-NI ops */
+
+X86_TARGET
+static int ni_ecb(const aes_backend_key_t *rk, int mode, const uint8_t in[16], uint8_t out[16])
+{
+    __m128i m = _mm_loadu_si128((const __m128i *)in);
+
+    if (mode == AES_CBC_ENCRYPT) {
+        m = ni_enc1((const __m128i *)rk->raw.enc, rk->raw.rounds, m);
+    } else {
+        m = ni_dec1((const __m128i *)rk->raw.dec, rk->raw.rounds, m);
+    }
+    _mm_storeu_si128((__m128i *)out, m);
+    return 0;
+}
+
+X86_TARGET
+static void ni_cbc_encrypt(const aes_backend_key_t *rk, size_t len, uint8_t iv[16],
+                           const uint8_t *in, uint8_t *out)
+{
+    const __m128i *k = (const __m128i *)rk->raw.enc;
+    __m128i c = _mm_loadu_si128((const __m128i *)iv);
+
+    for (; len > 0; len -= 16, in += 16, out += 16) {
+        c = _mm_xor_si128(c, _mm_loadu_si128((const __m128i *)in));
+        c = ni_enc1(k, rk->raw.rounds, c);
+        _mm_storeu_si128((__m128i *)out, c);
+    }
+    _mm_storeu_si128((__m128i *)iv, c);
+}
+
+X86_TARGET
+static void ni_cbc_decrypt(const aes_backend_key_t *rk, size_t len, uint8_t iv[16],
+                           const uint8_t *in, uint8_t *out)
+{
+    const __m128i *k = (const __m128i *)rk->raw.dec;
+    const int rounds = rk->raw.rounds;
+    __m128i prev = _mm_loadu_si128((const __m128i *)iv);
+
+    /*  8 independent AESDEC chains; all input is loaded before any store (in-place safe) */
+    for (; len >= 16 * LANES; len -= 16 * LANES, in += 16 * LANES, out += 16 * LANES) {
+        __m128i c[LANES], m[LANES];
+
+        for (int j = 0; j < LANES; j++) {
+            c[j] = _mm_loadu_si128((const __m128i *)in + j);
+            m[j] = _mm_xor_si128(c[j], k[0]);
+        }
+        for (int r = 1; r < rounds; r++) {
+            for (int j = 0; j < LANES; j++) {
+                m[j] = _mm_aesdec_si128(m[j], k[r]);
+            }
+        }
+        for (int j = 0; j < LANES; j++) {
+            m[j] = _mm_aesdeclast_si128(m[j], k[rounds]);
+        }
+
+        _mm_storeu_si128((__m128i *)out, _mm_xor_si128(m[0], prev));
+        for (int j = 1; j < LANES; j++) {
+            _mm_storeu_si128((__m128i *)out + j, _mm_xor_si128(m[j], c[j - 1]));
+        }
+        prev = c[LANES - 1];
+    }
+
+    for (; len > 0; len -= 16, in += 16, out += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)in);
+        _mm_storeu_si128((__m128i *)out, _mm_xor_si128(ni_dec1(k, rounds, c), prev));
+        prev = c;
+    }
+    _mm_storeu_si128((__m128i *)iv, prev);
+}
+
+X86_TARGET
+static int ni_cbc(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                  const uint8_t *in, uint8_t *out)
+{
+    if (len % 16 != 0) {
+        return MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH;
+    }
+    if (mode == AES_CBC_ENCRYPT) {
+        ni_cbc_encrypt(rk, len, iv, in, out);
+    } else {
+        ni_cbc_decrypt(rk, len, iv, in, out);
+    }
+    return 0;
+}
+
+/* Leftover keystream bytes from a previous call (mbedtls_aes_crypt_ctr contract) */
+static size_t ctr_drain(size_t *nc_off, const uint8_t stream_block[16],
+                        const uint8_t **in, uint8_t **out, size_t len)
+{
+    size_t n = *nc_off;
+    size_t used = 0;
+
+    while (n != 0 && used < len) {
+        (*out)[used] = (*in)[used] ^ stream_block[n];
+        n = (n + 1) & 0x0F;
+        used++;
+    }
+    *nc_off = n;
+    *in += used;
+    *out += used;
+    return len - used;
+}
+
+/* Partial last block: keep the keystream for the next call */
+X86_TARGET
+static void ctr_tail(const __m128i *k, int rounds, uint64_t *hi, uint64_t *lo,
+                     size_t *nc_off, uint8_t stream_block[16],
+                     const uint8_t *in, uint8_t *out, size_t len)
+{
+    for (; len > 0; len -= 16, in += 16, out += 16) {
+        __m128i ks = ni_enc1(k, rounds, ctr_block(*hi, *lo));
+        ctr_inc(hi, lo);
+
+        if (len < 16) {
+            _mm_storeu_si128((__m128i *)stream_block, ks);
+            for (size_t i = 0; i < len; i++) {
+                out[i] = in[i] ^ stream_block[i];
+            }
+            *nc_off = len;
+            return;
+        }
+        _mm_storeu_si128((__m128i *)out,
+                         _mm_xor_si128(ks, _mm_loadu_si128((const __m128i *)in)));
+    }
+}
+
+X86_TARGET
+static int ni_ctr(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                  uint8_t counter[16], uint8_t stream_block[16],
+                  const uint8_t *in, uint8_t *out)
+{
+    const __m128i *k = (const __m128i *)rk->raw.enc;
+    const int rounds = rk->raw.rounds;
+    uint64_t hi, lo;
+
+    len = ctr_drain(nc_off, stream_block, &in, &out, len);
+    ctr_load(counter, &hi, &lo);
+
+    for (; len >= 16 * LANES; len -= 16 * LANES, in += 16 * LANES, out += 16 * LANES) {
+        __m128i m[LANES];
+
+        for (int j = 0; j < LANES; j++) {
+            m[j] = _mm_xor_si128(ctr_block(hi, lo), k[0]);
+            ctr_inc(&hi, &lo);
+        }
+        for (int r = 1; r < rounds; r++) {
+            for (int j = 0; j < LANES; j++) {
+                m[j] = _mm_aesenc_si128(m[j], k[r]);
+            }
+        }
+        for (int j = 0; j < LANES; j++) {
+            m[j] = _mm_aesenclast_si128(m[j], k[rounds]);
+            _mm_storeu_si128((__m128i *)out + j,
+                             _mm_xor_si128(m[j], _mm_loadu_si128((const __m128i *)in + j)));
+        }
+    }
+
+    ctr_tail(k, rounds, &hi, &lo, nc_off, stream_block, in, out, len);
+    ctr_store(counter, hi, lo);
+    return 0;
+}
+
+/* ------------------------------------------------ multi-buffer CBC (lanes) */
+
+/* One block of every lane per step: lane l only depends on its own previous
+ * block, so W chains of AESENC/AESDEC overlap in the pipeline. W is a
+ * compile-time constant (always_inline) and the lane loops are fully
+ * unrolled, so the lane state stays in XMM registers. All loads of a step
+ * happen before its stores (in-place safe).
+ */
+#define LANE_LOOP  _Pragma("GCC unroll 8")
+
+X86_TARGET __attribute__((always_inline))
+static inline void ni_cbc_enc_lanes(const aes_backend_key_t *const rk[], const size_t W, size_t len,
+                                    uint8_t *const iv[], const uint8_t *const in[], uint8_t *const out[])
+{
+    const int rounds = rk[0]->raw.rounds;
+    const __m128i *k[LANES];
+    __m128i v[LANES];
+
+    for (size_t l = 0; l < W; l++) {
+        k[l] = (const __m128i *)rk[l]->raw.enc;
+        v[l] = _mm_loadu_si128((const __m128i *)iv[l]);
+    }
+
+    for (size_t off = 0; off < len; off += 16) {
+        LANE_LOOP
+        for (size_t l = 0; l < W; l++) {
+            v[l] = _mm_xor_si128(v[l], _mm_loadu_si128((const __m128i *)(in[l] + off)));
+            v[l] = _mm_xor_si128(v[l], k[l][0]);
+        }
+        for (int r = 1; r < rounds; r++) {
+            LANE_LOOP
+            for (size_t l = 0; l < W; l++) {
+                v[l] = _mm_aesenc_si128(v[l], k[l][r]);
+            }
+        }
+        LANE_LOOP
+        for (size_t l = 0; l < W; l++) {
+            v[l] = _mm_aesenclast_si128(v[l], k[l][rounds]);
+            _mm_storeu_si128((__m128i *)(out[l] + off), v[l]);
+        }
+    }
+
+    for (size_t l = 0; l < W; l++) {
+        _mm_storeu_si128((__m128i *)iv[l], v[l]);
+    }
+}
+
+X86_TARGET __attribute__((always_inline))
+static inline void ni_cbc_dec_lanes(const aes_backend_key_t *const rk[], const size_t W, size_t len,
+                                    uint8_t *const iv[], const uint8_t *const in[], uint8_t *const out[])
+{
+    const int rounds = rk[0]->raw.rounds;
+    const __m128i *k[LANES];
+    __m128i prev[LANES], c[LANES], m[LANES];
+
+    for (size_t l = 0; l < W; l++) {
+        k[l] = (const __m128i *)rk[l]->raw.dec;
+        prev[l] = _mm_loadu_si128((const __m128i *)iv[l]);
+    }
+
+    for (size_t off = 0; off < len; off += 16) {
+        LANE_LOOP
+        for (size_t l = 0; l < W; l++) {
+            c[l] = _mm_loadu_si128((const __m128i *)(in[l] + off));
+            m[l] = _mm_xor_si128(c[l], k[l][0]);
+        }
+        for (int r = 1; r < rounds; r++) {
+            LANE_LOOP
+            for (size_t l = 0; l < W; l++) {
+                m[l] = _mm_aesdec_si128(m[l], k[l][r]);
+            }
+        }
+        LANE_LOOP
+        for (size_t l = 0; l < W; l++) {
+            m[l] = _mm_aesdeclast_si128(m[l], k[l][rounds]);
+            _mm_storeu_si128((__m128i *)(out[l] + off), _mm_xor_si128(m[l], prev[l]));
+            prev[l] = c[l];
+        }
+    }
+
+    for (size_t l = 0; l < W; l++) {
+        _mm_storeu_si128((__m128i *)iv[l], prev[l]);
+    }
+}
+
+/* Lane counts are rounded up to 1 / 2 / 4 / 8; the padding lanes repeat
+ * lane 0 (same key, input, output and IV), so they store identical bytes.
+ */
+X86_TARGET
+static int ni_cbc_multi(const aes_backend_key_t *const rk[], int mode, size_t n, size_t len,
+                        uint8_t *const iv[], const uint8_t *const in[], uint8_t *const out[])
+{
+    const aes_backend_key_t *lk[LANES];
+    uint8_t *liv[LANES];
+    const uint8_t *lin[LANES];
+    uint8_t *lout[LANES];
+    size_t w = (n > 4) ? 8 : (n > 2) ? 4 : n;
+
+    if (n == 0 || n > LANES || len % 16 != 0) {
+        return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+    }
+    if (n == 1) {
+        return ni_cbc(rk[0], mode, len, iv[0], in[0], out[0]);    // single stream: 8-block decrypt pipeline
+    }
+
+    for (size_t l = 0; l < w; l++) {
+        size_t s = (l < n) ? l : 0;
+        if (rk[s]->raw.rounds != rk[0]->raw.rounds) {
+            return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+        }
+        lk[l] = rk[s];
+        liv[l] = iv[s];
+        lin[l] = in[s];
+        lout[l] = out[s];
+    }
+
+    if (mode == AES_CBC_ENCRYPT) {
+        switch (w) {
+        case 1:  ni_cbc_enc_lanes(lk, 1, len, liv, lin, lout); break;
+        case 2:  ni_cbc_enc_lanes(lk, 2, len, liv, lin, lout); break;
+        case 4:  ni_cbc_enc_lanes(lk, 4, len, liv, lin, lout); break;
+        default: ni_cbc_enc_lanes(lk, 8, len, liv, lin, lout); break;
+        }
+    } else {
+        switch (w) {
+        case 1:  ni_cbc_dec_lanes(lk, 1, len, liv, lin, lout); break;
+        case 2:  ni_cbc_dec_lanes(lk, 2, len, liv, lin, lout); break;
+        case 4:  ni_cbc_dec_lanes(lk, 4, len, liv, lin, lout); break;
+        default: ni_cbc_dec_lanes(lk, 8, len, liv, lin, lout); break;
+        }
+    }
+    return 0;
+}
+
+const aes_backend_t aes_backend_aesni = {
+    .name      = "aesni",
+    .available = cpu_has_aesni,
+    .setkey    = ni_setkey,
+    .clear     = ni_clear,
+    .ecb       = ni_ecb,
+    .cbc       = ni_cbc,
+    .ctr       = ni_ctr,
+    .cbc_multi = ni_cbc_multi,
+};
+
+/* --------------------------------------------------------------- VAES ops */
+
+/* Same 8-block pipelines with two blocks per YMM register (4 registers) */
+
+X86_VAES_TARGET
+static void vaes_cbc_decrypt(const aes_backend_key_t *rk, size_t len, uint8_t iv[16],
+                             const uint8_t *in, uint8_t *out)
+{
+    const __m128i *k = (const __m128i *)rk->raw.dec;
+    const int rounds = rk->raw.rounds;
+    __m256i k2[15];
+    __m128i prev = _mm_loadu_si128((const __m128i *)iv);
+
+    for (int r = 0; r <= rounds; r++) {
+        k2[r] = _mm256_broadcastsi128_si256(k[r]);
+    }
+
+    for (; len >= 16 * LANES; len -= 16 * LANES, in += 16 * LANES, out += 16 * LANES) {
+        __m256i c[4], p[4], m[4];
+
+        for (int j = 0; j < 4; j++) {
+            c[j] = _mm256_loadu_si256((const __m256i *)in + j);
+            m[j] = _mm256_xor_si256(c[j], k2[0]);
+        }
+        /*  Previous ciphertext for each pair: (prev, C0), then (C1, C2), ... */
+        p[0] = _mm256_inserti128_si256(_mm256_castsi128_si256(prev),
+                                       _mm_loadu_si128((const __m128i *)in), 1);
+        for (int j = 1; j < 4; j++) {
+            p[j] = _mm256_loadu_si256((const __m256i *)(in + 32 * j - 16));
+        }
+
+        for (int r = 1; r < rounds; r++) {
+            for (int j = 0; j < 4; j++) {
+                m[j] = _mm256_aesdec_epi128(m[j], k2[r]);
+            }
+        }
+        prev = _mm256_extracti128_si256(c[3], 1);
+        for (int j = 0; j < 4; j++) {
+            m[j] = _mm256_aesdeclast_epi128(m[j], k2[rounds]);
+            _mm256_storeu_si256((__m256i *)out + j, _mm256_xor_si256(m[j], p[j]));
+        }
+    }
+
+    _mm_storeu_si128((__m128i *)iv, prev);
+    if (len > 0) {
+        ni_cbc_decrypt(rk, len, iv, in, out);
+    }
+}
+
+X86_VAES_TARGET
+static int vaes_cbc(const aes_backend_key_t *rk, int mode, size_t len, uint8_t iv[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    if (len % 16 != 0) {
+        return MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH;
+    }
+    if (mode == AES_CBC_ENCRYPT) {
+        ni_cbc_encrypt(rk, len, iv, in, out);
+    } else {
+        vaes_cbc_decrypt(rk, len, iv, in, out);
+    }
+    return 0;
+}
+
+X86_VAES_TARGET
+static int vaes_ctr(const aes_backend_key_t *rk, size_t len, size_t *nc_off,
+                    uint8_t counter[16], uint8_t stream_block[16],
+                    const uint8_t *in, uint8_t *out)
+{
+    const __m128i *k = (const __m128i *)rk->raw.enc;
+    const int rounds = rk->raw.rounds;
+    __m256i k2[15];
+    uint64_t hi, lo;
+
+    len = ctr_drain(nc_off, stream_block, &in, &out, len);
+    ctr_load(counter, &hi, &lo);
+
+    for (int r = 0; r <= rounds; r++) {
+        k2[r] = _mm256_broadcastsi128_si256(k[r]);
+    }
+
+    for (; len >= 16 * LANES; len -= 16 * LANES, in += 16 * LANES, out += 16 * LANES) {
+        __m256i m[4];
+
+        for (int j = 0; j < 4; j++) {
+            __m128i a = ctr_block(hi, lo);
+            ctr_inc(&hi, &lo);
+            __m128i b = ctr_block(hi, lo);
+            ctr_inc(&hi, &lo);
+            m[j] = _mm256_xor_si256(_mm256_set_m128i(b, a), k2[0]);
+        }
+        for (int r = 1; r < rounds; r++) {
+            for (int j = 0; j < 4; j++) {
+                m[j] = _mm256_aesenc_epi128(m[j], k2[r]);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            m[j] = _mm256_aesenclast_epi128(m[j], k2[rounds]);
+            _mm256_storeu_si256((__m256i *)out + j,
+                                _mm256_xor_si256(m[j], _mm256_loadu_si256((const __m256i *)in + j)));
+        }
+    }
+
+    ctr_tail(k, rounds, &hi, &lo, nc_off, stream_block, in, out, len);
+    ctr_store(counter, hi, lo);
+    return 0;
+}
+
+const aes_backend_t aes_backend_vaes = {
+    .name      = "vaes",
+    .available = cpu_has_vaes,
+    .setkey    = ni_setkey,
+    .clear     = ni_clear,
+    .ecb       = ni_ecb,
+    .cbc       = vaes_cbc,
+    .ctr       = vaes_ctr,
+    .cbc_multi = ni_cbc_multi,       // per-lane keys: YMM pairs would need a key shuffle per round
+};
+
+#endif // AES_BACKEND_HAVE_X86
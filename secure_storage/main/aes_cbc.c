@@ -4,7 +4,10 @@
 #include "esp_log.h"
 #include "esp_system.h"          // esp_fill_random()
 #include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
 #include "esp_random.h"
+#include "aes_cbc.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
 #include "pkcs_7.h"
 /**
  * @brief Encrypt plaintext using AES-CBC + PKCS#7 padding (AES block size = 16 bytes).
@@ -15,6 +18,7 @@
  *  - CBC requires the SAME IV for decryption, so you must store/transmit iv_in
  *  - This function allocates the ciphertext buffer with malloc()
  *    -> caller must free(*ciphertext)
+ *  - Use aes_cbc_encrypt_pkcs7_into() to avoid the allocation
  *
  * @param[in]  key            AES key bytes (length must match keybits/8)
  * @param[in]  keybits        AES key size in bits: 128 / 192 / 256
@@ -35,10 +39,6 @@ int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
                                 uint8_t **ciphertext, size_t *ciphertext_len)
 {
     int ret = 0;                     // Will store return codes from functions
-    mbedtls_aes_context aes;          // mbedTLS AES context (holds key schedule, etc.)
-    uint8_t iv[16];                  // Local IV copy (mbedtls_aes_crypt_cbc updates IV)
-    uint8_t *padded = NULL;          // Will hold PKCS#7 padded plaintext (malloc'd)
-    size_t padded_len = 0;           // Length of padded plaintext (multiple of 16)
 
     /*  Validate input pointers (avoid crashes / undefined behavior) */
     if (key == NULL || iv_in == NULL || plaintext == NULL ||
@@ -46,49 +46,18 @@ int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
         return -1;
     }
 
-    /*  PKCS#7 pad plaintext so its length becomes a multiple of 16 bytes */
-    ret = pkcs7_pad_16(plaintext, plaintext_len, &padded, &padded_len);
-    if (ret != 0) {
-        return ret;                  // pkcs7_pad_16 failed; nothing allocated to free here
-    }
-
-    /*  Allocate output buffer for ciphertext (same length as padded plaintext) */
-    uint8_t *out = (uint8_t *)malloc(padded_len);
+    /*  Allocate output buffer for ciphertext (plaintext + 1..16 bytes of padding) */
+    size_t out_size = AES_CBC_PKCS7_CIPHERTEXT_LEN(plaintext_len);
+    uint8_t *out = (uint8_t *)malloc(out_size);
     if (out == NULL) {
-        free(padded);                // padded was allocated; free it on failure
         return -2;
     }
 
-    /*  Copy IV into a local buffer because CBC encryption updates IV in-place */
-    memcpy(iv, iv_in, sizeof(iv));   // sizeof(iv) == 16
-
-    /*  Initialize AES context (must be done before using it) */
-    mbedtls_aes_init(&aes);
-
-    /* Set the AES encryption key (prepares internal round keys) */
-    ret = mbedtls_aes_setkey_enc(&aes, key, keybits);
-    if (ret != 0) {
-        mbedtls_aes_free(&aes);      // release internal resources
-        free(padded);
-        free(out);
-        return ret;
-    }
-
-    /* Encrypt using AES-CBC.
-     *    - MBEDTLS_AES_ENCRYPT selects encryption mode
-     *    - padded_len MUST be a multiple of 16 (ensured by PKCS#7 padding)
-     *    - iv will be modified by this call (streaming behavior)
-     */
-    ret = mbedtls_aes_crypt_cbc(&aes,
-                                MBEDTLS_AES_ENCRYPT,
-                                padded_len,
-                                iv,
-                                padded,
-                                out);
-
-    /*  Clean up AES context and temporary padded plaintext */
-    mbedtls_aes_free(&aes);
-    free(padded);
+    /*  Encrypt straight into the output buffer (no padded copy of the plaintext) */
+    size_t out_len = 0;
+    ret = aes_cbc_encrypt_pkcs7_into(key, keybits, iv_in,
+                                     plaintext, plaintext_len,
+                                     out, out_size, &out_len);
 
     /*  If encryption failed, free the output buffer and return error */
     if (ret != 0) {
@@ -98,7 +67,7 @@ int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
 
     /*  Return ciphertext pointer and length to caller */
     *ciphertext = out;
-    *ciphertext_len = padded_len;
+    *ciphertext_len = out_len;
 
     return 0;                        // Success
 }
@@ -113,7 +82,9 @@ int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
  *
  * MEMORY:
  *  - Allocates plaintext buffer (output) using malloc()
- *    -> caller must free(*plaintext)
+ *    -> caller must free(*plaintext), or crypto_scratch_free() to wipe it first
+ *  - The plaintext is NUL terminated for convenience (not counted in plaintext_len)
+ *  - Use aes_cbc_decrypt_pkcs7_into() to avoid the allocation
  *
  * @param[in]  key             AES key bytes (size must match keybits/8)
  * @param[in]  keybits         AES key size in bits: 128/192/256
@@ -127,7 +98,8 @@ int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
  *         -1 invalid args
  *         -2 invalid ciphertext length
  *         -3 malloc failed
- *         otherwise: mbedTLS or unpadding error code
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
  */
 int aes_cbc_decrypt_pkcs7(const uint8_t *key, unsigned keybits,
                                 const uint8_t iv_in[16],
@@ -135,8 +107,6 @@ int aes_cbc_decrypt_pkcs7(const uint8_t *key, unsigned keybits,
                                 uint8_t **plaintext, size_t *plaintext_len)
 {
     int ret = 0;                    // Holds return codes from called functions
-    mbedtls_aes_context aes;         // mbedTLS AES context
-    uint8_t iv[16];                 // Local IV copy (CBC updates IV in-place)
 
     /*  Validate pointers */
     if (key == NULL || iv_in == NULL || ciphertext == NULL ||
@@ -152,68 +122,408 @@ int aes_cbc_decrypt_pkcs7(const uint8_t *key, unsigned keybits,
         return -2;
     }
 
-    /*  Allocate a temporary buffer for the raw decrypted data (still padded).
-     *    Decryption output length equals ciphertext length in CBC mode.
+    /*  Allocate the plaintext buffer.
+     *    Padding is at least 1 byte, so ciphertext_len bytes always leave
+     *    room for the plaintext plus the NUL terminator.
      */
-    uint8_t *tmp = (uint8_t *)malloc(ciphertext_len);
-    if (tmp == NULL) {
+    uint8_t *out = (uint8_t *)malloc(ciphertext_len);
+    if (out == NULL) {
         return -3;
     }
 
-    /*  Copy IV into a local variable because mbedtls_aes_crypt_cbc modifies it */
-    memcpy(iv, iv_in, sizeof(iv));  // sizeof(iv) == 16
-
-    /*  Initialize AES context */
-    mbedtls_aes_init(&aes);
-
-    /*  Load AES key for decryption (builds decryption key schedule) */
-    ret = mbedtls_aes_setkey_dec(&aes, key, keybits);
+    /*  Decrypt and unpad directly into the output buffer */
+    size_t out_len = 0;
+    ret = aes_cbc_decrypt_pkcs7_into(key, keybits, iv_in,
+                                     ciphertext, ciphertext_len,
+                                     out, ciphertext_len, &out_len);
     if (ret != 0) {
-        mbedtls_aes_free(&aes);
-        free(tmp);
+        free(out);
         return ret;
     }
 
-    /*  Decrypt using AES-CBC
-     *    - MBEDTLS_AES_DECRYPT selects decryption mode
-     *    - ciphertext_len must be a multiple of 16 (validated above)
-     *    - iv is updated in-place (streaming behavior)
+    /*  Add null terminator for convenience (safe for printing) */
+    out[out_len] = 0;
+
+    /*  Return final plaintext buffer and length to the caller */
+    *plaintext = out;
+    *plaintext_len = out_len;
+
+    return 0;                       // Success
+}
+
+/* AES-CBC + PKCS#7 encryption with an already keyed handle.
+ * Shared by the raw-key and the keyed-handle entry points (args validated by caller).
+ * The handle is only read, see aes_cbc_key_create() for the sharing rules.
+ */
+static int cbc_encrypt_pkcs7_with(const aes_cbc_key_t *aes,
+                                  const uint8_t iv_in[16],
+                                  const uint8_t *plaintext, size_t plaintext_len,
+                                  uint8_t *ciphertext, size_t ciphertext_size,
+                                  size_t *ciphertext_len)
+{
+    int ret = 0;
+    uint8_t iv[16];                  // Local IV copy (the CBC op updates the IV)
+    uint8_t last[16];                // Last block: plaintext tail + PKCS#7 padding
+
+    /*  Split the input: full blocks are encrypted in place, the tail gets padded */
+    size_t full_len = plaintext_len - (plaintext_len % 16);
+    size_t out_len  = full_len + 16;
+    if (ciphertext_size < out_len) {
+        return -2;
+    }
+
+    /*  Build the padded last block BEFORE writing any output, so in-place
+     *  encryption does not overwrite the tail we still have to read.
      */
-    ret = mbedtls_aes_crypt_cbc(&aes,
-                                MBEDTLS_AES_DECRYPT,
-                                ciphertext_len,
-                                iv,
-                                ciphertext,
-                                tmp);
+    ret = pkcs7_pad_block_16(plaintext + full_len, plaintext_len - full_len, last);
+    if (ret != 0) {
+        return -1;
+    }
+
+    memcpy(iv, iv_in, sizeof(iv));
+
+    /*  Full blocks: plaintext -> ciphertext, no staging copy */
+    if (full_len > 0) {
+        ret = aes_key_cbc(aes, AES_CBC_ENCRYPT, full_len,
+                          iv, plaintext, ciphertext);
+        if (ret != 0) {
+            goto cleanup;
+        }
+    }
+
+    /*  Last block (iv now holds the previous ciphertext block) */
+    ret = aes_key_cbc(aes, AES_CBC_ENCRYPT, sizeof(last),
+                      iv, last, ciphertext + full_len);
+    if (ret == 0) {
+        *ciphertext_len = out_len;
+    }
+
+cleanup:
+    mbedtls_platform_zeroize(last, sizeof(last));   // holds plaintext bytes
+    return ret;
+}
+
+/* AES-CBC decryption + in-place PKCS#7 check with an already keyed handle.
+ * Shared by the raw-key and the keyed-handle entry points (args validated by caller).
+ */
+static int cbc_decrypt_pkcs7_with(const aes_cbc_key_t *aes,
+                                  const uint8_t iv_in[16],
+                                  const uint8_t *ciphertext, size_t ciphertext_len,
+                                  uint8_t *plaintext, size_t plaintext_size,
+                                  size_t *plaintext_len)
+{
+    int ret = 0;
+    uint8_t iv[16];                 // Local IV copy (CBC updates IV in-place)
+    uint8_t last[16];               // Decrypted last block (data + padding)
+    size_t tail_len = 0;            // Data bytes left in the last block
+
+    if (ciphertext_len == 0 || (ciphertext_len % 16) != 0) {
+        return -2;
+    }
+
+    /*  Everything before the last block is plaintext for sure */
+    size_t head_len = ciphertext_len - 16;
+    if (plaintext_size < head_len) {
+        return -3;
+    }
+
+    memcpy(iv, iv_in, sizeof(iv));
 
-    /*  AES context is no longer needed */
-    mbedtls_aes_free(&aes);
+    /*  Head blocks: ciphertext -> plaintext, no temporary buffer */
+    if (head_len > 0) {
+        ret = aes_key_cbc(aes, AES_CBC_DECRYPT, head_len,
+                          iv, ciphertext, plaintext);
+        if (ret != 0) {
+            goto cleanup;
+        }
+    }
 
-    /*  If decryption failed, free tmp and return error */
+    /*  Last block goes to the stack so the padding never touches the caller buffer */
+    ret = aes_key_cbc(aes, AES_CBC_DECRYPT, sizeof(last),
+                      iv, ciphertext + head_len, last);
     if (ret != 0) {
-        free(tmp);
-        return ret;
+        goto cleanup;
     }
 
-    /*  Remove PKCS#7 padding.
-     *     This allocates a new buffer 'out' that contains ONLY the real plaintext.
-     */
-    uint8_t *out = NULL;
-    size_t out_len = 0;
+    /*  Validate the padding in place; tail_len = data bytes in the last block */
+    if (pkcs7_unpad_16_inplace(last, sizeof(last), &tail_len) != 0) {
+        ret = -4;
+        goto cleanup;
+    }
 
-    ret = pkcs7_unpad_16(tmp, ciphertext_len, &out, &out_len);
+    if (plaintext_size - head_len < tail_len) {
+        ret = -3;
+        goto cleanup;
+    }
 
-    /*  tmp is no longer needed (we either have out, or we failed) */
-    free(tmp);
+    memcpy(plaintext + head_len, last, tail_len);
+    *plaintext_len = head_len + tail_len;
 
-    /*  If unpadding failed, return error (caller gets no plaintext buffer) */
+cleanup:
+    mbedtls_platform_zeroize(last, sizeof(last));   // holds plaintext bytes
     if (ret != 0) {
-        return ret;
+        mbedtls_platform_zeroize(plaintext, head_len); // never hand out unverified plaintext
     }
+    return ret;
+}
 
-    /*  Return final plaintext buffer and length to the caller */
-    *plaintext = out;
-    *plaintext_len = out_len;
+/**
+ * @brief Encrypt with AES-CBC + PKCS#7 into a caller provided buffer (no malloc).
+ *
+ * All full 16-byte blocks are encrypted straight from plaintext into
+ * ciphertext. Only the last partial block is padded, in a 16-byte block on
+ * the stack, so the plaintext is read exactly once and nothing is copied.
+ *
+ * IMPORTANT NOTES:
+ *  - keybits must be 128, 192, or 256 (AES key size in bits)
+ *  - iv_in must be exactly 16 bytes and is NOT modified
+ *  - ciphertext_size must be at least AES_CBC_PKCS7_CIPHERTEXT_LEN(plaintext_len)
+ *  - In-place encryption (ciphertext == plaintext) is allowed if the buffer
+ *    is big enough for the padded result
+ *  - The key schedule is expanded on every call; use aes_cbc_key_create()
+ *    when the same key encrypts many messages
+ *
+ * @param[in]  key              AES key bytes (length must match keybits/8)
+ * @param[in]  keybits          AES key size in bits: 128 / 192 / 256
+ * @param[in]  iv_in            16-byte Initialization Vector (IV)
+ * @param[in]  plaintext        Input plaintext bytes
+ * @param[in]  plaintext_len    Length of plaintext in bytes
+ * @param[out] ciphertext       Caller buffer that receives the ciphertext
+ * @param[in]  ciphertext_size  Size of the ciphertext buffer in bytes
+ * @param[out] ciphertext_len   Output length (ciphertext bytes written)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 ciphertext buffer too small
+ *         otherwise: mbedTLS error code from mbedtls_aes_* functions
+ */
+int aes_cbc_encrypt_pkcs7_into(const uint8_t *key, unsigned keybits,
+                               const uint8_t iv_in[16],
+                               const uint8_t *plaintext, size_t plaintext_len,
+                               uint8_t *ciphertext, size_t ciphertext_size,
+                               size_t *ciphertext_len)
+{
+    int ret = 0;
+    aes_cbc_key_t aes;                // Stack key (backend + encryption round keys)
 
-    return 0;                       // Success
+    if (key == NULL || iv_in == NULL || plaintext == NULL ||
+        ciphertext == NULL || ciphertext_len == NULL) {
+        return -1;
+    }
+
+    ret = aes_cbc_key_setup(&aes, key, keybits, AES_BACKEND_KEY_ENC);
+    if (ret == 0) {
+        ret = cbc_encrypt_pkcs7_with(&aes, iv_in, plaintext, plaintext_len,
+                                     ciphertext, ciphertext_size, ciphertext_len);
+    }
+
+    aes_cbc_key_clear(&aes);
+    return ret;
+}
+
+/**
+ * @brief Decrypt AES-CBC + PKCS#7 into a caller provided buffer (no malloc).
+ *
+ * All blocks except the last one are decrypted straight into plaintext.
+ * The last block is decrypted into a 16-byte stack block, its padding is
+ * validated in place and only the real data bytes are copied out.
+ *
+ * REQUIREMENTS:
+ *  - keybits must be 128, 192, or 256
+ *  - iv_in must be 16 bytes (AES block size) and is NOT modified
+ *  - ciphertext_len must be a non-zero multiple of 16 bytes
+ *  - plaintext_size must hold the unpadded plaintext; ciphertext_len - 1
+ *    is always enough
+ *  - In-place decryption (plaintext == ciphertext) is allowed
+ *
+ * @param[in]  key             AES key bytes (size must match keybits/8)
+ * @param[in]  keybits         AES key size in bits: 128/192/256
+ * @param[in]  iv_in           16-byte IV used during encryption (must be the same)
+ * @param[in]  ciphertext      Input ciphertext
+ * @param[in]  ciphertext_len  Length of ciphertext (must be multiple of 16)
+ * @param[out] plaintext       Caller buffer that receives the unpadded plaintext
+ * @param[in]  plaintext_size  Size of the plaintext buffer in bytes
+ * @param[out] plaintext_len   Output length (unpadded plaintext length)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 invalid ciphertext length
+ *         -3 plaintext buffer too small
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_decrypt_pkcs7_into(const uint8_t *key, unsigned keybits,
+                               const uint8_t iv_in[16],
+                               const uint8_t *ciphertext, size_t ciphertext_len,
+                               uint8_t *plaintext, size_t plaintext_size,
+                               size_t *plaintext_len)
+{
+    int ret = 0;
+    aes_cbc_key_t aes;               // Stack key (backend + decryption round keys)
+
+    if (key == NULL || iv_in == NULL || ciphertext == NULL ||
+        plaintext == NULL || plaintext_len == NULL) {
+        return -1;
+    }
+
+    if (ciphertext_len == 0 || (ciphertext_len % 16) != 0) {
+        return -2;
+    }
+
+    ret = aes_cbc_key_setup(&aes, key, keybits, AES_BACKEND_KEY_DEC);
+    if (ret == 0) {
+        ret = cbc_decrypt_pkcs7_with(&aes, iv_in, ciphertext, ciphertext_len,
+                                     plaintext, plaintext_size, plaintext_len);
+    }
+
+    aes_cbc_key_clear(&aes);
+    return ret;
+}
+
+/**
+ * @brief Key setup into caller memory, bound to the active backend.
+ *
+ * Internal (aes_cbc_priv.h): the raw-key functions keep the key on the
+ * stack, aes_cbc_key_create() on the heap. Always pair with
+ * aes_cbc_key_clear(), also on failure.
+ *
+ * @param[out] k        Key storage
+ * @param[in]  key      AES key bytes (length must match keybits/8)
+ * @param[in]  keybits  AES key size in bits: 128 / 192 / 256
+ * @param[in]  which    AES_BACKEND_KEY_ENC and/or AES_BACKEND_KEY_DEC
+ *
+ * @return 0 on success, otherwise the backend (mbedTLS) error code
+ */
+int aes_cbc_key_setup(aes_cbc_key_t *k, const uint8_t *key, unsigned keybits, int which)
+{
+    k->backend = aes_backend_active();
+    k->keybits = keybits;
+    return k->backend->setkey(&k->rk, key, keybits, which);
+}
+
+/**
+ * @brief Wipe a key from aes_cbc_key_setup().
+ */
+void aes_cbc_key_clear(aes_cbc_key_t *k)
+{
+    k->backend->clear(&k->rk);
+    mbedtls_platform_zeroize(k, sizeof(*k));
+}
+
+/**
+ * @brief Create a keyed AES-CBC handle (opaque object, see aes_cbc.h).
+ *
+ * The encryption AND decryption key schedules are expanded once here, so
+ * encrypting/decrypting many small records no longer pays for the key
+ * expansion on every message. The handle is bound to the backend that is
+ * active at creation (see aes_backend.h).
+ *
+ * SHARING BETWEEN TASKS:
+ *  - After create() the handle is never modified: the encrypt/decrypt
+ *    functions take a const pointer and keep the IV and the last block on
+ *    their own stack. Several tasks may use the same handle concurrently.
+ *  - destroy() must only be called once no task uses the handle anymore.
+ *
+ * @param[in] key      AES key bytes (length must match keybits/8)
+ * @param[in] keybits  AES key size in bits: 128 / 192 / 256
+ *
+ * @return Pointer to the new handle, or NULL on invalid args / malloc failure /
+ *         invalid key size
+ */
+aes_cbc_key_t *aes_cbc_key_create(const uint8_t *key, unsigned keybits)
+{
+    if (key == NULL) {
+        return NULL;
+    }
+
+    aes_cbc_key_t *self = malloc(sizeof(*self));
+    if (!self) return NULL;
+
+    if (aes_cbc_key_setup(self, key, keybits, AES_BACKEND_KEY_ENC | AES_BACKEND_KEY_DEC) != 0) {
+        aes_cbc_key_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+/**
+ * @brief Destroy a keyed handle: wipes both key schedules and frees it.
+ *
+ * @param[in] self  Handle from aes_cbc_key_create() (NULL is ignored)
+ */
+void aes_cbc_key_destroy(aes_cbc_key_t *self)
+{
+    if (self == NULL) {
+        return;
+    }
+
+    aes_cbc_key_clear(self);
+    free(self);
+}
+
+/**
+ * @brief Same as aes_cbc_encrypt_pkcs7_into(), but with a pre-expanded key.
+ *
+ * @param[in]  self             Keyed handle from aes_cbc_key_create()
+ * @param[in]  iv_in            16-byte Initialization Vector (IV), NOT modified
+ * @param[in]  plaintext        Input plaintext bytes
+ * @param[in]  plaintext_len    Length of plaintext in bytes
+ * @param[out] ciphertext       Caller buffer that receives the ciphertext
+ * @param[in]  ciphertext_size  Size of the ciphertext buffer in bytes
+ * @param[out] ciphertext_len   Output length (ciphertext bytes written)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 ciphertext buffer too small
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_key_encrypt_pkcs7_into(const aes_cbc_key_t *self,
+                                   const uint8_t iv_in[16],
+                                   const uint8_t *plaintext, size_t plaintext_len,
+                                   uint8_t *ciphertext, size_t ciphertext_size,
+                                   size_t *ciphertext_len)
+{
+    if (self == NULL || iv_in == NULL || plaintext == NULL ||
+        ciphertext == NULL || ciphertext_len == NULL) {
+        return -1;
+    }
+
+    return cbc_encrypt_pkcs7_with(self, iv_in,
+                                  plaintext, plaintext_len,
+                                  ciphertext, ciphertext_size, ciphertext_len);
+}
+
+/**
+ * @brief Same as aes_cbc_decrypt_pkcs7_into(), but with a pre-expanded key.
+ *
+ * @param[in]  self            Keyed handle from aes_cbc_key_create()
+ * @param[in]  iv_in           16-byte IV used during encryption, NOT modified
+ * @param[in]  ciphertext      Input ciphertext
+ * @param[in]  ciphertext_len  Length of ciphertext (must be multiple of 16)
+ * @param[out] plaintext       Caller buffer that receives the unpadded plaintext
+ * @param[in]  plaintext_size  Size of the plaintext buffer in bytes
+ * @param[out] plaintext_len   Output length (unpadded plaintext length)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 invalid ciphertext length
+ *         -3 plaintext buffer too small
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_key_decrypt_pkcs7_into(const aes_cbc_key_t *self,
+                                   const uint8_t iv_in[16],
+                                   const uint8_t *ciphertext, size_t ciphertext_len,
+                                   uint8_t *plaintext, size_t plaintext_size,
+                                   size_t *plaintext_len)
+{
+    if (self == NULL || iv_in == NULL || ciphertext == NULL ||
+        plaintext == NULL || plaintext_len == NULL) {
+        return -1;
+    }
+
+    return cbc_decrypt_pkcs7_with(self, iv_in,
+                                  ciphertext, ciphertext_len,
+                                  plaintext, plaintext_size, plaintext_len);
 }
@@ -4,7 +4,12 @@
 #include <stddef.h>   // size_t
 #include <stdint.h>   // uint8_t
 
+// Direction selectors (same values as MBEDTLS_AES_ENCRYPT / MBEDTLS_AES_DECRYPT)
+#define AES_CBC_ENCRYPT 1
+#define AES_CBC_DECRYPT 0
 
+// Ciphertext size for a plaintext of 'len' bytes (PKCS#7 always adds 1..16 bytes)
+#define AES_CBC_PKCS7_CIPHERTEXT_LEN(len)   ((((len) / 16) + 1) * 16)
 
 int aes_cbc_encrypt_pkcs7(const uint8_t *key, unsigned keybits,
                           const uint8_t iv_in[16],
@@ -16,4 +21,47 @@ int aes_cbc_decrypt_pkcs7(const uint8_t *key, unsigned keybits,
                           const uint8_t *ciphertext, size_t ciphertext_len,
                           uint8_t **plaintext, size_t *plaintext_len);
 
+// Zero-allocation variants: output goes to a caller provided buffer
+int aes_cbc_encrypt_pkcs7_into(const uint8_t *key, unsigned keybits,
+                               const uint8_t iv_in[16],
+                               const uint8_t *plaintext, size_t plaintext_len,
+                               uint8_t *ciphertext, size_t ciphertext_size,
+                               size_t *ciphertext_len);
+
+int aes_cbc_decrypt_pkcs7_into(const uint8_t *key, unsigned keybits,
+                               const uint8_t iv_in[16],
+                               const uint8_t *ciphertext, size_t ciphertext_len,
+                               uint8_t *plaintext, size_t plaintext_size,
+                               size_t *plaintext_len);
+
+/* Keyed handle (opaque pattern): key schedules expanded once, reused per message.
+ * Read-only after create, so one handle can be shared between tasks.
+ */
+typedef struct aes_cbc_key aes_cbc_key_t;
+
+aes_cbc_key_t *aes_cbc_key_create(const uint8_t *key, unsigned keybits);
+void           aes_cbc_key_destroy(aes_cbc_key_t *self);
+
+int aes_cbc_key_encrypt_pkcs7_into(const aes_cbc_key_t *self,
+                                   const uint8_t iv_in[16],
+                                   const uint8_t *plaintext, size_t plaintext_len,
+                                   uint8_t *ciphertext, size_t ciphertext_size,
+                                   size_t *ciphertext_len);
+
+int aes_cbc_key_decrypt_pkcs7_into(const aes_cbc_key_t *self,
+                                   const uint8_t iv_in[16],
+                                   const uint8_t *ciphertext, size_t ciphertext_len,
+                                   uint8_t *plaintext, size_t plaintext_size,
+                                   size_t *plaintext_len);
+
+// Bulk decryption split across the crypto workers (see crypto_workers.h).
+// Below this many bytes it falls back to aes_cbc_key_decrypt_pkcs7_into().
+#define AES_CBC_PARALLEL_MIN_LEN  4096
+
+int aes_cbc_key_decrypt_pkcs7_parallel_into(const aes_cbc_key_t *key,
+                                            const uint8_t iv_in[16],
+                                            const uint8_t *ciphertext, size_t ciphertext_len,
+                                            uint8_t *plaintext, size_t plaintext_size,
+                                            size_t *plaintext_len);
+
 #endif // AES_CBC_H
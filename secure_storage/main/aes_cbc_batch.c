@@ -0,0 +1,268 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc_batch.h"
+#include "aes_cbc_mb.h"
+#include "aes_cbc_priv.h"           // aes_cbc_key_setup() for the raw-key entry points
+#include "pkcs_7.h"
+
+#define BATCH_LANES  AES_BACKEND_MB_LANES   // jobs handed to the multi-buffer engine at once
+
+/* Pending multi-buffer jobs and the record each one belongs to */
+typedef struct {
+    aes_cbc_mb_job_t job[BATCH_LANES];
+    size_t rec[BATCH_LANES];
+    size_t count;
+} batch_queue_t;
+
+/* Run the queued jobs; decrypt also checks and strips each record's padding */
+static int batch_flush(batch_queue_t *q, int mode, aes_cbc_batch_rec_t *recs, uint8_t *arena)
+{
+    int ret = aes_cbc_mb_crypt(mode, q->job, q->count);
+
+    for (size_t i = 0; i < q->count; i++) {
+        aes_cbc_batch_rec_t *r = &recs[q->rec[i]];
+        uint8_t *out = arena + r->out_off;
+
+        if (ret != 0) {
+            r->status = ret;
+            r->out_len = 0;
+            mbedtls_platform_zeroize(out, q->job[i].len);   // staged plaintext / partial output
+            continue;
+        }
+        if (mode == AES_CBC_DECRYPT) {
+            size_t len = 0;
+            if (pkcs7_unpad_16_inplace(out, q->job[i].len, &len) != 0) {
+                r->status = -4;
+                mbedtls_platform_zeroize(out, q->job[i].len);   // never hand out unverified plaintext
+                continue;
+            }
+            mbedtls_platform_zeroize(out + len, q->job[i].len - len); // padding bytes
+            r->out_len = len;
+        }
+    }
+
+    mbedtls_platform_zeroize(q, sizeof(*q));    // IVs / chaining values
+    return ret;
+}
+
+/* Both directions: validate + place every record, queue it, flush per BATCH_LANES */
+static int batch_run(const aes_cbc_key_t *key, int mode,
+                     aes_cbc_batch_rec_t *recs, size_t n,
+                     uint8_t *arena, size_t arena_size, size_t *arena_used)
+{
+    batch_queue_t q;
+    size_t used = 0;
+    size_t next;                     // first record not staged yet
+    int failed = 0;
+    int ret = 0;
+
+    q.count = 0;
+
+    for (next = 0; next < n && ret == 0; next++) {
+        size_t i = next;
+        aes_cbc_batch_rec_t *r = &recs[i];
+        size_t need;
+
+        r->out_off = 0;
+        r->out_len = 0;
+        r->status = 0;
+
+        if (r->iv == NULL || (r->in == NULL && r->in_len != 0)) {
+            r->status = -1;
+            continue;
+        }
+
+        if (mode == AES_CBC_ENCRYPT) {
+            need = AES_CBC_PKCS7_CIPHERTEXT_LEN(r->in_len);
+            if (arena_size - used < need) {
+                r->status = -2;
+                continue;
+            }
+            /*  Stage plaintext + padding in the arena, encrypt there in place */
+            size_t full = r->in_len - (r->in_len % 16);
+            if (full > 0) {
+                memcpy(arena + used, r->in, full);
+            }
+            pkcs7_pad_block_16(r->in + full, r->in_len - full, arena + used + full);
+            r->out_len = need;
+        } else {
+            need = r->in_len;
+            if (need == 0 || need % 16 != 0) {
+                r->status = -2;
+                continue;
+            }
+            if (arena_size - used < need) {
+                r->status = -3;
+                continue;
+            }
+        }
+
+        r->out_off = used;
+        used += need;
+
+        aes_cbc_mb_job_t *job = &q.job[q.count];
+        job->key = key;
+        memcpy(job->iv, r->iv, sizeof(job->iv));
+        job->in = (mode == AES_CBC_ENCRYPT) ? arena + r->out_off : r->in;
+        job->out = arena + r->out_off;
+        job->len = need;
+        q.rec[q.count++] = i;
+
+        if (q.count == BATCH_LANES) {
+            ret = batch_flush(&q, mode, recs, arena);
+        }
+    }
+
+    if (ret == 0 && q.count > 0) {
+        ret = batch_flush(&q, mode, recs, arena);
+    }
+
+    if (ret != 0) {
+        /*  Engine error: the failed lanes are marked and wiped by batch_flush(),
+         *  the records never staged get the same status. Earlier lanes stay valid.
+         */
+        for (; next < n; next++) {
+            recs[next].out_off = 0;
+            recs[next].out_len = 0;
+            recs[next].status = ret;
+        }
+        *arena_used = used;
+        return ret;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        failed |= (recs[i].status != 0);
+    }
+
+    *arena_used = used;
+    return failed ? -5 : 0;
+}
+
+static int batch_args_ok(const void *key, const aes_cbc_batch_rec_t *recs, size_t n,
+                         const uint8_t *arena, const size_t *arena_used)
+{
+    return key != NULL && (recs != NULL || n == 0) &&
+           (arena != NULL || n == 0) && arena_used != NULL;
+}
+
+/**
+ * @brief AES-CBC + PKCS#7 encrypt many records with one key setup.
+ *
+ * Replaces a loop of aes_cbc_encrypt_pkcs7() calls (argument checks, setkey,
+ * two mallocs and two frees per record) with: one setkey, zero mallocs,
+ * and the records encrypted AES_BACKEND_MB_LANES at a time in lockstep
+ * (aes_cbc_mb_crypt()). Each record is staged in the arena together with
+ * its padding block and encrypted there in place.
+ *
+ * IMPORTANT NOTES:
+ *  - Results are packed in record order: recs[i].out_off / out_len
+ *  - A record that fails (status != 0) takes no arena space, the others
+ *    are still processed
+ *  - Input buffers must not overlap the arena
+ *
+ * @param[in]     key         AES key bytes (length must match keybits/8)
+ * @param[in]     keybits     AES key size in bits: 128 / 192 / 256
+ * @param[in,out] recs        Record descriptors (iv, in, in_len set by the caller)
+ * @param[in]     n           Number of records
+ * @param[out]    arena       Output arena for all ciphertexts
+ * @param[in]     arena_size  Arena size in bytes
+ * @param[out]    arena_used  Bytes of the arena used
+ *
+ * @return 0 every record encrypted
+ *         -1 invalid args (recs untouched)
+ *         -5 at least one record failed, see recs[i].status:
+ *              -1 invalid record, -2 does not fit in the arena
+ *         otherwise: mbedTLS error code; the batch stops there, the records
+ *              of the failing lanes and every later one carry it as status
+ *              (earlier records keep their results)
+ */
+int aes_cbc_encrypt_batch(const uint8_t *key, unsigned keybits,
+                          aes_cbc_batch_rec_t *recs, size_t n,
+                          uint8_t *arena, size_t arena_size, size_t *arena_used)
+{
+    int ret;
+    aes_cbc_key_t k;
+
+    if (!batch_args_ok(key, recs, n, arena, arena_used)) {
+        return -1;
+    }
+
+    ret = aes_cbc_key_setup(&k, key, keybits, AES_BACKEND_KEY_ENC);
+    if (ret == 0) {
+        ret = batch_run(&k, AES_CBC_ENCRYPT, recs, n, arena, arena_size, arena_used);
+    }
+    aes_cbc_key_clear(&k);
+    return ret;
+}
+
+/**
+ * @brief AES-CBC + PKCS#7 decrypt many records with one key setup.
+ *
+ * Counterpart of aes_cbc_encrypt_batch(). Each record gets in_len bytes of
+ * the arena; after the padding check out_len is the plaintext length and the
+ * padding bytes behind it are wiped.
+ *
+ * @param[in]     key         AES key bytes (length must match keybits/8)
+ * @param[in]     keybits     AES key size in bits: 128 / 192 / 256
+ * @param[in,out] recs        Record descriptors (iv, in, in_len set by the caller)
+ * @param[in]     n           Number of records
+ * @param[out]    arena       Output arena for all plaintexts
+ * @param[in]     arena_size  Arena size in bytes
+ * @param[out]    arena_used  Bytes of the arena used
+ *
+ * @return 0 every record decrypted
+ *         -1 invalid args (recs untouched)
+ *         -5 at least one record failed, see recs[i].status:
+ *              -1 invalid record, -2 invalid ciphertext length,
+ *              -3 does not fit in the arena, -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code, records marked as for
+ *              aes_cbc_encrypt_batch()
+ */
+int aes_cbc_decrypt_batch(const uint8_t *key, unsigned keybits,
+                          aes_cbc_batch_rec_t *recs, size_t n,
+                          uint8_t *arena, size_t arena_size, size_t *arena_used)
+{
+    int ret;
+    aes_cbc_key_t k;
+
+    if (!batch_args_ok(key, recs, n, arena, arena_used)) {
+        return -1;
+    }
+
+    ret = aes_cbc_key_setup(&k, key, keybits, AES_BACKEND_KEY_DEC);
+    if (ret == 0) {
+        ret = batch_run(&k, AES_CBC_DECRYPT, recs, n, arena, arena_size, arena_used);
+    }
+    aes_cbc_key_clear(&k);
+    return ret;
+}
+
+/**
+ * @brief Same as aes_cbc_encrypt_batch(), but with a pre-expanded key.
+ */
+int aes_cbc_key_encrypt_batch(const aes_cbc_key_t *key,
+                              aes_cbc_batch_rec_t *recs, size_t n,
+                              uint8_t *arena, size_t arena_size, size_t *arena_used)
+{
+    if (!batch_args_ok(key, recs, n, arena, arena_used)) {
+        return -1;
+    }
+    return batch_run(key, AES_CBC_ENCRYPT, recs, n, arena, arena_size, arena_used);
+}
+
+/**
+ * @brief Same as aes_cbc_decrypt_batch(), but with a pre-expanded key.
+ */
+int aes_cbc_key_decrypt_batch(const aes_cbc_key_t *key,
+                              aes_cbc_batch_rec_t *recs, size_t n,
+                              uint8_t *arena, size_t arena_size, size_t *arena_used)
+{
+    if (!batch_args_ok(key, recs, n, arena, arena_used)) {
+        return -1;
+    }
+    return batch_run(key, AES_CBC_DECRYPT, recs, n, arena, arena_size, arena_used);
+}
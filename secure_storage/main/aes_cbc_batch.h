@@ -0,0 +1,37 @@
+#ifndef AES_CBC_BATCH_H
+#define AES_CBC_BATCH_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // aes_cbc_key_t, AES_CBC_PKCS7_CIPHERTEXT_LEN()
+
+/* One record of a batch: inputs set by the caller, outputs by the batch call */
+typedef struct {
+    const uint8_t *iv;               // 16-byte IV, not modified
+    const uint8_t *in;               // plaintext (encrypt) / ciphertext (decrypt)
+    size_t in_len;
+    size_t out_off;                  // out: start of the result inside the arena
+    size_t out_len;                  // out: result length
+    int status;                      // out: 0, or the same code the *_pkcs7_into() call would return
+} aes_cbc_batch_rec_t;
+
+// Records are packed back-to-back into one output arena. Arena size for an
+// encrypt batch: sum of AES_CBC_PKCS7_CIPHERTEXT_LEN(in_len); decrypt: sum of in_len.
+int aes_cbc_encrypt_batch(const uint8_t *key, unsigned keybits,
+                          aes_cbc_batch_rec_t *recs, size_t n,
+                          uint8_t *arena, size_t arena_size, size_t *arena_used);
+
+int aes_cbc_decrypt_batch(const uint8_t *key, unsigned keybits,
+                          aes_cbc_batch_rec_t *recs, size_t n,
+                          uint8_t *arena, size_t arena_size, size_t *arena_used);
+
+// Same with a pre-expanded key
+int aes_cbc_key_encrypt_batch(const aes_cbc_key_t *key,
+                              aes_cbc_batch_rec_t *recs, size_t n,
+                              uint8_t *arena, size_t arena_size, size_t *arena_used);
+
+int aes_cbc_key_decrypt_batch(const aes_cbc_key_t *key,
+                              aes_cbc_batch_rec_t *recs, size_t n,
+                              uint8_t *arena, size_t arena_size, size_t *arena_used);
+
+#endif // AES_CBC_BATCH_H
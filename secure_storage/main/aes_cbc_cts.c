@@ -0,0 +1,171 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc_cts.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+
+/**
+ * @brief AES-CBC-CS3 encryption (ciphertext stealing, no size expansion).
+ *
+ * Plain CBC over every block; the last (possibly partial) block P_n is
+ * zero-padded, and the last two ciphertext blocks are emitted swapped with
+ * the second-to-last truncated:   C_1 .. C_{n-2} || C_n || C_{n-1}[0..d)
+ * where d = len - 16 * (n - 1) is 1..16. CS3 always swaps, even when len is
+ * a multiple of 16; a single block (len == 16) is plain CBC.
+ *
+ * IMPORTANT NOTES:
+ *  - len must be >= 16: shorter records still need a padded mode
+ *  - The length is NOT hidden (same as any unpadded mode) and CTS gives no
+ *    integrity: authenticate the record (HMAC / AEAD) as with plain CBC
+ *  - plaintext == ciphertext (in-place) is allowed
+ *
+ * @param[in]  key         Handle from aes_cbc_key_create()
+ * @param[in]  iv_in       16-byte IV (not modified)
+ * @param[in]  plaintext   Input bytes
+ * @param[in]  len         Input length in bytes (>= AES_CBC_CS3_MIN_LEN)
+ * @param[out] ciphertext  Output buffer, exactly len bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 len < 16
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_cs3_encrypt_into(const aes_cbc_key_t *key, const uint8_t iv_in[16],
+                             const uint8_t *plaintext, size_t len, uint8_t *ciphertext)
+{
+    int ret = 0;
+    uint8_t iv[16];
+    uint8_t pen[16];                 // P_{n-1}, then C_{n-1}
+    uint8_t last[16];                // zero-padded P_n, then C_n
+
+    if (key == NULL || iv_in == NULL || plaintext == NULL || ciphertext == NULL) {
+        return -1;
+    }
+    if (len < AES_CBC_CS3_MIN_LEN) {
+        return -2;
+    }
+
+    memcpy(iv, iv_in, sizeof(iv));
+
+    if (len == 16) {
+        ret = aes_key_cbc(key, AES_CBC_ENCRYPT, 16, iv,
+                          plaintext, ciphertext);
+        goto cleanup;
+    }
+
+    size_t d = len % 16 ? len % 16 : 16;                 // bytes in the last block
+    size_t head = len - d - 16;                          // blocks before P_{n-1}
+
+    /*  Copy the last two plaintext blocks out first (in-place safe) */
+    memcpy(pen, plaintext + head, 16);
+    memset(last, 0, sizeof(last));
+    memcpy(last, plaintext + head + 16, d);
+
+    if (head > 0) {
+        ret = aes_key_cbc(key, AES_CBC_ENCRYPT, head, iv,
+                          plaintext, ciphertext);
+        if (ret != 0) {
+            goto cleanup;
+        }
+    }
+
+    ret = aes_key_cbc(key, AES_CBC_ENCRYPT, 16, iv, pen, pen);
+    if (ret != 0) {
+        goto cleanup;
+    }
+    ret = aes_key_cbc(key, AES_CBC_ENCRYPT, 16, iv, last, last);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    memcpy(ciphertext + head, last, 16);                 // C_n
+    memcpy(ciphertext + head + 16, pen, d);              // C_{n-1}, truncated
+
+cleanup:
+    mbedtls_platform_zeroize(pen, sizeof(pen));
+    mbedtls_platform_zeroize(last, sizeof(last));
+    return ret;
+}
+
+/**
+ * @brief AES-CBC-CS3 decryption (inverse of aes_cbc_cs3_encrypt_into()).
+ *
+ * Z = AES^-1(C_n) = C_{n-1} ^ (P_n || 0), so the stolen tail of C_{n-1} is
+ * Z[d..16), P_n = Z[0..d) ^ C_{n-1}[0..d) and P_{n-1} decrypts as usual.
+ *
+ * @param[in]  key         Handle from aes_cbc_key_create()
+ * @param[in]  iv_in       16-byte IV used for encryption
+ * @param[in]  ciphertext  Input bytes
+ * @param[in]  len         Input length in bytes (>= AES_CBC_CS3_MIN_LEN)
+ * @param[out] plaintext   Output buffer, exactly len bytes (may equal ciphertext)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 len < 16
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_cs3_decrypt_into(const aes_cbc_key_t *key, const uint8_t iv_in[16],
+                             const uint8_t *ciphertext, size_t len, uint8_t *plaintext)
+{
+    int ret = 0;
+    uint8_t iv[16];
+    uint8_t cn[16];                  // C_n
+    uint8_t pen[16];                 // C_{n-1} (rebuilt), then P_{n-1}
+    uint8_t z[16];                   // AES^-1(C_n), then P_n
+
+    if (key == NULL || iv_in == NULL || plaintext == NULL || ciphertext == NULL) {
+        return -1;
+    }
+    if (len < AES_CBC_CS3_MIN_LEN) {
+        return -2;
+    }
+
+    memcpy(iv, iv_in, sizeof(iv));
+
+    if (len == 16) {
+        ret = aes_key_cbc(key, AES_CBC_DECRYPT, 16, iv,
+                          ciphertext, plaintext);
+        goto cleanup;
+    }
+
+    size_t d = len % 16 ? len % 16 : 16;
+    size_t head = len - d - 16;
+
+    memcpy(cn, ciphertext + head, 16);
+    memcpy(pen, ciphertext + head + 16, d);
+
+    /*  Head first: afterwards iv == C_{n-2} (or the IV) */
+    if (head > 0) {
+        ret = aes_key_cbc(key, AES_CBC_DECRYPT, head, iv,
+                          ciphertext, plaintext);
+        if (ret != 0) {
+            goto cleanup;
+        }
+    }
+
+    ret = aes_key_ecb(key, AES_CBC_DECRYPT, cn, z);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    memcpy(pen + d, z + d, 16 - d);                      // restore stolen bytes of C_{n-1}
+    for (size_t i = 0; i < d; i++) {
+        z[i] ^= pen[i];                                  // z[0..d) = P_n
+    }
+
+    ret = aes_key_cbc(key, AES_CBC_DECRYPT, 16, iv, pen, pen);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    memcpy(plaintext + head, pen, 16);
+    memcpy(plaintext + head + 16, z, d);
+
+cleanup:
+    mbedtls_platform_zeroize(pen, sizeof(pen));
+    mbedtls_platform_zeroize(z, sizeof(z));
+    return ret;
+}
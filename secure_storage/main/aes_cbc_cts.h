@@ -0,0 +1,20 @@
+#ifndef AES_CBC_CTS_H
+#define AES_CBC_CTS_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // aes_cbc_key_t
+
+/* AES-CBC-CS3 (NIST SP 800-38A addendum, as used by Kerberos):
+ * ciphertext stealing, no padding. Ciphertext length == plaintext length,
+ * plaintext must be at least one block (16 bytes).
+ */
+#define AES_CBC_CS3_MIN_LEN  16
+
+int aes_cbc_cs3_encrypt_into(const aes_cbc_key_t *key, const uint8_t iv_in[16],
+                             const uint8_t *plaintext, size_t len, uint8_t *ciphertext);
+
+int aes_cbc_cs3_decrypt_into(const aes_cbc_key_t *key, const uint8_t iv_in[16],
+                             const uint8_t *ciphertext, size_t len, uint8_t *plaintext);
+
+#endif // AES_CBC_CTS_H
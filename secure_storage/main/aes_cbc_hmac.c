@@ -0,0 +1,276 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/md.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc_hmac.h"
+#include "aes_cbc_stream.h"
+
+#define ETM_CHUNK         256        // encrypt + MAC interleave size (stays in cache)
+#define ETM_MAC_KEY_MAX   64         // one SHA-256 block, longer keys get hashed anyway
+
+struct aes_cbc_hmac_key {
+    aes_cbc_key_t *aes;              // encryption key (CBC)
+    uint8_t mac_key[ETM_MAC_KEY_MAX];// authentication key (HMAC-SHA256)
+    size_t mac_key_len;
+};
+
+/* Start HMAC-SHA256 and absorb the AAD (the AAD length goes in at the end) */
+static int etm_mac_start(mbedtls_md_context_t *md, const aes_cbc_hmac_key_t *key,
+                         const uint8_t *aad, size_t aad_len)
+{
+    int ret;
+
+    mbedtls_md_init(md);
+    ret = mbedtls_md_setup(md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_starts(md, key->mac_key, key->mac_key_len);
+    }
+    if (ret == 0 && aad_len > 0) {
+        ret = mbedtls_md_hmac_update(md, aad, aad_len);
+    }
+    return ret;
+}
+
+/* Append the 64-bit big-endian AAD bit length (separates AAD from IV || C) */
+static int etm_mac_finish(mbedtls_md_context_t *md, size_t aad_len, uint8_t tag[AES_CBC_HMAC_TAG_LEN])
+{
+    uint8_t al[8];
+    uint64_t bits = (uint64_t)aad_len * 8;
+    int ret;
+
+    for (int i = 7; i >= 0; i--) {
+        al[i] = (uint8_t)bits;
+        bits >>= 8;
+    }
+
+    ret = mbedtls_md_hmac_update(md, al, sizeof(al));
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_finish(md, tag);
+    }
+    return ret;
+}
+
+/**
+ * @brief Create an encrypt-then-MAC key handle.
+ *
+ * IMPORTANT NOTES:
+ *  - enc_key and mac_key must be independent (e.g. two HKDF outputs with
+ *    different info strings), never the same bytes.
+ *
+ * @param[in] enc_key      AES key bytes (length must match keybits/8)
+ * @param[in] keybits      AES key size in bits: 128 / 192 / 256
+ * @param[in] mac_key      HMAC-SHA256 key (32 bytes recommended)
+ * @param[in] mac_key_len  MAC key length in bytes (1..64)
+ *
+ * @return Handle on success, NULL on invalid args / bad key size / no memory
+ */
+aes_cbc_hmac_key_t *aes_cbc_hmac_key_create(const uint8_t *enc_key, unsigned keybits,
+                                            const uint8_t *mac_key, size_t mac_key_len)
+{
+    aes_cbc_hmac_key_t *self;
+
+    if (enc_key == NULL || mac_key == NULL || mac_key_len == 0 ||
+        mac_key_len > ETM_MAC_KEY_MAX) {
+        return NULL;
+    }
+
+    self = calloc(1, sizeof(*self));
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->aes = aes_cbc_key_create(enc_key, keybits);
+    if (self->aes == NULL) {
+        free(self);
+        return NULL;
+    }
+
+    memcpy(self->mac_key, mac_key, mac_key_len);
+    self->mac_key_len = mac_key_len;
+    return self;
+}
+
+/**
+ * @brief Wipe and free a handle from aes_cbc_hmac_key_create(). NULL is accepted.
+ */
+void aes_cbc_hmac_key_destroy(aes_cbc_hmac_key_t *self)
+{
+    if (self == NULL) {
+        return;
+    }
+    aes_cbc_key_destroy(self->aes);
+    mbedtls_platform_zeroize(self, sizeof(*self));
+    free(self);
+}
+
+/**
+ * @brief Encrypt-then-MAC in one pass: AES-CBC + PKCS#7, HMAC-SHA256 tag.
+ *
+ * Every ETM_CHUNK slice of ciphertext is fed to the HMAC right after it
+ * is produced, while it is still in cache, instead of a second full pass
+ * over the output.
+ *
+ * Output layout: IV (16) || C (AES_CBC_PKCS7_CIPHERTEXT_LEN) || tag (32)
+ * MAC input:     aad || IV || C || bitlen(aad) as 64-bit big-endian
+ *
+ * IMPORTANT NOTES:
+ *  - out_size >= AES_CBC_HMAC_SEALED_LEN(plaintext_len)
+ *  - plaintext and out must not overlap
+ *  - The AAD is authenticated but not stored in out
+ *
+ * @param[in]  key            Handle from aes_cbc_hmac_key_create()
+ * @param[in]  iv             Fresh random 16-byte IV (copied into out)
+ * @param[in]  aad            Authenticated-only data (may be NULL if aad_len == 0)
+ * @param[in]  aad_len        AAD length in bytes
+ * @param[in]  plaintext      Input bytes
+ * @param[in]  plaintext_len  Input length in bytes
+ * @param[out] out            Sealed record
+ * @param[in]  out_size       Size of out in bytes
+ * @param[out] out_len        Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_hmac_encrypt_into(const aes_cbc_hmac_key_t *key, const uint8_t iv[16],
+                              const uint8_t *aad, size_t aad_len,
+                              const uint8_t *plaintext, size_t plaintext_len,
+                              uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int ret;
+    mbedtls_md_context_t md;
+    aes_cbc_stream_t cbc;
+    size_t total = AES_CBC_HMAC_SEALED_LEN(plaintext_len);
+    size_t o = 16;                   // write offset in out
+    size_t n = 0;
+
+    if (key == NULL || iv == NULL || (aad == NULL && aad_len != 0) ||
+        (plaintext == NULL && plaintext_len != 0) || out == NULL || out_len == NULL) {
+        return -1;
+    }
+    if (out_size < total) {
+        return -2;
+    }
+
+    memcpy(out, iv, 16);
+    aes_cbc_stream_init(&cbc, key->aes, AES_CBC_ENCRYPT, iv);
+
+    ret = etm_mac_start(&md, key, aad, aad_len);
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_update(&md, iv, 16);
+    }
+
+    /*  Encrypt a slice, MAC the ciphertext it produced, repeat */
+    while (ret == 0 && plaintext_len > 0) {
+        size_t chunk = (plaintext_len < ETM_CHUNK) ? plaintext_len : ETM_CHUNK;
+
+        ret = aes_cbc_stream_update(&cbc, plaintext, chunk, out + o, out_size - o, &n);
+        if (ret == 0 && n > 0) {
+            ret = mbedtls_md_hmac_update(&md, out + o, n);
+        }
+        plaintext += chunk;
+        plaintext_len -= chunk;
+        o += n;
+    }
+
+    if (ret == 0) {
+        ret = aes_cbc_stream_final(&cbc, out + o, out_size - o, &n);
+    }
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_update(&md, out + o, n);
+        o += n;
+    }
+    if (ret == 0) {
+        ret = etm_mac_finish(&md, aad_len, out + o);
+        o += AES_CBC_HMAC_TAG_LEN;
+    }
+
+    if (ret == 0) {
+        *out_len = o;
+    } else {
+        mbedtls_platform_zeroize(out, total);
+    }
+    aes_cbc_stream_free(&cbc);
+    mbedtls_md_free(&md);
+    return ret;
+}
+
+/**
+ * @brief Verify-then-decrypt a record from aes_cbc_hmac_encrypt_into().
+ *
+ * The HMAC over aad || IV || C is computed and compared (no early exit)
+ * BEFORE any AES work: a forged or corrupted record costs one HMAC pass
+ * and plaintext is never written. Padding is only checked on records that
+ * passed authentication, so there is no padding oracle.
+ *
+ * @param[in]  key             Handle from aes_cbc_hmac_key_create()
+ * @param[in]  aad             Same AAD as used for encryption
+ * @param[in]  aad_len         AAD length in bytes
+ * @param[in]  in              Sealed record: IV || C || tag
+ * @param[in]  in_len          Record length in bytes
+ * @param[out] plaintext       Output buffer (in_len - 48 bytes is always enough)
+ * @param[in]  plaintext_size  Size of the plaintext buffer in bytes
+ * @param[out] plaintext_len   Plaintext bytes written
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 invalid record length
+ *         -3 plaintext buffer too small
+ *         -4 invalid PKCS#7 padding (authentic record from a broken sender)
+ *         -5 authentication failed (nothing decrypted)
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_hmac_decrypt_into(const aes_cbc_hmac_key_t *key,
+                              const uint8_t *aad, size_t aad_len,
+                              const uint8_t *in, size_t in_len,
+                              uint8_t *plaintext, size_t plaintext_size,
+                              size_t *plaintext_len)
+{
+    int ret;
+    mbedtls_md_context_t md;
+    uint8_t expected[AES_CBC_HMAC_TAG_LEN];
+    uint8_t diff = 0;
+
+    if (key == NULL || (aad == NULL && aad_len != 0) || in == NULL ||
+        plaintext == NULL || plaintext_len == NULL) {
+        return -1;
+    }
+    if (in_len < 16 + 16 + AES_CBC_HMAC_TAG_LEN || (in_len - AES_CBC_HMAC_TAG_LEN) % 16 != 0) {
+        return -2;
+    }
+
+    size_t c_len = in_len - 16 - AES_CBC_HMAC_TAG_LEN;
+    const uint8_t *tag = in + 16 + c_len;
+
+    /*  Authenticate IV || C first */
+    ret = etm_mac_start(&md, key, aad, aad_len);
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_update(&md, in, 16 + c_len);
+    }
+    if (ret == 0) {
+        ret = etm_mac_finish(&md, aad_len, expected);
+    }
+    mbedtls_md_free(&md);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    for (size_t i = 0; i < AES_CBC_HMAC_TAG_LEN; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    if (diff != 0) {
+        ret = -5;
+        goto cleanup;
+    }
+
+    /*  Authentic: decrypt (same error codes as the plain CBC API) */
+    ret = aes_cbc_key_decrypt_pkcs7_into(key->aes, in, in + 16, c_len,
+                                         plaintext, plaintext_size, plaintext_len);
+
+cleanup:
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+    return ret;
+}
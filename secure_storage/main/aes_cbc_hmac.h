@@ -0,0 +1,36 @@
+#ifndef AES_CBC_HMAC_H
+#define AES_CBC_HMAC_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // AES_CBC_PKCS7_CIPHERTEXT_LEN
+
+#define AES_CBC_HMAC_TAG_LEN  32     // full HMAC-SHA256 output
+
+// Sealed record size for 'len' plaintext bytes: IV || C || tag
+#define AES_CBC_HMAC_SEALED_LEN(len) \
+    (16 + AES_CBC_PKCS7_CIPHERTEXT_LEN(len) + AES_CBC_HMAC_TAG_LEN)
+
+/* Encrypt-then-MAC handle (opaque): AES key schedule + independent MAC key.
+ * Read-only after create, can be shared between tasks.
+ */
+typedef struct aes_cbc_hmac_key aes_cbc_hmac_key_t;
+
+aes_cbc_hmac_key_t *aes_cbc_hmac_key_create(const uint8_t *enc_key, unsigned keybits,
+                                            const uint8_t *mac_key, size_t mac_key_len);
+void                aes_cbc_hmac_key_destroy(aes_cbc_hmac_key_t *self);
+
+// out = IV || AES-CBC-PKCS7(plaintext) || HMAC-SHA256(aad || IV || C || bitlen(aad))
+int aes_cbc_hmac_encrypt_into(const aes_cbc_hmac_key_t *key, const uint8_t iv[16],
+                              const uint8_t *aad, size_t aad_len,
+                              const uint8_t *plaintext, size_t plaintext_len,
+                              uint8_t *out, size_t out_size, size_t *out_len);
+
+// Checks the tag first; nothing is decrypted when it does not match
+int aes_cbc_hmac_decrypt_into(const aes_cbc_hmac_key_t *key,
+                              const uint8_t *aad, size_t aad_len,
+                              const uint8_t *in, size_t in_len,
+                              uint8_t *plaintext, size_t plaintext_size,
+                              size_t *plaintext_len);
+
+#endif // AES_CBC_HMAC_H
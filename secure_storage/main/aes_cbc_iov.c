@@ -0,0 +1,237 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc_iov.h"
+#include "aes_cbc_stream.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+#include "pkcs_7.h"
+
+/**
+ * @brief Encrypt a record made of several fragments (gather, AES-CBC + PKCS#7).
+ *
+ * The fragments (e.g. header struct + payload + trailer) are fed one after
+ * the other into the streaming CBC context, so the chaining runs across
+ * fragment boundaries and no concatenated / padded copy is ever built.
+ * Only the bytes of a block that straddles two fragments go through the
+ * 16-byte block buffer of the stream context.
+ *
+ * The ciphertext is identical to encrypting the concatenation in one shot.
+ *
+ * @param[in]  key              Keyed handle from aes_cbc_key_create()
+ * @param[in]  iv_in            16-byte IV, NOT modified
+ * @param[in]  segs             Array of {ptr,len} fragments (len 0 allowed)
+ * @param[in]  nsegs            Number of fragments
+ * @param[out] ciphertext       Caller buffer that receives the ciphertext
+ * @param[in]  ciphertext_size  Must be >= AES_CBC_PKCS7_CIPHERTEXT_LEN(sum of lens)
+ * @param[out] ciphertext_len   Output length (ciphertext bytes written)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 ciphertext buffer too small
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_key_encryptv_pkcs7_into(const aes_cbc_key_t *key,
+                                    const uint8_t iv_in[16],
+                                    const aes_cbc_seg_t *segs, size_t nsegs,
+                                    uint8_t *ciphertext, size_t ciphertext_size,
+                                    size_t *ciphertext_len)
+{
+    int ret = 0;
+    size_t total = 0;
+    size_t o = 0;
+    size_t n = 0;
+    aes_cbc_stream_t stream;
+
+    if (key == NULL || iv_in == NULL || (segs == NULL && nsegs != 0) ||
+        ciphertext == NULL || ciphertext_len == NULL) {
+        return -1;
+    }
+
+    /*  Check the output size up front so we never stop half way */
+    for (size_t i = 0; i < nsegs; i++) {
+        if (segs[i].ptr == NULL && segs[i].len != 0) {
+            return -1;
+        }
+        total += segs[i].len;
+    }
+    if (ciphertext_size < AES_CBC_PKCS7_CIPHERTEXT_LEN(total)) {
+        return -2;
+    }
+
+    aes_cbc_stream_init(&stream, key, AES_CBC_ENCRYPT, iv_in);
+
+    for (size_t i = 0; i < nsegs; i++) {
+        ret = aes_cbc_stream_update(&stream, segs[i].ptr, segs[i].len,
+                                    ciphertext + o, ciphertext_size - o, &n);
+        if (ret != 0) {
+            goto cleanup;
+        }
+        o += n;
+    }
+
+    ret = aes_cbc_stream_final(&stream, ciphertext + o, ciphertext_size - o, &n);
+    if (ret == 0) {
+        *ciphertext_len = o + n;
+    }
+
+cleanup:
+    aes_cbc_stream_free(&stream);    // wipes the straddling block
+    return ret;
+}
+
+/* Copy len bytes into the buffer list starting at (*b, *off), advancing the cursor.
+ * Returns the number of bytes that fitted.
+ */
+static size_t scatter_bytes(const aes_cbc_buf_t *bufs, size_t nbufs,
+                            size_t *b, size_t *off,
+                            const uint8_t *src, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len && *b < nbufs) {
+        size_t room = bufs[*b].len - *off;
+        if (room == 0) {
+            (*b)++;
+            *off = 0;
+            continue;
+        }
+        size_t n = (len - done < room) ? (len - done) : room;
+        memcpy(bufs[*b].ptr + *off, src + done, n);
+        *off += n;
+        done += n;
+    }
+
+    return done;
+}
+
+/**
+ * @brief Decrypt AES-CBC + PKCS#7 and scatter the plaintext into several buffers.
+ *
+ * The plaintext fills bufs[0], then bufs[1], ... (like readv()). Whole
+ * blocks are decrypted straight into the destination buffer whenever they
+ * fit; only a block that straddles two buffers, and the padded last block,
+ * go through a 16-byte stack block.
+ *
+ * REQUIREMENTS:
+ *  - ciphertext_len must be a non-zero multiple of 16 bytes
+ *  - The buffers together must hold the unpadded plaintext
+ *  - On any error every destination buffer is wiped
+ *
+ * @param[in]  key             Keyed handle from aes_cbc_key_create()
+ * @param[in]  iv_in           16-byte IV used during encryption, NOT modified
+ * @param[in]  ciphertext      Input ciphertext
+ * @param[in]  ciphertext_len  Length of ciphertext (must be multiple of 16)
+ * @param[in]  bufs            Array of {ptr,len} destination buffers
+ * @param[in]  nbufs           Number of destination buffers
+ * @param[out] plaintext_len   Total plaintext bytes written across bufs
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 invalid ciphertext length
+ *         -3 destination buffers too small
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_key_decryptv_pkcs7_into(const aes_cbc_key_t *key,
+                                    const uint8_t iv_in[16],
+                                    const uint8_t *ciphertext, size_t ciphertext_len,
+                                    const aes_cbc_buf_t *bufs, size_t nbufs,
+                                    size_t *plaintext_len)
+{
+    int ret = 0;
+    uint8_t iv[16];                 // Local IV copy (CBC updates IV in-place)
+    uint8_t block[16];              // straddling block / padded last block
+    size_t capacity = 0;
+    size_t tail_len = 0;
+    size_t b = 0;                   // current destination buffer
+    size_t off = 0;                 // offset inside bufs[b]
+    size_t i = 0;                   // offset inside ciphertext
+
+    if (key == NULL || iv_in == NULL || ciphertext == NULL ||
+        (bufs == NULL && nbufs != 0) || plaintext_len == NULL) {
+        return -1;
+    }
+
+    if (ciphertext_len == 0 || (ciphertext_len % 16) != 0) {
+        return -2;
+    }
+
+    for (size_t k = 0; k < nbufs; k++) {
+        if (bufs[k].ptr == NULL && bufs[k].len != 0) {
+            return -1;
+        }
+        capacity += bufs[k].len;
+    }
+
+    size_t head_len = ciphertext_len - 16;
+    if (capacity < head_len) {
+        return -3;
+    }
+
+    memcpy(iv, iv_in, sizeof(iv));
+
+    while (i < head_len) {
+        /*  Skip exhausted / empty buffers */
+        while (off == bufs[b].len) {
+            b++;
+            off = 0;
+        }
+
+        size_t room_blocks = (bufs[b].len - off) / 16;
+        if (room_blocks > 0) {
+            /*  As many whole blocks as fit, straight into the destination */
+            size_t n = room_blocks * 16;
+            if (n > head_len - i) {
+                n = head_len - i;
+            }
+            ret = aes_key_cbc(key, AES_CBC_DECRYPT,
+                              n, iv, ciphertext + i, bufs[b].ptr + off);
+            if (ret != 0) {
+                goto cleanup;
+            }
+            off += n;
+            i += n;
+        } else {
+            /*  Block straddles two (or more) buffers */
+            ret = aes_key_cbc(key, AES_CBC_DECRYPT,
+                              16, iv, ciphertext + i, block);
+            if (ret != 0) {
+                goto cleanup;
+            }
+            scatter_bytes(bufs, nbufs, &b, &off, block, 16);
+            i += 16;
+        }
+    }
+
+    /*  Last block: decrypt on the stack, check padding, scatter only the data */
+    ret = aes_key_cbc(key, AES_CBC_DECRYPT,
+                      16, iv, ciphertext + head_len, block);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    if (pkcs7_unpad_16_inplace(block, sizeof(block), &tail_len) != 0) {
+        ret = -4;
+        goto cleanup;
+    }
+
+    if (capacity - head_len < tail_len) {
+        ret = -3;
+        goto cleanup;
+    }
+
+    scatter_bytes(bufs, nbufs, &b, &off, block, tail_len);
+    *plaintext_len = head_len + tail_len;
+
+cleanup:
+    mbedtls_platform_zeroize(block, sizeof(block));
+    if (ret != 0) {
+        for (size_t k = 0; k < nbufs; k++) {
+            mbedtls_platform_zeroize(bufs[k].ptr, bufs[k].len);
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,33 @@
+#ifndef AES_CBC_IOV_H
+#define AES_CBC_IOV_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // aes_cbc_key_t
+
+// One input fragment (gather) / one output buffer (scatter)
+typedef struct {
+    const uint8_t *ptr;
+    size_t len;
+} aes_cbc_seg_t;
+
+typedef struct {
+    uint8_t *ptr;
+    size_t len;
+} aes_cbc_buf_t;
+
+// Encrypt the concatenation of segs[0..nsegs-1] without building it in RAM
+int aes_cbc_key_encryptv_pkcs7_into(const aes_cbc_key_t *key,
+                                    const uint8_t iv_in[16],
+                                    const aes_cbc_seg_t *segs, size_t nsegs,
+                                    uint8_t *ciphertext, size_t ciphertext_size,
+                                    size_t *ciphertext_len);
+
+// Decrypt and spread the plaintext over bufs[0..nbufs-1] in order
+int aes_cbc_key_decryptv_pkcs7_into(const aes_cbc_key_t *key,
+                                    const uint8_t iv_in[16],
+                                    const uint8_t *ciphertext, size_t ciphertext_len,
+                                    const aes_cbc_buf_t *bufs, size_t nbufs,
+                                    size_t *plaintext_len);
+
+#endif // AES_CBC_IOV_H
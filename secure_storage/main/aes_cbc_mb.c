@@ -0,0 +1,155 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "aes_cbc_mb.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key, aes_key_cbc()
+
+#define MB_LANES  AES_BACKEND_MB_LANES
+
+/* Jobs that can share a lockstep call: same backend and same round count */
+static int mb_same_group(const aes_cbc_mb_job_t *a, const aes_cbc_mb_job_t *b)
+{
+    return a->key->backend == b->key->backend && a->key->keybits == b->key->keybits;
+}
+
+/* Scheduler for one group (multi-buffer "manager"): keep up to MB_LANES jobs
+ * in flight, advance all of them by the shortest remaining length, retire
+ * the finished ones and refill their lanes from the pending jobs. Records of
+ * different lengths therefore never wait for each other's tail.
+ */
+static int mb_run_group(int mode, aes_cbc_mb_job_t *jobs, size_t n, size_t first)
+{
+    const aes_backend_t *be = jobs[first].key->backend;
+    const aes_backend_key_t *rk[MB_LANES];
+    uint8_t *iv[MB_LANES];
+    const uint8_t *in[MB_LANES];
+    uint8_t *out[MB_LANES];
+    size_t left[MB_LANES];
+    size_t lanes = 0;
+    size_t next = first;
+    int ret = 0;
+
+    if (be->cbc_multi == NULL) {
+        for (size_t j = first; j < n && ret == 0; j++) {
+            if (mb_same_group(&jobs[j], &jobs[first])) {
+                ret = aes_key_cbc(jobs[j].key, mode, jobs[j].len, jobs[j].iv, jobs[j].in, jobs[j].out);
+            }
+        }
+        return ret;
+    }
+
+    for (;;) {
+        /*  Refill free lanes */
+        for (; lanes < MB_LANES && next < n; next++) {
+            aes_cbc_mb_job_t *job = &jobs[next];
+            if (!mb_same_group(job, &jobs[first])) {
+                continue;
+            }
+            rk[lanes] = &job->key->rk;
+            iv[lanes] = job->iv;
+            in[lanes] = job->in;
+            out[lanes] = job->out;
+            left[lanes] = job->len;
+            lanes++;
+        }
+        if (lanes == 0) {
+            return 0;
+        }
+
+        size_t step = left[0];
+        for (size_t l = 1; l < lanes; l++) {
+            if (left[l] < step) {
+                step = left[l];
+            }
+        }
+
+        if (step > 0) {
+            ret = be->cbc_multi(rk, mode, lanes, step, iv, in, out);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+
+        for (size_t l = 0; l < lanes; l++) {
+            in[l] += step;
+            out[l] += step;
+            left[l] -= step;
+        }
+
+        /*  Retire finished lanes: the last lane moves into the free slot */
+        for (size_t l = 0; l < lanes; ) {
+            if (left[l] != 0) {
+                l++;
+                continue;
+            }
+            lanes--;
+            rk[l] = rk[lanes];
+            iv[l] = iv[lanes];
+            in[l] = in[lanes];
+            out[l] = out[lanes];
+            left[l] = left[lanes];
+        }
+    }
+}
+
+/**
+ * @brief Encrypt or decrypt a batch of independent CBC streams (multi-buffer).
+ *
+ * A single CBC encryption is strictly serial (each block needs the previous
+ * ciphertext), so one record can never fill the AES pipeline. Independent
+ * records can: the backend's cbc_multi() op runs up to AES_BACKEND_MB_LANES
+ * of them in lockstep, one block of each per step, and their latencies
+ * overlap. Decryption of short records (a few blocks) gains the same way.
+ *
+ * Output is identical to calling the backend on each job separately.
+ *
+ * IMPORTANT NOTES:
+ *  - Raw CBC: len must be a multiple of 16, padding is the caller's job
+ *  - Jobs with different backends / key sizes are allowed; each group is
+ *    scheduled on its own
+ *  - Backends without cbc_multi (ESP32 peripheral, mbedTLS, soft) process
+ *    the jobs one at a time: the ESP32 AES peripheral is a single serial unit
+ *  - Output buffers of different jobs must not overlap
+ *
+ * @param[in]     mode  AES_CBC_ENCRYPT or AES_CBC_DECRYPT
+ * @param[in,out] jobs  Job array, jobs[i].iv is updated to the chaining value
+ * @param[in]     n     Number of jobs (0 is accepted)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 a job length is not a multiple of 16 (nothing processed)
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_mb_crypt(int mode, aes_cbc_mb_job_t *jobs, size_t n)
+{
+    int ret = 0;
+
+    if ((jobs == NULL && n != 0) ||
+        (mode != AES_CBC_ENCRYPT && mode != AES_CBC_DECRYPT)) {
+        return -1;
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        if (jobs[j].key == NULL || ((jobs[j].in == NULL || jobs[j].out == NULL) && jobs[j].len != 0)) {
+            return -1;
+        }
+        if (jobs[j].len % 16 != 0) {
+            return -2;
+        }
+    }
+
+    /*  One scheduler run per (backend, key size) group, in order of first use */
+    for (size_t g = 0; g < n && ret == 0; g++) {
+        size_t k = 0;
+        while (k < g && !mb_same_group(&jobs[k], &jobs[g])) {
+            k++;
+        }
+        if (k == g) {
+            ret = mb_run_group(mode, jobs, n, g);
+        }
+    }
+
+    return ret;
+}
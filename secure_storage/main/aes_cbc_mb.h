@@ -0,0 +1,21 @@
+#ifndef AES_CBC_MB_H
+#define AES_CBC_MB_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // aes_cbc_key_t, AES_CBC_ENCRYPT / AES_CBC_DECRYPT
+
+/* One independent CBC stream of a multi-buffer batch (raw CBC, no padding) */
+typedef struct {
+    const aes_cbc_key_t *key;        // keyed handle (jobs may use different keys)
+    uint8_t iv[16];                  // in: IV, out: last ciphertext block
+    const uint8_t *in;
+    uint8_t *out;                    // may equal in
+    size_t len;                      // multiple of 16, may differ per job
+} aes_cbc_mb_job_t;
+
+// Runs up to AES_BACKEND_MB_LANES jobs in lockstep (see aes_backend.h),
+// falls back to one job at a time on backends without cbc_multi.
+int aes_cbc_mb_crypt(int mode, aes_cbc_mb_job_t *jobs, size_t n);
+
+#endif // AES_CBC_MB_H
@@ -0,0 +1,151 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+#include "crypto_workers.h"
+#include "pkcs_7.h"
+
+/* One slice of the ciphertext, decrypted by one worker */
+typedef struct {
+    const aes_cbc_key_t *key;
+    const uint8_t *iv;               // previous ciphertext block (or the IV)
+    const uint8_t *in;
+    uint8_t *out;
+    size_t len;                      // multiple of 16
+    int ret;
+} cbc_slice_t;
+
+static void cbc_decrypt_slice(void *arg)
+{
+    cbc_slice_t *s = (cbc_slice_t *)arg;
+    uint8_t iv[16];
+
+    memcpy(iv, s->iv, sizeof(iv));
+    s->ret = aes_key_cbc(s->key, AES_CBC_DECRYPT,
+                         s->len, iv, s->in, s->out);
+}
+
+/**
+ * @brief AES-CBC + PKCS#7 decryption split across the crypto workers.
+ *
+ * In CBC decryption P[i] = D(C[i]) ^ C[i-1]: every plaintext block depends
+ * only on two ciphertext blocks. The ciphertext (minus the last block) is
+ * cut into one slice per worker at block boundaries; each slice uses the
+ * ciphertext block before it as IV. Only the last block is decrypted on
+ * the caller and unpadded (in a stack block, as in aes_cbc_decrypt_pkcs7_into).
+ *
+ * IMPORTANT NOTES:
+ *  - crypto_workers_start() must have been called, otherwise (or when the
+ *    message is shorter than AES_CBC_PARALLEL_MIN_LEN) this falls back to
+ *    aes_cbc_key_decrypt_pkcs7_into()
+ *  - plaintext and ciphertext must NOT overlap (slices read the block
+ *    before them, which another worker would overwrite)
+ *  - On the ESP32 with CONFIG_MBEDTLS_HARDWARE_AES there is a single AES
+ *    peripheral shared by both cores, so the slices are serialized by the
+ *    driver lock; the speedup shows with software AES and on the linux target
+ *
+ * @param[in]  key             Keyed handle from aes_cbc_key_create()
+ * @param[in]  iv_in           16-byte IV used during encryption, NOT modified
+ * @param[in]  ciphertext      Input ciphertext
+ * @param[in]  ciphertext_len  Length of ciphertext (must be multiple of 16)
+ * @param[out] plaintext       Caller buffer that receives the unpadded plaintext
+ * @param[in]  plaintext_size  Size of the plaintext buffer in bytes
+ * @param[out] plaintext_len   Output length (unpadded plaintext length)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 invalid ciphertext length
+ *         -3 plaintext buffer too small
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_key_decrypt_pkcs7_parallel_into(const aes_cbc_key_t *key,
+                                            const uint8_t iv_in[16],
+                                            const uint8_t *ciphertext, size_t ciphertext_len,
+                                            uint8_t *plaintext, size_t plaintext_size,
+                                            size_t *plaintext_len)
+{
+    int ret = 0;
+    uint8_t iv[16];
+    uint8_t last[16];
+    size_t tail_len = 0;
+    cbc_slice_t slices[CRYPTO_WORKERS_MAX];
+    void *args[CRYPTO_WORKERS_MAX];
+
+    if (key == NULL || iv_in == NULL || ciphertext == NULL ||
+        plaintext == NULL || plaintext_len == NULL) {
+        return -1;
+    }
+
+    if (ciphertext_len == 0 || (ciphertext_len % 16) != 0) {
+        return -2;
+    }
+
+    size_t workers = crypto_workers_count();
+    size_t head_len = ciphertext_len - 16;
+
+    /*  Small messages: dispatch costs more than it saves */
+    if (workers < 2 || head_len < AES_CBC_PARALLEL_MIN_LEN) {
+        return aes_cbc_key_decrypt_pkcs7_into(key, iv_in, ciphertext, ciphertext_len,
+                                              plaintext, plaintext_size, plaintext_len);
+    }
+
+    if (plaintext_size < head_len) {
+        return -3;
+    }
+
+    /*  Slice the head blocks evenly, cutting at block boundaries */
+    size_t blocks = head_len / 16;
+    for (size_t i = 0; i < workers; i++) {
+        size_t first = blocks * i / workers;
+        size_t end   = blocks * (i + 1) / workers;
+
+        slices[i].key = key;
+        slices[i].iv  = (first == 0) ? iv_in : ciphertext + (first - 1) * 16;
+        slices[i].in  = ciphertext + first * 16;
+        slices[i].out = plaintext + first * 16;
+        slices[i].len = (end - first) * 16;
+        slices[i].ret = 0;
+        args[i] = &slices[i];
+    }
+
+    ret = crypto_workers_run(cbc_decrypt_slice, args, workers);
+    for (size_t i = 0; ret == 0 && i < workers; i++) {
+        ret = slices[i].ret;
+    }
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    /*  Last block: chained to the previous ciphertext block */
+    memcpy(iv, ciphertext + head_len - 16, sizeof(iv));
+    ret = aes_key_cbc(key, AES_CBC_DECRYPT, sizeof(last),
+                      iv, ciphertext + head_len, last);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    if (pkcs7_unpad_16_inplace(last, sizeof(last), &tail_len) != 0) {
+        ret = -4;
+        goto cleanup;
+    }
+
+    if (plaintext_size - head_len < tail_len) {
+        ret = -3;
+        goto cleanup;
+    }
+
+    memcpy(plaintext + head_len, last, tail_len);
+    *plaintext_len = head_len + tail_len;
+
+cleanup:
+    mbedtls_platform_zeroize(last, sizeof(last));
+    if (ret != 0) {
+        mbedtls_platform_zeroize(plaintext, head_len);
+    }
+    return ret;
+}
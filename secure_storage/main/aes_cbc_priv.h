@@ -0,0 +1,43 @@
+#ifndef AES_CBC_PRIV_H
+#define AES_CBC_PRIV_H
+
+// Internal to secure_storage: full definition of the keyed handle so the
+// other AES modes built on it can reach the backend and its round keys.
+// Application code must only use the opaque aes_cbc_key_t from aes_cbc.h.
+
+#include "aes_backend.h"
+#include "aes_cbc.h"
+
+struct aes_cbc_key {
+    const aes_backend_t *backend;    // bound at creation, see aes_backend_active()
+    aes_backend_key_t rk;            // backend round keys (enc + dec)
+    unsigned keybits;                // 128 / 192 / 256
+};
+
+/* Block-cipher calls of the AES modes, routed through the key's backend.
+ * mode is AES_CBC_ENCRYPT / AES_CBC_DECRYPT.
+ */
+static inline int aes_key_ecb(const aes_cbc_key_t *k, int mode,
+                              const uint8_t in[16], uint8_t out[16])
+{
+    return k->backend->ecb(&k->rk, mode, in, out);
+}
+
+static inline int aes_key_cbc(const aes_cbc_key_t *k, int mode, size_t len,
+                              uint8_t iv[16], const uint8_t *in, uint8_t *out)
+{
+    return k->backend->cbc(&k->rk, mode, len, iv, in, out);
+}
+
+static inline int aes_key_ctr(const aes_cbc_key_t *k, size_t len, size_t *nc_off,
+                              uint8_t counter[16], uint8_t stream_block[16],
+                              const uint8_t *in, uint8_t *out)
+{
+    return k->backend->ctr(&k->rk, len, nc_off, counter, stream_block, in, out);
+}
+
+// Key setup into caller memory (raw-key one-shot functions keep it on the stack)
+int  aes_cbc_key_setup(aes_cbc_key_t *k, const uint8_t *key, unsigned keybits, int which);
+void aes_cbc_key_clear(aes_cbc_key_t *k);
+
+#endif // AES_CBC_PRIV_H
@@ -0,0 +1,294 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc_stream.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+#include "pkcs_7.h"
+
+/**
+ * @brief Start an incremental AES-CBC + PKCS#7 operation.
+ *
+ * The context carries the CBC chaining value (IV) and at most one
+ * partial/held-back block between update() calls, so memory use is
+ * sizeof(aes_cbc_stream_t) no matter how large the payload is.
+ * PKCS#7 is only applied (encrypt) or checked (decrypt) in final().
+ *
+ * The output is byte-for-byte the same as aes_cbc_encrypt_pkcs7() /
+ * aes_cbc_decrypt_pkcs7() on the concatenated input, whatever the chunking.
+ *
+ * @param[out] ctx    Stream context (caller memory, e.g. on the stack)
+ * @param[in]  key    Keyed handle from aes_cbc_key_create(), must outlive ctx
+ * @param[in]  mode   AES_CBC_ENCRYPT or AES_CBC_DECRYPT
+ * @param[in]  iv_in  16-byte IV, copied into the context
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ */
+int aes_cbc_stream_init(aes_cbc_stream_t *ctx, const aes_cbc_key_t *key,
+                        int mode, const uint8_t iv_in[16])
+{
+    if (ctx == NULL || key == NULL || iv_in == NULL ||
+        (mode != AES_CBC_ENCRYPT && mode != AES_CBC_DECRYPT)) {
+        return -1;
+    }
+
+    ctx->key = key;
+    ctx->mode = mode;
+    memcpy(ctx->iv, iv_in, sizeof(ctx->iv));
+    ctx->buf_len = 0;
+
+    return 0;
+}
+
+/* Encrypt direction: emit every complete block, keep the partial tail */
+static int stream_update_enc(aes_cbc_stream_t *ctx,
+                             const uint8_t *in, size_t in_len,
+                             uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int ret = 0;
+    size_t total = ctx->buf_len + in_len;
+    size_t produce = total - (total % 16);
+    size_t o = 0;
+
+    if (out_size < produce) {
+        return -2;
+    }
+
+    /*  Complete the buffered partial block first (if the input allows it) */
+    if (ctx->buf_len > 0) {
+        size_t need = 16 - ctx->buf_len;
+        if (in_len < need) {
+            memcpy(ctx->buf + ctx->buf_len, in, in_len);
+            ctx->buf_len += in_len;
+            *out_len = 0;
+            return 0;
+        }
+
+        memcpy(ctx->buf + ctx->buf_len, in, need);
+        ret = aes_key_cbc(ctx->key, AES_CBC_ENCRYPT,
+                          16, ctx->iv, ctx->buf, out);
+        if (ret != 0) {
+            return ret;
+        }
+        in += need;
+        in_len -= need;
+        ctx->buf_len = 0;
+        o = 16;
+    }
+
+    /*  Bulk: all remaining full blocks straight from input to output */
+    size_t bulk = in_len - (in_len % 16);
+    if (bulk > 0) {
+        ret = aes_key_cbc(ctx->key, AES_CBC_ENCRYPT,
+                          bulk, ctx->iv, in, out + o);
+        if (ret != 0) {
+            return ret;
+        }
+        in += bulk;
+        in_len -= bulk;
+        o += bulk;
+    }
+
+    /*  Keep the tail (0..15 bytes) for the next call / final() */
+    memcpy(ctx->buf, in, in_len);
+    ctx->buf_len = in_len;
+
+    *out_len = o;
+    return 0;
+}
+
+/* Decrypt direction: the last complete block is always held back, because
+ * only final() knows it is the one that carries the padding.
+ */
+static int stream_update_dec(aes_cbc_stream_t *ctx,
+                             const uint8_t *in, size_t in_len,
+                             uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int ret = 0;
+    size_t total = ctx->buf_len + in_len;
+    size_t o = 0;
+
+    /*  Up to one block: nothing can be released yet */
+    if (total <= 16) {
+        memcpy(ctx->buf + ctx->buf_len, in, in_len);
+        ctx->buf_len = total;
+        *out_len = 0;
+        return 0;
+    }
+
+    size_t keep = (total % 16 == 0) ? 16 : (total % 16);  // 1..16 bytes stay buffered
+    size_t produce = total - keep;                        // multiple of 16, >= 16
+
+    if (out_size < produce) {
+        return -3;
+    }
+
+    if (ctx->buf_len > 0) {
+        size_t need = 16 - ctx->buf_len;                  // in_len > need because total > 16
+
+        memcpy(ctx->buf + ctx->buf_len, in, need);
+        ret = aes_key_cbc(ctx->key, AES_CBC_DECRYPT,
+                          16, ctx->iv, ctx->buf, out);
+        if (ret != 0) {
+            return ret;
+        }
+        in += need;
+        in_len -= need;
+        ctx->buf_len = 0;
+        o = 16;
+    }
+
+    size_t bulk = produce - o;
+    if (bulk > 0) {
+        ret = aes_key_cbc(ctx->key, AES_CBC_DECRYPT,
+                          bulk, ctx->iv, in, out + o);
+        if (ret != 0) {
+            return ret;
+        }
+        in += bulk;
+        in_len -= bulk;
+        o += bulk;
+    }
+
+    memcpy(ctx->buf, in, in_len);                         // in_len == keep here
+    ctx->buf_len = in_len;
+
+    *out_len = o;
+    return 0;
+}
+
+/**
+ * @brief Feed the next chunk of data (any size, including 0).
+ *
+ * Output is always a multiple of 16 bytes and may be empty. The data is
+ * never copied except for the bytes that straddle a block boundary.
+ *
+ * IMPORTANT NOTES:
+ *  - out_size >= AES_CBC_STREAM_UPDATE_MAX(in_len) is always enough
+ *  - in and out must not overlap
+ *  - On error nothing is consumed and the context is unchanged
+ *    (except for mbedTLS errors, after which the stream must be dropped)
+ *
+ * @param[in,out] ctx       Context from aes_cbc_stream_init()
+ * @param[in]     in        Input chunk
+ * @param[in]     in_len    Input chunk length in bytes
+ * @param[out]    out       Output buffer
+ * @param[in]     out_size  Output buffer size in bytes
+ * @param[out]    out_len   Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 / -3 output buffer too small (encrypt / decrypt)
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_stream_update(aes_cbc_stream_t *ctx,
+                          const uint8_t *in, size_t in_len,
+                          uint8_t *out, size_t out_size, size_t *out_len)
+{
+    if (ctx == NULL || ctx->key == NULL || (in == NULL && in_len != 0) ||
+        out == NULL || out_len == NULL) {
+        return -1;
+    }
+
+    if (in_len == 0) {
+        *out_len = 0;
+        return 0;
+    }
+
+    if (ctx->mode == AES_CBC_ENCRYPT) {
+        return stream_update_enc(ctx, in, in_len, out, out_size, out_len);
+    }
+    return stream_update_dec(ctx, in, in_len, out, out_size, out_len);
+}
+
+/**
+ * @brief Finish the stream: pad + encrypt the last block, or decrypt +
+ *        validate the padding of the held-back block.
+ *
+ * Encrypt always writes exactly 16 bytes. Decrypt writes 0..15 bytes.
+ * The context is wiped on success; call aes_cbc_stream_free() on error.
+ *
+ * @param[in,out] ctx       Context from aes_cbc_stream_init()
+ * @param[out]    out       Output buffer (16 bytes is always enough)
+ * @param[in]     out_size  Output buffer size in bytes
+ * @param[out]    out_len   Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small (encrypt) / ciphertext not a
+ *            non-zero multiple of 16 (decrypt)
+ *         -3 output buffer too small (decrypt)
+ *         -4 invalid PKCS#7 padding
+ *         otherwise: mbedTLS error code
+ */
+int aes_cbc_stream_final(aes_cbc_stream_t *ctx,
+                         uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int ret = 0;
+    uint8_t last[16];
+    size_t tail_len = 0;
+
+    if (ctx == NULL || ctx->key == NULL || out == NULL || out_len == NULL) {
+        return -1;
+    }
+
+    if (ctx->mode == AES_CBC_ENCRYPT) {
+        if (out_size < 16) {
+            return -2;
+        }
+        pkcs7_pad_block_16(ctx->buf, ctx->buf_len, last);
+        ret = aes_key_cbc(ctx->key, AES_CBC_ENCRYPT,
+                          16, ctx->iv, last, out);
+        if (ret == 0) {
+            *out_len = 16;
+        }
+        goto cleanup;
+    }
+
+    /*  Decrypt: the held-back block must be a full one */
+    if (ctx->buf_len != 16) {
+        return -2;
+    }
+
+    ret = aes_key_cbc(ctx->key, AES_CBC_DECRYPT,
+                      16, ctx->iv, ctx->buf, last);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    if (pkcs7_unpad_16_inplace(last, sizeof(last), &tail_len) != 0) {
+        ret = -4;
+        goto cleanup;
+    }
+
+    if (out_size < tail_len) {
+        ret = -3;
+        goto cleanup;
+    }
+
+    memcpy(out, last, tail_len);
+    *out_len = tail_len;
+
+cleanup:
+    mbedtls_platform_zeroize(last, sizeof(last));
+    if (ret == 0) {
+        aes_cbc_stream_free(ctx);
+    }
+    return ret;
+}
+
+/**
+ * @brief Wipe a stream context (IV and buffered plaintext/ciphertext).
+ *
+ * Safe to call more than once. The keyed handle is not touched.
+ */
+void aes_cbc_stream_free(aes_cbc_stream_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+    mbedtls_platform_zeroize(ctx, sizeof(*ctx));
+}
@@ -0,0 +1,35 @@
+#ifndef AES_CBC_STREAM_H
+#define AES_CBC_STREAM_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t
+#include "aes_cbc.h"  // aes_cbc_key_t, AES_CBC_ENCRYPT / AES_CBC_DECRYPT
+
+// Output needed by one aes_cbc_stream_update() call for 'len' input bytes
+#define AES_CBC_STREAM_UPDATE_MAX(len)  ((len) + 15)
+
+/* Incremental AES-CBC + PKCS#7 (init / update / final).
+ * Constant memory: the context holds the IV and at most one block.
+ * Lives in caller memory like the mbedTLS contexts; treat the fields as private.
+ */
+typedef struct {
+    const aes_cbc_key_t *key;        // keyed handle (not owned)
+    int mode;                        // AES_CBC_ENCRYPT / AES_CBC_DECRYPT
+    uint8_t iv[16];                  // CBC chaining value
+    uint8_t buf[16];                 // partial (enc) or held-back (dec) block
+    size_t buf_len;                  // bytes used in buf
+} aes_cbc_stream_t;
+
+int  aes_cbc_stream_init(aes_cbc_stream_t *ctx, const aes_cbc_key_t *key,
+                         int mode, const uint8_t iv_in[16]);
+
+int  aes_cbc_stream_update(aes_cbc_stream_t *ctx,
+                           const uint8_t *in, size_t in_len,
+                           uint8_t *out, size_t out_size, size_t *out_len);
+
+int  aes_cbc_stream_final(aes_cbc_stream_t *ctx,
+                          uint8_t *out, size_t out_size, size_t *out_len);
+
+void aes_cbc_stream_free(aes_cbc_stream_t *ctx);
+
+#endif // AES_CBC_STREAM_H
@@ -0,0 +1,236 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_ctr.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+#include "crypto_workers.h"
+
+/* counter = nonce + blocks (128-bit big-endian addition, wraps like mbedTLS) */
+static void ctr_add(uint8_t counter[16], const uint8_t nonce[16], uint64_t blocks)
+{
+    unsigned carry = 0;
+
+    for (int i = 15; i >= 0; i--) {
+        unsigned sum = nonce[i] + (unsigned)(blocks & 0xFF) + carry;
+        counter[i] = (uint8_t)sum;
+        carry = sum >> 8;
+        blocks >>= 8;
+    }
+}
+
+/**
+ * @brief Start an AES-CTR context at byte offset 0.
+ *
+ * IMPORTANT NOTES:
+ *  - A (key, nonce) pair must NEVER encrypt two different payloads:
+ *    the keystream would repeat and XOR of both plaintexts would leak.
+ *  - Recommended nonce layout: 12 random bytes + 4 zero bytes, which
+ *    leaves 2^32 blocks (64 GB) per blob before touching the random part.
+ *
+ * @param[out] ctx    CTR context (caller memory)
+ * @param[in]  key    Keyed handle from aes_cbc_key_create(), must outlive ctx
+ * @param[in]  nonce  16-byte initial counter block, copied
+ *
+ * @return 0 on success, -1 invalid args
+ */
+int aes_ctr_init(aes_ctr_t *ctx, const aes_cbc_key_t *key, const uint8_t nonce[16])
+{
+    if (ctx == NULL || key == NULL || nonce == NULL) {
+        return -1;
+    }
+
+    ctx->key = key;
+    memcpy(ctx->nonce, nonce, sizeof(ctx->nonce));
+    return aes_ctr_seek(ctx, 0);
+}
+
+/**
+ * @brief Jump to any byte offset in O(1).
+ *
+ * The counter block for the offset is computed directly
+ * (nonce + offset / 16); nothing before the offset is processed.
+ *
+ * @param[in,out] ctx     Context from aes_ctr_init()
+ * @param[in]     offset  Byte offset inside the encrypted blob
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int aes_ctr_seek(aes_ctr_t *ctx, uint64_t offset)
+{
+    int ret = 0;
+
+    if (ctx == NULL || ctx->key == NULL) {
+        return -1;
+    }
+
+    ctr_add(ctx->counter, ctx->nonce, offset / 16);
+    ctx->nc_off = (size_t)(offset % 16);
+    ctx->pos = offset;
+
+    /*  Mid-block offset: prepare the keystream of that block, the way
+     *  the CTR op leaves it (counter already incremented).
+     */
+    if (ctx->nc_off != 0) {
+        ret = aes_key_ecb(ctx->key, AES_CBC_ENCRYPT,
+                          ctx->counter, ctx->stream_block);
+        if (ret != 0) {
+            return ret;
+        }
+        for (int i = 15; i >= 0; i--) {
+            if (++ctx->counter[i] != 0) {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Encrypt or decrypt len bytes at the current position and advance it.
+ *
+ * in == out (in-place) is allowed.
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int aes_ctr_crypt(aes_ctr_t *ctx, const uint8_t *in, size_t len, uint8_t *out)
+{
+    if (ctx == NULL || ctx->key == NULL || ((in == NULL || out == NULL) && len != 0)) {
+        return -1;
+    }
+
+    if (len == 0) {
+        return 0;
+    }
+
+    int ret = aes_key_ctr(ctx->key, len, &ctx->nc_off,
+                          ctx->counter, ctx->stream_block, in, out);
+    if (ret == 0) {
+        ctx->pos += len;
+    }
+    return ret;
+}
+
+/**
+ * @brief Wipe a CTR context (keystream block and counters).
+ */
+void aes_ctr_free(aes_ctr_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+    mbedtls_platform_zeroize(ctx, sizeof(*ctx));
+}
+
+/**
+ * @brief Random access without keeping a context: process the len bytes
+ *        that start at byte 'offset' of the blob.
+ *
+ * Reading 64 bytes from the middle of a 200 KB blob costs 4-5 AES blocks,
+ * instead of decrypting everything before it as CBC requires.
+ *
+ * @param[in]  key     Keyed handle from aes_cbc_key_create()
+ * @param[in]  nonce   16-byte counter block of offset 0
+ * @param[in]  offset  Byte offset of in[0] inside the blob
+ * @param[in]  in      Input bytes (plaintext or ciphertext)
+ * @param[in]  len     Number of bytes
+ * @param[out] out     Output bytes (may be == in)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int aes_ctr_crypt_at(const aes_cbc_key_t *key, const uint8_t nonce[16],
+                     uint64_t offset, const uint8_t *in, size_t len, uint8_t *out)
+{
+    aes_ctr_t ctx;
+
+    int ret = aes_ctr_init(&ctx, key, nonce);
+    if (ret == 0) {
+        ret = aes_ctr_seek(&ctx, offset);
+    }
+    if (ret == 0) {
+        ret = aes_ctr_crypt(&ctx, in, len, out);
+    }
+
+    aes_ctr_free(&ctx);
+    return ret;
+}
+
+/* One slice of a parallel CTR job */
+typedef struct {
+    const aes_cbc_key_t *key;
+    const uint8_t *nonce;
+    uint64_t offset;
+    const uint8_t *in;
+    uint8_t *out;
+    size_t len;
+    int ret;
+} ctr_slice_t;
+
+static void ctr_crypt_slice(void *arg)
+{
+    ctr_slice_t *s = (ctr_slice_t *)arg;
+    s->ret = aes_ctr_crypt_at(s->key, s->nonce, s->offset, s->in, s->len, s->out);
+}
+
+/**
+ * @brief aes_ctr_crypt_at() split across the crypto workers.
+ *
+ * CTR blocks are independent, so encryption parallelizes as well as
+ * decryption. Slices are cut at 16-byte boundaries of the blob.
+ * Falls back to aes_ctr_crypt_at() when the workers are not running or
+ * len < AES_CTR_PARALLEL_MIN_LEN. Same ESP32 caveat as the parallel CBC
+ * decryption: one shared AES peripheral limits on-device scaling.
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int aes_ctr_crypt_parallel_at(const aes_cbc_key_t *key, const uint8_t nonce[16],
+                              uint64_t offset, const uint8_t *in, size_t len, uint8_t *out)
+{
+    ctr_slice_t slices[CRYPTO_WORKERS_MAX];
+    void *args[CRYPTO_WORKERS_MAX];
+    size_t workers = crypto_workers_count();
+
+    if (key == NULL || nonce == NULL || ((in == NULL || out == NULL) && len != 0)) {
+        return -1;
+    }
+
+    if (workers < 2 || len < AES_CTR_PARALLEL_MIN_LEN) {
+        return aes_ctr_crypt_at(key, nonce, offset, in, len, out);
+    }
+
+    /*  Slice boundaries fall on block boundaries of the blob (offset + start) */
+    size_t lead = (size_t)((16 - (offset % 16)) % 16);      // bytes up to the first boundary
+    size_t blocks = (len - lead) / 16;
+    size_t start = 0;
+
+    for (size_t i = 0; i < workers; i++) {
+        size_t end = (i + 1 == workers) ? len : lead + (blocks * (i + 1) / workers) * 16;
+
+        slices[i].key = key;
+        slices[i].nonce = nonce;
+        slices[i].offset = offset + start;
+        slices[i].in = in + start;
+        slices[i].out = out + start;
+        slices[i].len = end - start;
+        slices[i].ret = 0;
+        args[i] = &slices[i];
+        start = end;
+    }
+
+    int ret = crypto_workers_run(ctr_crypt_slice, args, workers);
+    for (size_t i = 0; ret == 0 && i < workers; i++) {
+        ret = slices[i].ret;
+    }
+    return ret;
+}
@@ -0,0 +1,37 @@
+#ifndef AES_CTR_H
+#define AES_CTR_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint64_t
+#include "aes_cbc.h"  // aes_cbc_key_t (CTR only uses its encryption schedule)
+
+// Below this many bytes aes_ctr_crypt_parallel_at() runs on the caller only
+#define AES_CTR_PARALLEL_MIN_LEN  4096
+
+/* AES-CTR with random access: ciphertext size == plaintext size, no padding.
+ * Encryption and decryption are the same operation.
+ * Lives in caller memory like the mbedTLS contexts; treat the fields as private.
+ */
+typedef struct {
+    const aes_cbc_key_t *key;        // keyed handle (not owned)
+    uint8_t nonce[16];               // counter block of byte offset 0
+    uint8_t counter[16];             // next counter block to encrypt
+    uint8_t stream_block[16];        // keystream of the current block
+    size_t nc_off;                   // used bytes of stream_block (0 = none left)
+    uint64_t pos;                    // current byte offset
+} aes_ctr_t;
+
+int  aes_ctr_init(aes_ctr_t *ctx, const aes_cbc_key_t *key, const uint8_t nonce[16]);
+int  aes_ctr_seek(aes_ctr_t *ctx, uint64_t offset);
+int  aes_ctr_crypt(aes_ctr_t *ctx, const uint8_t *in, size_t len, uint8_t *out);
+void aes_ctr_free(aes_ctr_t *ctx);
+
+// Stateless random access: process len bytes that start at byte 'offset'
+int  aes_ctr_crypt_at(const aes_cbc_key_t *key, const uint8_t nonce[16],
+                      uint64_t offset, const uint8_t *in, size_t len, uint8_t *out);
+
+// Same, split across the crypto workers (see crypto_workers.h)
+int  aes_ctr_crypt_parallel_at(const aes_cbc_key_t *key, const uint8_t nonce[16],
+                               uint64_t offset, const uint8_t *in, size_t len, uint8_t *out);
+
+#endif // AES_CTR_H
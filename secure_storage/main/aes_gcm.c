@@ -0,0 +1,628 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_gcm.h"
+#include "aes_cbc_priv.h"           // struct aes_cbc_key
+
+#define GCM_CHUNK  256               // CTR + GHASH interleave size (stays in cache)
+
+struct aes_gcm_key {
+    aes_cbc_key_t *aes;              // keyed AES handle (encryption schedule only used)
+    uint64_t HL[16];                 // GHASH 4-bit table, low halves of i * H
+    uint64_t HH[16];                 // GHASH 4-bit table, high halves of i * H
+};
+
+/* Reduction constants for the 4-bit table GHASH (Shoup's method) */
+static const uint64_t last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static uint64_t get_be64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void put_be64(uint8_t *p, uint64_t v)
+{
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+/* Precompute i * H for the 16 nibble values i (H = AES_K(0^128)) */
+static void ghash_gen_table(aes_gcm_key_t *self, const uint8_t h[16])
+{
+    uint64_t vh = get_be64(h);
+    uint64_t vl = get_be64(h + 8);
+
+    self->HL[8] = vl;
+    self->HH[8] = vh;
+    self->HL[0] = 0;
+    self->HH[0] = 0;
+
+    for (int i = 4; i > 0; i >>= 1) {
+        uint32_t t = (uint32_t)(vl & 1) * 0xe1000000U;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ ((uint64_t)t << 32);
+        self->HL[i] = vl;
+        self->HH[i] = vh;
+    }
+
+    for (int i = 2; i <= 8; i *= 2) {
+        vh = self->HH[i];
+        vl = self->HL[i];
+        for (int j = 1; j < i; j++) {
+            self->HH[i + j] = vh ^ self->HH[j];
+            self->HL[i + j] = vl ^ self->HL[j];
+        }
+    }
+}
+
+/* x = x * H in GF(2^128) */
+static void ghash_mult(const aes_gcm_key_t *key, uint8_t x[16])
+{
+    uint8_t lo = x[15] & 0xf;
+    uint64_t zh = key->HH[lo];
+    uint64_t zl = key->HL[lo];
+
+    for (int i = 15; i >= 0; i--) {
+        uint8_t hi = (x[i] >> 4) & 0xf;
+        uint8_t rem;
+
+        lo = x[i] & 0xf;
+        if (i != 15) {
+            rem = (uint8_t)(zl & 0xf);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (last4[rem] << 48);
+            zh ^= key->HH[lo];
+            zl ^= key->HL[lo];
+        }
+
+        rem = (uint8_t)(zl & 0xf);
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (last4[rem] << 48);
+        zh ^= key->HH[hi];
+        zl ^= key->HL[hi];
+    }
+
+    put_be64(x, zh);
+    put_be64(x + 8, zl);
+}
+
+/* Absorb bytes into GHASH, buffering a partial block between calls */
+static void ghash_absorb(aes_gcm_stream_t *ctx, const uint8_t *data, size_t len)
+{
+    if (ctx->ghash_len > 0) {
+        size_t need = 16 - ctx->ghash_len;
+        size_t n = (len < need) ? len : need;
+
+        memcpy(ctx->ghash_buf + ctx->ghash_len, data, n);
+        ctx->ghash_len += n;
+        data += n;
+        len -= n;
+        if (ctx->ghash_len < 16) {
+            return;
+        }
+        for (int i = 0; i < 16; i++) {
+            ctx->x[i] ^= ctx->ghash_buf[i];
+        }
+        ghash_mult(ctx->key, ctx->x);
+        ctx->ghash_len = 0;
+    }
+
+    while (len >= 16) {
+        for (int i = 0; i < 16; i++) {
+            ctx->x[i] ^= data[i];
+        }
+        ghash_mult(ctx->key, ctx->x);
+        data += 16;
+        len -= 16;
+    }
+
+    memcpy(ctx->ghash_buf, data, len);
+    ctx->ghash_len = len;
+}
+
+/* Zero-pad the pending partial block (end of AAD / end of data) */
+static void ghash_flush(aes_gcm_stream_t *ctx)
+{
+    if (ctx->ghash_len == 0) {
+        return;
+    }
+    for (size_t i = 0; i < ctx->ghash_len; i++) {
+        ctx->x[i] ^= ctx->ghash_buf[i];
+    }
+    ghash_mult(ctx->key, ctx->x);
+    ctx->ghash_len = 0;
+}
+
+/* GCM counter mode: only the low 32 bits of the counter block increment
+ * (inc32). The backend CTR op carries across all 128 bits, so every
+ * call is cut at the 2^32 wrap and the upper 96 bits restored from J0.
+ * With a 12-byte IV the counter starts at 2 and never wraps.
+ */
+static int gcm_ctr(aes_gcm_stream_t *ctx, const uint8_t *in, size_t len, uint8_t *out)
+{
+    while (len > 0) {
+        uint32_t c32 = ((uint32_t)ctx->counter[12] << 24) | ((uint32_t)ctx->counter[13] << 16) |
+                       ((uint32_t)ctx->counter[14] << 8) | ctx->counter[15];
+        uint64_t limit = ((uint64_t)1 << 32) - c32;     // counter values left before wrap
+        limit *= 16;
+        if (ctx->nc_off != 0) {
+            limit += 16 - ctx->nc_off;                  // rest of the current keystream block
+        }
+
+        size_t n = (len < limit) ? len : (size_t)limit;
+        int ret = aes_key_ctr(ctx->key->aes, n, &ctx->nc_off,
+                              ctx->counter, ctx->stream_block, in, out);
+        if (ret != 0) {
+            return ret;
+        }
+        memcpy(ctx->counter, ctx->j0, 12);
+        in += n;
+        out += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Close AAD phase: pad the AAD so the data starts on a GHASH block */
+static void gcm_enter_data(aes_gcm_stream_t *ctx)
+{
+    if (ctx->phase == 0) {
+        ghash_flush(ctx);
+        ctx->phase = 1;
+    }
+}
+
+/* tag = E_K(J0) ^ GHASH(A || C || len(A) || len(C)) */
+static int gcm_compute_tag(aes_gcm_stream_t *ctx, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    uint8_t lens[16];
+    int ret;
+
+    gcm_enter_data(ctx);
+    ghash_flush(ctx);
+
+    put_be64(lens, ctx->aad_len * 8);
+    put_be64(lens + 8, ctx->data_len * 8);
+    ghash_absorb(ctx, lens, sizeof(lens));
+
+    ret = aes_key_ecb(ctx->key->aes, AES_CBC_ENCRYPT, ctx->j0, tag);
+    if (ret != 0) {
+        return ret;
+    }
+    for (int i = 0; i < AES_GCM_TAG_LEN; i++) {
+        tag[i] ^= ctx->x[i];
+    }
+    ctx->phase = 2;
+    return 0;
+}
+
+/* Tag comparison without an early exit */
+static int gcm_tag_equal(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+    for (int i = 0; i < AES_GCM_TAG_LEN; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+/**
+ * @brief Create a reusable AES-GCM key handle.
+ *
+ * Expands the AES key schedule and the GHASH multiplication table
+ * (H = AES_K(0^128)) once, so every message after that only pays for
+ * the CTR keystream and the table lookups.
+ *
+ * IMPORTANT NOTES:
+ *  - The handle is read-only after creation: several tasks may use it at
+ *    the same time as long as each one owns its aes_gcm_stream_t.
+ *  - A (key, IV) pair must NEVER be reused: it leaks the XOR of the
+ *    plaintexts AND lets an attacker forge tags.
+ *
+ * MEMORY:
+ *  - One heap block (~300 bytes) + the aes_cbc_key_t it wraps.
+ *
+ * @param[in] key      AES key bytes (length must match keybits/8)
+ * @param[in] keybits  AES key size in bits: 128 / 192 / 256
+ *
+ * @return Handle on success, NULL on invalid args / bad key size / no memory
+ */
+aes_gcm_key_t *aes_gcm_key_create(const uint8_t *key, unsigned keybits)
+{
+    uint8_t h[16] = {0};
+    aes_gcm_key_t *self;
+
+    if (key == NULL) {
+        return NULL;
+    }
+
+    self = calloc(1, sizeof(*self));
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->aes = aes_cbc_key_create(key, keybits);
+    if (self->aes == NULL ||
+        aes_key_ecb(self->aes, AES_CBC_ENCRYPT, h, h) != 0) {
+        aes_gcm_key_destroy(self);
+        return NULL;
+    }
+
+    ghash_gen_table(self, h);
+    mbedtls_platform_zeroize(h, sizeof(h));
+    return self;
+}
+
+/**
+ * @brief Wipe and free a handle from aes_gcm_key_create(). NULL is accepted.
+ */
+void aes_gcm_key_destroy(aes_gcm_key_t *self)
+{
+    if (self == NULL) {
+        return;
+    }
+    aes_cbc_key_destroy(self->aes);
+    mbedtls_platform_zeroize(self, sizeof(*self));
+    free(self);
+}
+
+/**
+ * @brief Start an AES-GCM message.
+ *
+ * A 12-byte IV is used directly (J0 = IV || 0x00000001); any other
+ * length is hashed into J0 as the GCM spec requires.
+ *
+ * @param[out] ctx     Stream context (caller memory, e.g. on the stack)
+ * @param[in]  key     Handle from aes_gcm_key_create(), must outlive ctx
+ * @param[in]  mode    AES_GCM_ENCRYPT or AES_GCM_DECRYPT
+ * @param[in]  iv      Nonce (AES_GCM_IV_LEN bytes recommended), copied
+ * @param[in]  iv_len  Nonce length in bytes (>= 1)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ */
+int aes_gcm_stream_start(aes_gcm_stream_t *ctx, const aes_gcm_key_t *key, int mode,
+                         const uint8_t *iv, size_t iv_len)
+{
+    if (ctx == NULL || key == NULL || iv == NULL || iv_len == 0 ||
+        (mode != AES_GCM_ENCRYPT && mode != AES_GCM_DECRYPT)) {
+        return -1;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->key = key;
+    ctx->mode = mode;
+
+    if (iv_len == AES_GCM_IV_LEN) {
+        memcpy(ctx->j0, iv, AES_GCM_IV_LEN);
+        ctx->j0[15] = 1;
+    } else {
+        uint8_t lens[16] = {0};
+
+        ghash_absorb(ctx, iv, iv_len);
+        ghash_flush(ctx);
+        put_be64(lens + 8, (uint64_t)iv_len * 8);
+        ghash_absorb(ctx, lens, sizeof(lens));
+        memcpy(ctx->j0, ctx->x, 16);
+        memset(ctx->x, 0, sizeof(ctx->x));
+    }
+
+    /*  Data starts at inc32(J0) */
+    memcpy(ctx->counter, ctx->j0, 16);
+    for (int i = 15; i >= 12; i--) {
+        if (++ctx->counter[i] != 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Feed additional authenticated data (authenticated, not encrypted).
+ *
+ * May be called any number of times, but only before the first update().
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 called after data was processed
+ */
+int aes_gcm_stream_aad(aes_gcm_stream_t *ctx, const uint8_t *aad, size_t aad_len)
+{
+    if (ctx == NULL || ctx->key == NULL || (aad == NULL && aad_len != 0)) {
+        return -1;
+    }
+    if (ctx->phase != 0) {
+        return -2;
+    }
+
+    ghash_absorb(ctx, aad, aad_len);
+    ctx->aad_len += aad_len;
+    return 0;
+}
+
+/**
+ * @brief Encrypt or decrypt the next chunk (any size, output == input size).
+ *
+ * Single pass: each GCM_CHUNK slice is run through CTR and GHASH while it is
+ * still in cache (GHASH covers the ciphertext: after CTR on encrypt, before
+ * CTR on decrypt). in == out (in-place) is allowed.
+ *
+ * IMPORTANT NOTES:
+ *  - Streaming DECRYPT releases plaintext before the tag is checked in
+ *    aes_gcm_stream_verify(): discard everything if verify fails. Use
+ *    aes_gcm_decrypt_into() when the whole record is in memory.
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 called after finish/verify
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_stream_update(aes_gcm_stream_t *ctx, const uint8_t *in, size_t len, uint8_t *out)
+{
+    int ret;
+
+    if (ctx == NULL || ctx->key == NULL || ((in == NULL || out == NULL) && len != 0)) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    gcm_enter_data(ctx);
+
+    while (len > 0) {
+        size_t n = (len < GCM_CHUNK) ? len : GCM_CHUNK;
+
+        if (ctx->mode == AES_GCM_DECRYPT) {
+            ghash_absorb(ctx, in, n);
+        }
+        ret = gcm_ctr(ctx, in, n, out);
+        if (ret != 0) {
+            return ret;
+        }
+        if (ctx->mode == AES_GCM_ENCRYPT) {
+            ghash_absorb(ctx, out, n);
+        }
+
+        ctx->data_len += n;
+        in += n;
+        out += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Finish an ENCRYPT stream and output the 16-byte tag.
+ *
+ * The context is wiped on success.
+ *
+ * @return 0 on success
+ *         -1 invalid args / not an encrypt stream
+ *         -2 already finished
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_stream_finish(aes_gcm_stream_t *ctx, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    int ret;
+
+    if (ctx == NULL || ctx->key == NULL || tag == NULL || ctx->mode != AES_GCM_ENCRYPT) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    ret = gcm_compute_tag(ctx, tag);
+    if (ret == 0) {
+        aes_gcm_stream_free(ctx);
+    }
+    return ret;
+}
+
+/**
+ * @brief Finish a DECRYPT stream and check the received tag.
+ *
+ * The comparison takes the same time wherever the tags differ.
+ * The context is wiped in every case except invalid args.
+ *
+ * @return 0 tag valid
+ *         -1 invalid args / not a decrypt stream
+ *         -2 already finished
+ *         -3 authentication failed (tampered data, AAD, IV or tag)
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_stream_verify(aes_gcm_stream_t *ctx, const uint8_t tag[AES_GCM_TAG_LEN])
+{
+    int ret;
+    uint8_t expected[AES_GCM_TAG_LEN];
+
+    if (ctx == NULL || ctx->key == NULL || tag == NULL || ctx->mode != AES_GCM_DECRYPT) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    ret = gcm_compute_tag(ctx, expected);
+    if (ret == 0 && !gcm_tag_equal(expected, tag)) {
+        ret = -3;
+    }
+
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+    aes_gcm_stream_free(ctx);
+    return ret;
+}
+
+/**
+ * @brief Finish a DECRYPT stream in one go: check the tag, then decrypt.
+ *
+ * For a whole record in memory, after start + aad* (no update() yet).
+ * Pass 1 runs GHASH over the ciphertext and compares the tag; only if it
+ * matches does pass 2 run CTR, so a forged record costs one GHASH pass and
+ * the plaintext buffer is never written. Splitting the AAD over several
+ * aes_gcm_stream_aad() calls lets a caller authenticate a header and its
+ * own AAD without joining them first.
+ *
+ * The context is wiped in every case except invalid args.
+ *
+ * @param[in,out] ctx         Decrypt stream, AAD already fed
+ * @param[in]     ciphertext  Input bytes
+ * @param[in]     len         Input length in bytes
+ * @param[in]     tag         Received 16-byte tag
+ * @param[out]    plaintext   Output buffer, len bytes (may equal ciphertext)
+ *
+ * @return 0 on success
+ *         -1 invalid args / not a decrypt stream
+ *         -2 data already processed (update() called) or already finished
+ *         -3 authentication failed (plaintext untouched)
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_stream_open(aes_gcm_stream_t *ctx, const uint8_t *ciphertext, size_t len,
+                        const uint8_t tag[AES_GCM_TAG_LEN], uint8_t *plaintext)
+{
+    int ret;
+    uint8_t expected[AES_GCM_TAG_LEN];
+
+    if (ctx == NULL || ctx->key == NULL || tag == NULL || ctx->mode != AES_GCM_DECRYPT ||
+        ((ciphertext == NULL || plaintext == NULL) && len != 0)) {
+        return -1;
+    }
+    if (ctx->phase != 0) {
+        return -2;
+    }
+
+    /*  Pass 1: authenticate only */
+    gcm_enter_data(ctx);
+    ghash_absorb(ctx, ciphertext, len);
+    ctx->data_len = len;
+
+    ret = gcm_compute_tag(ctx, expected);
+    if (ret == 0 && !gcm_tag_equal(expected, tag)) {
+        ret = -3;
+    }
+
+    /*  Pass 2: decrypt (counter still sits at inc32(J0)) */
+    if (ret == 0) {
+        ret = gcm_ctr(ctx, ciphertext, len, plaintext);
+    }
+
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+    aes_gcm_stream_free(ctx);
+    return ret;
+}
+
+/**
+ * @brief Wipe a stream context. Safe to call more than once.
+ */
+void aes_gcm_stream_free(aes_gcm_stream_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+    mbedtls_platform_zeroize(ctx, sizeof(*ctx));
+}
+
+/**
+ * @brief One-shot AES-GCM encryption with a detached tag.
+ *
+ * @param[in]  key         Handle from aes_gcm_key_create()
+ * @param[in]  iv          Unique nonce per message (AES_GCM_IV_LEN bytes recommended)
+ * @param[in]  iv_len      Nonce length in bytes
+ * @param[in]  aad         Authenticated-only data (may be NULL if aad_len == 0)
+ * @param[in]  aad_len     AAD length in bytes
+ * @param[in]  plaintext   Input bytes
+ * @param[in]  len         Input length in bytes (ciphertext has the same length)
+ * @param[out] ciphertext  Output buffer, len bytes (may equal plaintext)
+ * @param[out] tag         16-byte authentication tag
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_encrypt_into(const aes_gcm_key_t *key,
+                         const uint8_t *iv, size_t iv_len,
+                         const uint8_t *aad, size_t aad_len,
+                         const uint8_t *plaintext, size_t len,
+                         uint8_t *ciphertext, uint8_t tag[AES_GCM_TAG_LEN])
+{
+    int ret;
+    aes_gcm_stream_t ctx;
+
+    if (tag == NULL) {
+        return -1;
+    }
+
+    ret = aes_gcm_stream_start(&ctx, key, AES_GCM_ENCRYPT, iv, iv_len);
+    if (ret == 0) {
+        ret = aes_gcm_stream_aad(&ctx, aad, aad_len);
+    }
+    if (ret == 0) {
+        ret = aes_gcm_stream_update(&ctx, plaintext, len, ciphertext);
+    }
+    if (ret == 0) {
+        ret = aes_gcm_stream_finish(&ctx, tag);
+    }
+
+    aes_gcm_stream_free(&ctx);
+    return ret;
+}
+
+/**
+ * @brief One-shot AES-GCM decryption, tag checked before any plaintext.
+ *
+ * Pass 1 runs GHASH over AAD + ciphertext and compares the tag; only if it
+ * matches does pass 2 run CTR. A tampered record is rejected at GHASH cost
+ * and the plaintext buffer is never written.
+ *
+ * @param[in]  key         Handle from aes_gcm_key_create()
+ * @param[in]  iv          Nonce used for encryption
+ * @param[in]  iv_len      Nonce length in bytes
+ * @param[in]  aad         Authenticated-only data (may be NULL if aad_len == 0)
+ * @param[in]  aad_len     AAD length in bytes
+ * @param[in]  ciphertext  Input bytes
+ * @param[in]  len         Input length in bytes
+ * @param[in]  tag         Received 16-byte tag
+ * @param[out] plaintext   Output buffer, len bytes (may equal ciphertext)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -3 authentication failed (plaintext untouched)
+ *         otherwise: mbedTLS error code
+ */
+int aes_gcm_decrypt_into(const aes_gcm_key_t *key,
+                         const uint8_t *iv, size_t iv_len,
+                         const uint8_t *aad, size_t aad_len,
+                         const uint8_t *ciphertext, size_t len,
+                         const uint8_t tag[AES_GCM_TAG_LEN], uint8_t *plaintext)
+{
+    int ret;
+    aes_gcm_stream_t ctx;
+
+    ret = aes_gcm_stream_start(&ctx, key, AES_GCM_DECRYPT, iv, iv_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = aes_gcm_stream_aad(&ctx, aad, aad_len);
+    if (ret == 0) {
+        ret = aes_gcm_stream_open(&ctx, ciphertext, len, tag, plaintext);
+    }
+
+    aes_gcm_stream_free(&ctx);
+    return ret;
+}
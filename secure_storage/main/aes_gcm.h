@@ -0,0 +1,64 @@
+#ifndef AES_GCM_H
+#define AES_GCM_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint64_t
+
+#define AES_GCM_ENCRYPT  1
+#define AES_GCM_DECRYPT  0
+
+#define AES_GCM_IV_LEN   12          // recommended nonce size (any size >= 1 works)
+#define AES_GCM_TAG_LEN  16          // detached authentication tag
+
+/* Keyed GCM handle (opaque): AES key schedule + GHASH table, built once.
+ * Read-only after create, so one handle can be shared between tasks.
+ */
+typedef struct aes_gcm_key aes_gcm_key_t;
+
+aes_gcm_key_t *aes_gcm_key_create(const uint8_t *key, unsigned keybits);
+void           aes_gcm_key_destroy(aes_gcm_key_t *self);
+
+/* Streaming context (caller memory, treat the fields as private).
+ * Order: start -> aad* -> update* -> finish (encrypt) / verify (decrypt),
+ * or start -> aad* -> open (decrypt, tag checked before any plaintext)
+ */
+typedef struct {
+    const aes_gcm_key_t *key;        // keyed handle (not owned)
+    int mode;                        // AES_GCM_ENCRYPT / AES_GCM_DECRYPT
+    int phase;                       // 0 = AAD, 1 = data, 2 = finished
+    uint8_t j0[16];                  // pre-counter block (tag mask)
+    uint8_t counter[16];             // next CTR counter block
+    uint8_t stream_block[16];        // current keystream block
+    size_t nc_off;                   // used bytes of stream_block
+    uint8_t x[16];                   // GHASH accumulator
+    uint8_t ghash_buf[16];           // partial GHASH input block
+    size_t ghash_len;                // bytes in ghash_buf
+    uint64_t aad_len;                // total AAD bytes
+    uint64_t data_len;               // total plaintext/ciphertext bytes
+} aes_gcm_stream_t;
+
+int  aes_gcm_stream_start(aes_gcm_stream_t *ctx, const aes_gcm_key_t *key, int mode,
+                          const uint8_t *iv, size_t iv_len);
+int  aes_gcm_stream_aad(aes_gcm_stream_t *ctx, const uint8_t *aad, size_t aad_len);
+int  aes_gcm_stream_update(aes_gcm_stream_t *ctx, const uint8_t *in, size_t len, uint8_t *out);
+int  aes_gcm_stream_finish(aes_gcm_stream_t *ctx, uint8_t tag[AES_GCM_TAG_LEN]);
+int  aes_gcm_stream_verify(aes_gcm_stream_t *ctx, const uint8_t tag[AES_GCM_TAG_LEN]);
+int  aes_gcm_stream_open(aes_gcm_stream_t *ctx, const uint8_t *ciphertext, size_t len,
+                         const uint8_t tag[AES_GCM_TAG_LEN], uint8_t *plaintext);
+void aes_gcm_stream_free(aes_gcm_stream_t *ctx);
+
+/* One-shot: ciphertext size == plaintext size, tag is detached */
+int aes_gcm_encrypt_into(const aes_gcm_key_t *key,
+                         const uint8_t *iv, size_t iv_len,
+                         const uint8_t *aad, size_t aad_len,
+                         const uint8_t *plaintext, size_t len,
+                         uint8_t *ciphertext, uint8_t tag[AES_GCM_TAG_LEN]);
+
+// Verifies the tag BEFORE decrypting: a forged record costs one GHASH pass
+int aes_gcm_decrypt_into(const aes_gcm_key_t *key,
+                         const uint8_t *iv, size_t iv_len,
+                         const uint8_t *aad, size_t aad_len,
+                         const uint8_t *ciphertext, size_t len,
+                         const uint8_t tag[AES_GCM_TAG_LEN], uint8_t *plaintext);
+
+#endif // AES_GCM_H
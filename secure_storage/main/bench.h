@@ -0,0 +1,21 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Small on-device benchmarks for the secure_storage crypto helpers, one
+// bench_<feature>.c per feature (shared setup in bench_common.c).
+// Results are printed with ESP_LOGI (tag "BENCH").
+
+void bench_cbc_keyed(void);
+void bench_cbc_parallel(void);
+void bench_cbc_storage_report(void);   // PKCS#7 vs CBC-CS3 in the Sec_Store NVS partition
+void bench_aes_backends(void);         // throughput per cipher backend (soft / mbedtls / esp_aes / aesni / vaes)
+void bench_aead(void);                 // CBC-PKCS7 vs AES-GCM vs ChaCha20-Poly1305 records
+void bench_cbc_multibuffer(void);      // batch of independent records, 1x vs lockstep lanes
+void bench_cbc_batch(void);            // per-record *_pkcs7() calls vs *_batch() (records/s)
+void bench_crypto_service(void);       // caller blocked: sync call vs async submit, queue stats
+void bench_rng_iv(void);               // esp_fill_random() vs rng_service IV pool
+void bench_record_compression(void);   // LZSS + CBC records: bytes saved (air / Sec_Store), us per KB
+void bench_pkcs7_timing(void);         // PKCS#7 check: early-exit vs constant-time, t-test per class
+void bench_scratch_arena(void);        // heap fragmentation after 24 h simulated load, heap vs arena
+
+#endif // BENCH_H
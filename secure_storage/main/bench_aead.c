@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "aes_cbc.h"
+#include "aes_backend.h"
+#include "aead.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+static uint8_t s_sealed[AEAD_SEALED_LEN(BENCH_MAX_MSG)];
+
+/**
+ * @brief aes_cbc_encrypt_pkcs7() vs the two AEADs of aead_seal(), by record size.
+ *
+ * CBC here is the raw-key allocating API the records use today (no
+ * integrity). AES-GCM runs on the active AES backend, ChaCha20-Poly1305
+ * is plain software and does not depend on it: where AES has no hardware
+ * (or no AES-NI on the host), ChaCha20-Poly1305 is the faster AEAD.
+ */
+void bench_aead(void)
+{
+    static const size_t sizes[] = { 16, 32, 64, 128, 1024 };
+    static const uint8_t algs[] = { AEAD_ALG_AES_GCM, AEAD_ALG_CHACHA20_POLY1305 };
+    const unsigned iterations = 2000;
+    uint8_t nonce[AEAD_NONCE_LEN];
+    bench_fixture_t f;
+
+    if (bench_fixture_init(&f) != 0) {
+        bench_fixture_free(&f);
+        return;
+    }
+    esp_fill_random(nonce, sizeof(nonce));
+
+    aead_key_t *handle = aead_key_create(f.key);
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "aead_key_create failed");
+        bench_fixture_free(&f);
+        return;
+    }
+
+    ESP_LOGI(TAG, "CBC-PKCS7 vs AEAD records, backend %s (%u iterations, ops/s)",
+             aes_backend_active()->name, iterations);
+    ESP_LOGI(TAG, "%6s | %10s | %10s %10s | %11s %11s", "bytes", "CBC enc",
+             "GCM seal", "GCM open", "ChaCha seal", "ChaCha open");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        double rate[1 + 2 * 2];
+        int64_t t0;
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            uint8_t *ct = NULL;
+            size_t ct_len = 0;
+            if (aes_cbc_encrypt_pkcs7(f.key, 256, f.iv, bench_msg, len, &ct, &ct_len) == 0) {
+                free(ct);
+            }
+        }
+        rate[0] = bench_ops_per_s(esp_timer_get_time() - t0, iterations);
+
+        for (size_t a = 0; a < sizeof(algs) / sizeof(algs[0]); a++) {
+            size_t sealed_len = 0;
+            size_t pt_len = 0;
+
+            t0 = esp_timer_get_time();
+            for (unsigned i = 0; i < iterations; i++) {
+                aead_seal(handle, algs[a], nonce, NULL, 0, bench_msg, len,
+                          s_sealed, sizeof(s_sealed), &sealed_len);
+            }
+            rate[1 + 2 * a] = bench_ops_per_s(esp_timer_get_time() - t0, iterations);
+
+            t0 = esp_timer_get_time();
+            for (unsigned i = 0; i < iterations; i++) {
+                aead_open(handle, NULL, 0, s_sealed, sealed_len, bench_pt, sizeof(bench_pt), &pt_len);
+            }
+            rate[2 + 2 * a] = bench_ops_per_s(esp_timer_get_time() - t0, iterations);
+
+            if (pt_len != len || memcmp(bench_pt, bench_msg, len) != 0) {
+                ESP_LOGE(TAG, "%s round trip mismatch at %zu bytes", aead_alg_name(algs[a]), len);
+            }
+        }
+
+        ESP_LOGI(TAG, "%6zu | %10.0f | %10.0f %10.0f | %11.0f %11.0f", len,
+                 rate[0], rate[1], rate[2], rate[3], rate[4]);
+    }
+
+    aead_key_destroy(handle);
+    bench_fixture_free(&f);
+}
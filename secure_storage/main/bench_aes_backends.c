@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "aes_cbc.h"
+#include "aes_ctr.h"
+#include "aes_backend.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/**
+ * @brief AES throughput of every cipher backend usable on this machine.
+ *
+ * Each backend is selected in turn and a fresh key is bound to it. CBC
+ * encryption is serial by nature; CBC decryption and CTR can pipeline
+ * blocks, which is where AES-NI / VAES pull ahead. Outputs are cross-checked
+ * against the first backend. The original selection is restored afterwards.
+ */
+void bench_aes_backends(void)
+{
+    const size_t len = 16384;
+    const size_t total_bytes = 4 * 1024 * 1024;
+    const unsigned iterations = (unsigned)(total_bytes / len);
+    const aes_backend_t *saved = aes_backend_active();
+
+    uint8_t key[32];
+    uint8_t iv[16];
+    uint8_t nonce[16] = { 0 };
+    uint8_t ref_sum[16] = { 0 };     // CBC + CTR output prefix of the first backend
+    esp_fill_random(key, sizeof(key));
+    esp_fill_random(iv, sizeof(iv));
+    esp_fill_random(nonce, 12);
+
+    uint8_t *pt = malloc(len);
+    uint8_t *ct = malloc(AES_CBC_PKCS7_CIPHERTEXT_LEN(len));
+    uint8_t *out = malloc(len);
+    if (pt == NULL || ct == NULL || out == NULL) {
+        ESP_LOGE(TAG, "out of memory");
+        goto done;
+    }
+    esp_fill_random(pt, len);
+
+    ESP_LOGI(TAG, "AES-256 backends, %zu-byte buffers", len);
+    ESP_LOGI(TAG, "%-8s | %12s %12s %12s", "backend", "CBC enc", "CBC dec", "CTR");
+
+    for (size_t b = 0; b < aes_backend_count(); b++) {
+        const aes_backend_t *be = aes_backend_get(b);
+        size_t ct_len = 0, pt_len = 0;
+        uint8_t sum[16];
+        int64_t t0, enc, dec, ctr;
+
+        aes_backend_select(be->name);
+        aes_cbc_key_t *handle = aes_cbc_key_create(key, 256);
+        if (handle == NULL) {
+            ESP_LOGE(TAG, "%s: key setup failed", be->name);
+            continue;
+        }
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            aes_cbc_key_encrypt_pkcs7_into(handle, iv, pt, len, ct,
+                                           AES_CBC_PKCS7_CIPHERTEXT_LEN(len), &ct_len);
+        }
+        enc = esp_timer_get_time() - t0;
+        memcpy(sum, ct + ct_len - 8, 8);
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            aes_cbc_key_decrypt_pkcs7_into(handle, iv, ct, ct_len, out, len, &pt_len);
+        }
+        dec = esp_timer_get_time() - t0;
+        if (pt_len != len || memcmp(out, pt, len) != 0) {
+            ESP_LOGE(TAG, "%s: CBC round trip mismatch", be->name);
+        }
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            aes_ctr_crypt_at(handle, nonce, 0, pt, len, ct);
+        }
+        ctr = esp_timer_get_time() - t0;
+        memcpy(sum + 8, ct + len - 8, 8);
+
+        if (b == 0) {
+            memcpy(ref_sum, sum, sizeof(sum));
+        } else if (memcmp(ref_sum, sum, sizeof(sum)) != 0) {
+            ESP_LOGE(TAG, "%s: output differs from %s", be->name, aes_backend_get(0)->name);
+        }
+
+        ESP_LOGI(TAG, "%-8s | %7.1f MB/s %7.1f MB/s %7.1f MB/s", be->name,
+                 bench_mb_per_s(enc, total_bytes), bench_mb_per_s(dec, total_bytes),
+                 bench_mb_per_s(ctr, total_bytes));
+        aes_cbc_key_destroy(handle);
+    }
+
+done:
+    aes_backend_select(saved->name);
+    mbedtls_platform_zeroize(key, sizeof(key));
+    free(out);
+    free(ct);
+    free(pt);
+}
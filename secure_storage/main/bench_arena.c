@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_heap_caps.h"       // heap_caps_get_largest_free_block()
+#include "record.h"
+#include "record_cbc.h"
+#include "lzss.h"
+#include "crypto_arena.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+#define SIM_SECONDS        86400         // 24 h of simulated load, one record per second
+#define SIM_LIVE_SLOTS     32            // long-lived buffers of other subsystems (MQTT, logs)
+#define SIM_MIN_RECORD     64            // telemetry record sizes: SIM_MIN_RECORD..BENCH_MAX_MSG
+
+static lzss_work_t s_lzss;
+
+/* Reproducible sizes / lifetimes: both runs see the same allocation pattern */
+static uint32_t sim_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* One simulated day: every second a telemetry record is sealed and opened
+ * through crypto_scratch_alloc() temporaries, while other subsystems keep
+ * replacing long-lived heap buffers. Returns the number of failed records.
+ */
+static unsigned sim_day(const aes_cbc_key_t *handle, void *live[SIM_LIVE_SLOTS])
+{
+    uint32_t rng = 0x2545F491u;
+    unsigned failures = 0;
+    record_view_t view;
+    size_t rec_len = 0;
+    size_t pt_len = 0;
+
+    for (unsigned t = 0; t < SIM_SECONDS; t++) {
+        if ((sim_next(&rng) & 3) == 0) {
+            unsigned slot = sim_next(&rng) % SIM_LIVE_SLOTS;
+            free(live[slot]);
+            live[slot] = malloc(16 + sim_next(&rng) % 600);
+        }
+
+        size_t len = SIM_MIN_RECORD + sim_next(&rng) % (BENCH_MAX_MSG - SIM_MIN_RECORD + 1);
+        bench_make_payload(true, t, bench_msg, len);
+
+        uint8_t *rec = crypto_scratch_alloc(RECORD_CBC_MAX_LEN(len));
+        uint8_t *pt = crypto_scratch_alloc(len);
+        int ret = (rec == NULL || pt == NULL) ? -1 : 0;
+        if (ret == 0) {
+            ret = record_cbc_seal(handle, 1, &s_lzss, bench_msg, len,
+                                  rec, RECORD_CBC_MAX_LEN(len), &rec_len);
+        }
+        if (ret == 0) {
+            ret = record_parse(rec, rec_len, &view, NULL);
+        }
+        if (ret == 0) {
+            ret = record_cbc_open(handle, &view, pt, len, &pt_len);
+        }
+        if (ret != 0 || pt_len != len || memcmp(pt, bench_msg, len) != 0) {
+            failures++;
+        }
+        crypto_scratch_free(pt, len);
+        crypto_scratch_free(rec, RECORD_CBC_MAX_LEN(len));
+    }
+    return failures;
+}
+
+/**
+ * @brief Heap fragmentation after 24 h of simulated load: heap vs scratch arena.
+ *
+ * Both runs replay the same allocation pattern. In the first run the task
+ * has no arena, so every record temporary is a malloc/free interleaved with
+ * the long-lived buffers; in the second run they come from the task arena
+ * and the heap only sees the long-lived buffers. Measured while those are
+ * still allocated: free heap, largest free block and
+ * fragmentation = 1 - largest / free.
+ */
+void bench_scratch_arena(void)
+{
+    bench_fixture_t f;
+    void *live[SIM_LIVE_SLOTS];
+    crypto_arena_stats_t st;
+
+    // bench_task has its own arena; create one only if it could not
+    crypto_arena_t *arena = crypto_arena_task_get();
+    crypto_arena_t *own = NULL;
+    if (arena == NULL) {
+        arena = own = crypto_arena_create(CRYPTO_ARENA_DEFAULT_SIZE);
+    }
+    if (bench_fixture_init(&f) != 0 || arena == NULL) {
+        ESP_LOGE(TAG, "bench_scratch_arena: setup failed");
+        goto done;
+    }
+
+    ESP_LOGI(TAG, "24 h simulated load: %u telemetry records of %u..%u bytes, %u long-lived buffers",
+             SIM_SECONDS, SIM_MIN_RECORD, BENCH_MAX_MSG, SIM_LIVE_SLOTS);
+    ESP_LOGI(TAG, "%-14s | %9s %9s %7s | %8s %9s", "temporaries", "free", "largest",
+             "frag %", "failures", "time ms");
+
+    for (int use_arena = 0; use_arena <= 1; use_arena++) {
+        crypto_arena_t *prev = crypto_arena_task_bind(use_arena ? arena : NULL);
+        memset(live, 0, sizeof(live));
+
+        int64_t t0 = esp_timer_get_time();
+        unsigned failures = sim_day(f.handle, live);
+        int64_t elapsed = esp_timer_get_time() - t0;
+
+        size_t free_b = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        ESP_LOGI(TAG, "%-14s | %9zu %9zu %7.1f | %8u %9lld", use_arena ? "scratch arena" : "heap",
+                 free_b, largest, free_b ? 100.0 * (1.0 - (double)largest / (double)free_b) : 0.0,
+                 failures, (long long)(elapsed / 1000));
+
+        for (unsigned i = 0; i < SIM_LIVE_SLOTS; i++) {
+            free(live[i]);
+        }
+        crypto_arena_task_bind(prev);
+    }
+
+    crypto_arena_get_stats(arena, &st);
+    ESP_LOGI(TAG, "  arena %zu bytes: high water %zu, heap fallbacks %u", st.size, st.high_water,
+             (unsigned)st.fallbacks);
+
+done:
+    crypto_arena_destroy(own);
+    bench_fixture_free(&f);
+}
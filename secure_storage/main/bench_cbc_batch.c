@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "aes_cbc.h"
+#include "aes_cbc_batch.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/**
+ * @brief Per-record aes_cbc_*_pkcs7() vs aes_cbc_*_batch(), records/s.
+ *
+ * "Before" is what the NVS flush / uplink paths do today: one allocating
+ * call per record (checks, setkey, 2x malloc/free each). "After" is one
+ * batch call: one setkey, one arena, records encrypted in lockstep lanes.
+ */
+void bench_cbc_batch(void)
+{
+    static const size_t sizes[] = { 16, 64, 200, 1024 };
+    static aes_cbc_batch_rec_t recs[BENCH_BATCH];
+    static aes_cbc_batch_rec_t dec_recs[BENCH_BATCH];
+    const size_t arena_size = BENCH_BATCH * AES_CBC_PKCS7_CIPHERTEXT_LEN(BENCH_MAX_MSG);
+    uint8_t ivs[BENCH_BATCH][16];
+    bench_fixture_t f;
+
+    uint8_t *msgs = malloc(BENCH_BATCH * BENCH_MAX_MSG);
+    uint8_t *arena = malloc(arena_size);
+    uint8_t *plain = malloc(arena_size);
+    if (bench_fixture_init(&f) != 0 || msgs == NULL || arena == NULL || plain == NULL) {
+        ESP_LOGE(TAG, "bench_cbc_batch: setup failed");
+        goto done;
+    }
+    esp_fill_random(ivs, sizeof(ivs));
+    esp_fill_random(msgs, BENCH_BATCH * BENCH_MAX_MSG);
+
+    ESP_LOGI(TAG, "AES-256-CBC + PKCS#7, %d records: per-record call vs batch (records/s)", BENCH_BATCH);
+    ESP_LOGI(TAG, "%6s | %10s %10s %7s | %10s %10s %7s", "bytes",
+             "enc 1x", "enc batch", "speedup", "dec 1x", "dec batch", "speedup");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        unsigned rounds = (unsigned)(16 * BENCH_MAX_MSG / len);
+        size_t used = 0, plain_used = 0;
+        int64_t t0, t[4];
+
+        for (size_t j = 0; j < BENCH_BATCH; j++) {
+            recs[j].iv = ivs[j];
+            recs[j].in = msgs + j * BENCH_MAX_MSG;
+            recs[j].in_len = len;
+        }
+
+        t0 = esp_timer_get_time();
+        for (unsigned r = 0; r < rounds; r++) {
+            for (size_t j = 0; j < BENCH_BATCH; j++) {
+                uint8_t *ct = NULL;
+                size_t ct_len = 0;
+                if (aes_cbc_encrypt_pkcs7(f.key, 256, ivs[j], recs[j].in, len, &ct, &ct_len) == 0) {
+                    free(ct);
+                }
+            }
+        }
+        t[0] = esp_timer_get_time() - t0;
+
+        t0 = esp_timer_get_time();
+        for (unsigned r = 0; r < rounds; r++) {
+            aes_cbc_encrypt_batch(f.key, 256, recs, BENCH_BATCH, arena, arena_size, &used);
+        }
+        t[1] = esp_timer_get_time() - t0;
+
+        for (size_t j = 0; j < BENCH_BATCH; j++) {
+            dec_recs[j].iv = ivs[j];
+            dec_recs[j].in = arena + recs[j].out_off;
+            dec_recs[j].in_len = recs[j].out_len;
+        }
+
+        t0 = esp_timer_get_time();
+        for (unsigned r = 0; r < rounds; r++) {
+            for (size_t j = 0; j < BENCH_BATCH; j++) {
+                uint8_t *pt = NULL;
+                size_t pt_len = 0;
+                if (aes_cbc_decrypt_pkcs7(f.key, 256, ivs[j], dec_recs[j].in, dec_recs[j].in_len,
+                                          &pt, &pt_len) == 0) {
+                    free(pt);
+                }
+            }
+        }
+        t[2] = esp_timer_get_time() - t0;
+
+        t0 = esp_timer_get_time();
+        for (unsigned r = 0; r < rounds; r++) {
+            aes_cbc_decrypt_batch(f.key, 256, dec_recs, BENCH_BATCH, plain, arena_size, &plain_used);
+        }
+        t[3] = esp_timer_get_time() - t0;
+
+        for (size_t j = 0; j < BENCH_BATCH; j++) {
+            if (dec_recs[j].status != 0 || dec_recs[j].out_len != len ||
+                memcmp(plain + dec_recs[j].out_off, recs[j].in, len) != 0) {
+                ESP_LOGE(TAG, "batch round trip mismatch, record %zu (%zu bytes)", j, len);
+                break;
+            }
+        }
+
+        ESP_LOGI(TAG, "%6zu | %10.0f %10.0f %6.2fx | %10.0f %10.0f %6.2fx", len,
+                 bench_ops_per_s(t[0], rounds * BENCH_BATCH), bench_ops_per_s(t[1], rounds * BENCH_BATCH),
+                 t[1] > 0 ? (double)t[0] / (double)t[1] : 0.0,
+                 bench_ops_per_s(t[2], rounds * BENCH_BATCH), bench_ops_per_s(t[3], rounds * BENCH_BATCH),
+                 t[3] > 0 ? (double)t[2] / (double)t[3] : 0.0);
+    }
+
+done:
+    bench_fixture_free(&f);
+    free(plain);
+    free(arena);
+    free(msgs);
+}
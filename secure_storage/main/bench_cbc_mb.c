@@ -0,0 +1,80 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "aes_cbc.h"
+#include "aes_cbc_mb.h"
+#include "aes_backend.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/**
+ * @brief One record at a time vs multi-buffer lockstep, for a batch of records.
+ *
+ * Models a telemetry flush: BENCH_BATCH independent records, each with its own
+ * IV, encrypted back-to-back. On backends without cbc_multi (ESP32 peripheral,
+ * mbedTLS) both columns take the same path and should match.
+ */
+void bench_cbc_multibuffer(void)
+{
+    static const size_t sizes[] = { 16, 64, 256, 1024 };
+    static aes_cbc_mb_job_t jobs[BENCH_BATCH];
+    bench_fixture_t f;
+
+    uint8_t *buf = malloc(BENCH_BATCH * BENCH_MAX_MSG);
+    if (bench_fixture_init(&f) != 0 || buf == NULL) {
+        ESP_LOGE(TAG, "bench_cbc_multibuffer: setup failed");
+        goto done;
+    }
+    esp_fill_random(buf, BENCH_BATCH * BENCH_MAX_MSG);
+
+    ESP_LOGI(TAG, "AES-256-CBC, %d records per batch, backend %s", BENCH_BATCH,
+             aes_backend_active()->name);
+    ESP_LOGI(TAG, "%6s | %10s %10s %7s | %10s %10s %7s", "bytes",
+             "enc 1x/s", "enc mb/s", "speedup", "dec 1x/s", "dec mb/s", "speedup");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        unsigned rounds = (unsigned)(64 * BENCH_MAX_MSG / len);   // same bytes per size
+        int64_t t0, t[4];
+
+        for (size_t j = 0; j < BENCH_BATCH; j++) {
+            jobs[j].key = f.handle;
+            esp_fill_random(jobs[j].iv, sizeof(jobs[j].iv));
+            jobs[j].in = jobs[j].out = buf + j * BENCH_MAX_MSG;
+            jobs[j].len = len;
+        }
+
+        /*  In place, so each pass chains on the previous one (IVs are updated) */
+        for (int dir = 0; dir < 2; dir++) {
+            int mode = (dir == 0) ? AES_CBC_ENCRYPT : AES_CBC_DECRYPT;
+
+            t0 = esp_timer_get_time();
+            for (unsigned r = 0; r < rounds; r++) {
+                for (size_t j = 0; j < BENCH_BATCH; j++) {
+                    aes_cbc_mb_crypt(mode, &jobs[j], 1);
+                }
+            }
+            t[2 * dir] = esp_timer_get_time() - t0;
+
+            t0 = esp_timer_get_time();
+            for (unsigned r = 0; r < rounds; r++) {
+                aes_cbc_mb_crypt(mode, jobs, BENCH_BATCH);
+            }
+            t[2 * dir + 1] = esp_timer_get_time() - t0;
+        }
+
+        ESP_LOGI(TAG, "%6zu | %10.0f %10.0f %6.2fx | %10.0f %10.0f %6.2fx", len,
+                 bench_ops_per_s(t[0], rounds * BENCH_BATCH), bench_ops_per_s(t[1], rounds * BENCH_BATCH),
+                 t[1] > 0 ? (double)t[0] / (double)t[1] : 0.0,
+                 bench_ops_per_s(t[2], rounds * BENCH_BATCH), bench_ops_per_s(t[3], rounds * BENCH_BATCH),
+                 t[3] > 0 ? (double)t[2] / (double)t[3] : 0.0);
+    }
+
+done:
+    bench_fixture_free(&f);
+    free(buf);
+}
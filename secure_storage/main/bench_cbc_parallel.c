@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "aes_cbc.h"
+#include "crypto_workers.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/**
+ * @brief Serial vs parallel AES-CBC decryption, by buffer size.
+ *
+ * Shows where splitting the ciphertext across the crypto workers starts
+ * to pay off. On the ESP32 with the AES peripheral enabled both workers
+ * share one accelerator, so expect little or no scaling there.
+ */
+void bench_cbc_parallel(void)
+{
+    static const size_t sizes[] = { 1024, 4096, 16384, 65536 };
+    const size_t max_len = 65536;
+    const size_t total_bytes = 1024 * 1024;   // per measurement, spread over iterations
+    bench_fixture_t f;
+
+    if (crypto_workers_start() != 0) {
+        ESP_LOGE(TAG, "crypto_workers_start failed");
+        return;
+    }
+
+    uint8_t *pt = malloc(max_len);
+    uint8_t *ct = malloc(AES_CBC_PKCS7_CIPHERTEXT_LEN(max_len));
+    if (bench_fixture_init(&f) != 0 || pt == NULL || ct == NULL) {
+        ESP_LOGE(TAG, "bench_cbc_parallel: setup failed");
+        goto done;
+    }
+    esp_fill_random(pt, max_len);
+
+    ESP_LOGI(TAG, "AES-256-CBC decrypt, serial vs %u workers", (unsigned)crypto_workers_count());
+    ESP_LOGI(TAG, "%8s | %10s %10s | %7s", "bytes", "serial MB/s", "par. MB/s", "speedup");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        size_t ct_len = 0;
+        size_t pt_len = 0;
+        unsigned iterations = (unsigned)(total_bytes / len);
+        int64_t t0, serial, parallel;
+
+        aes_cbc_key_encrypt_pkcs7_into(f.handle, f.iv, pt, len, ct,
+                                       AES_CBC_PKCS7_CIPHERTEXT_LEN(max_len), &ct_len);
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            aes_cbc_key_decrypt_pkcs7_into(f.handle, f.iv, ct, ct_len, pt, max_len, &pt_len);
+        }
+        serial = esp_timer_get_time() - t0;
+
+        t0 = esp_timer_get_time();
+        for (unsigned i = 0; i < iterations; i++) {
+            aes_cbc_key_decrypt_pkcs7_parallel_into(f.handle, f.iv, ct, ct_len, pt, max_len, &pt_len);
+        }
+        parallel = esp_timer_get_time() - t0;
+
+        ESP_LOGI(TAG, "%8zu | %10.2f %10.2f | %6.2fx", len,
+                 bench_mb_per_s(serial, (size_t)iterations * len),
+                 bench_mb_per_s(parallel, (size_t)iterations * len),
+                 (parallel > 0) ? (double)serial / (double)parallel : 0.0);
+    }
+
+done:
+    bench_fixture_free(&f);
+    free(ct);
+    free(pt);
+}
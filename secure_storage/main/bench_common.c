@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "nvs_flash.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+uint8_t bench_msg[BENCH_MAX_MSG];
+uint8_t bench_ct[AES_CBC_PKCS7_CIPHERTEXT_LEN(BENCH_MAX_MSG)];
+uint8_t bench_pt[BENCH_MAX_MSG + 16];
+
+/**
+ * @brief Common setup of the benchmarks: fresh random key, IV and message.
+ *
+ * @param[out] f  Fixture, release with bench_fixture_free() (also on failure)
+ *
+ * @return 0 on success, -1 if aes_cbc_key_create() failed (already logged)
+ */
+int bench_fixture_init(bench_fixture_t *f)
+{
+    esp_fill_random(f->key, sizeof(f->key));
+    esp_fill_random(f->iv, sizeof(f->iv));
+    esp_fill_random(bench_msg, sizeof(bench_msg));
+
+    f->handle = aes_cbc_key_create(f->key, 256);
+    if (f->handle == NULL) {
+        ESP_LOGE(TAG, "aes_cbc_key_create failed");
+        return -1;
+    }
+    return 0;
+}
+
+void bench_fixture_free(bench_fixture_t *f)
+{
+    aes_cbc_key_destroy(f->handle);
+    f->handle = NULL;
+    mbedtls_platform_zeroize(f->key, sizeof(f->key));
+}
+
+/* Microseconds per operation -> operations per second */
+double bench_ops_per_s(int64_t elapsed_us, unsigned iterations)
+{
+    return (elapsed_us > 0) ? (iterations * 1e6) / (double)elapsed_us : 0.0;
+}
+
+/* Bytes processed in elapsed_us -> MB/s (1 MB = 1e6 bytes) */
+double bench_mb_per_s(int64_t elapsed_us, size_t bytes)
+{
+    return (elapsed_us > 0) ? (double)bytes / (double)elapsed_us : 0.0;
+}
+
+/* Entries used by one blob that fits in a page (NVS format v2):
+ * BLOB_IDX entry + data item header + ceil(len / 32) data entries.
+ */
+size_t bench_nvs_blob_entries(size_t len)
+{
+    return 2 + (len + BENCH_NVS_ENTRY_SIZE - 1) / BENCH_NVS_ENTRY_SIZE;
+}
+
+/* Sec_Store write tests erase and rewrite flash: opt-in only */
+bool bench_store_writes_enabled(void)
+{
+#if CONFIG_SECURE_STORAGE_BENCH_FLASH
+    return true;
+#else
+    ESP_LOGI(TAG, "  (%s write test skipped, enable CONFIG_SECURE_STORAGE_BENCH_FLASH)",
+             BENCH_STORE_PARTITION);
+    return false;
+#endif
+}
+
+/* Mount Sec_Store (erased and re-initialized if its layout is stale) */
+esp_err_t bench_store_init(void)
+{
+    esp_err_t err = nvs_flash_init_partition(BENCH_STORE_PARTITION);
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase_partition(BENCH_STORE_PARTITION);
+        err = nvs_flash_init_partition(BENCH_STORE_PARTITION);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS init %s failed: %s", BENCH_STORE_PARTITION, esp_err_to_name(err));
+    }
+    return err;
+}
+
+/* Repetitive text like the real payloads: a JSON config blob or a batch
+ * of key=value telemetry lines. Values vary with seq, the structure does not.
+ */
+void bench_make_payload(bool telemetry, unsigned seq, uint8_t *buf, size_t len)
+{
+    char line[96];
+    size_t o = 0;
+
+    for (unsigned i = 0; o < len; i++) {
+        int n;
+        if (telemetry) {
+            n = snprintf(line, sizeof(line), "ts=%u,temp=%d.%u,hum=%u,rssi=-%u,bat=%u\n",
+                         1700000000u + seq * 60 + i, 20 + (int)(esp_random() % 6),
+                         (unsigned)(esp_random() % 10), 40 + (unsigned)(esp_random() % 20),
+                         55 + (unsigned)(esp_random() % 30), 3600 + (unsigned)(esp_random() % 500));
+        } else if (i == 0) {
+            n = snprintf(line, sizeof(line), "{\"id\":%u,\"wifi\":{\"ssid\":\"plant-%u\",\"retry\":3},"
+                         "\"mqtt\":{\"port\":8883,\"qos\":1},\"ch\":[", seq, seq % 8);
+        } else {
+            n = snprintf(line, sizeof(line), "{\"ch\":%u,\"type\":\"ntc\",\"gain\":%u,\"offset\":%d},",
+                         i, 100 + (unsigned)(esp_random() % 4), (int)(esp_random() % 7) - 3);
+        }
+        size_t take = ((size_t)n < len - o) ? (size_t)n : len - o;
+        memcpy(buf + o, line, take);
+        o += take;
+    }
+}
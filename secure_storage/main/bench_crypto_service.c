@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "aes_cbc.h"
+#include "crypto_service.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/* Completion callback: runs on the service task */
+static void service_job_done(crypto_job_t *job)
+{
+    __atomic_add_fetch((volatile uint32_t *)job->user, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Caller-side cost of synchronous vs asynchronous (crypto_service) encryption.
+ *
+ * The synchronous column is how long a Wi-Fi handler / GPIO task would be
+ * blocked per blob today; the asynchronous one is the time spent in
+ * crypto_service_submit(). Queue depth and latency come from the service stats.
+ */
+void bench_crypto_service(void)
+{
+    static crypto_job_t jobs[BENCH_BATCH];
+    const size_t len = BENCH_MAX_MSG;
+    const size_t slot = AES_CBC_PKCS7_CIPHERTEXT_LEN(BENCH_MAX_MSG);
+    static volatile uint32_t completed;
+    bench_fixture_t f;
+
+    uint8_t *out = malloc(BENCH_BATCH * slot);
+    if (bench_fixture_init(&f) != 0 || out == NULL || crypto_service_start(BENCH_BATCH / 2) != 0) {
+        ESP_LOGE(TAG, "bench_crypto_service: setup failed");
+        goto done;
+    }
+
+    /*  Synchronous: the caller does the work */
+    int64_t t0 = esp_timer_get_time();
+    for (size_t j = 0; j < BENCH_BATCH; j++) {
+        size_t ct_len = 0;
+        aes_cbc_key_encrypt_pkcs7_into(f.handle, f.iv, bench_msg, len, out + j * slot, slot, &ct_len);
+    }
+    int64_t sync_us = esp_timer_get_time() - t0;
+
+    /*  Asynchronous: the caller only queues (queue is half the batch: some get rejected) */
+    crypto_service_reset_stats();
+    completed = 0;
+    unsigned queued = 0;
+    int64_t submit_us = 0;
+
+    for (size_t j = 0; j < BENCH_BATCH; j++) {
+        crypto_job_t *job = &jobs[j];
+        *job = (crypto_job_t){
+            .op = CRYPTO_OP_CBC_ENCRYPT,
+            .key = f.handle,
+            .in = bench_msg,
+            .in_len = len,
+            .out = out + j * slot,
+            .out_size = slot,
+            .cb = service_job_done,
+            .user = (void *)&completed,
+        };
+        esp_fill_random(job->iv, sizeof(job->iv));
+
+        t0 = esp_timer_get_time();
+        if (crypto_service_submit(job) == 0) {
+            queued++;
+        }
+        submit_us += esp_timer_get_time() - t0;
+    }
+    crypto_service_stop();           // drains the queue
+
+    crypto_service_stats_t st;
+    crypto_service_get_stats(&st);
+
+    ESP_LOGI(TAG, "crypto_service, %d x %zu-byte AES-256-CBC encryptions", BENCH_BATCH, len);
+    ESP_LOGI(TAG, "  caller blocked: sync %.1f us/job, async submit %.1f us/job",
+             (double)sync_us / BENCH_BATCH, (double)submit_us / BENCH_BATCH);
+    ESP_LOGI(TAG, "  queued %u, rejected %u (queue full), completed %u (callbacks %u)",
+             queued, (unsigned)st.rejected, (unsigned)st.completed, (unsigned)completed);
+    ESP_LOGI(TAG, "  queue depth max %u, latency avg %.1f us, max %lld us",
+             (unsigned)st.depth_max,
+             st.completed ? (double)st.latency_sum_us / st.completed : 0.0,
+             (long long)st.latency_max_us);
+
+done:
+    bench_fixture_free(&f);
+    free(out);
+}
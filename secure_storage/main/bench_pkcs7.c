@@ -0,0 +1,130 @@
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "pkcs_7.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/* The old pkcs7_unpad_16_inplace() check, kept only as the timing reference:
+ * the loop exits at the first wrong byte, so its running time depends on
+ * the padding value and on the position of the mismatch.
+ */
+static int unpad_early_exit(const uint8_t *input, size_t input_len, size_t *output_len)
+{
+    uint8_t pad = input[input_len - 1];
+
+    if (pad == 0 || pad > 16) {
+        return -3;
+    }
+    for (size_t i = 0; i < (size_t)pad; i++) {
+        if (input[input_len - 1 - i] != pad) {
+            return -4;
+        }
+    }
+    *output_len = input_len - (size_t)pad;
+    return 0;
+}
+
+typedef int (*unpad_fn_t)(const uint8_t *, size_t, size_t *);
+
+#define PAD_CLASSES   5
+#define PAD_SAMPLES   200            // timing samples per class
+#define PAD_BATCH     512            // calls per sample (esp_timer has 1 us resolution)
+
+/* Last blocks that reach different points of an early-exit check */
+static void make_pad_class(int cls, uint8_t block[16])
+{
+    esp_fill_random(block, 16);
+    switch (cls) {
+    case 0:  block[15] = 0x01; break;                                   // valid, 1 byte
+    case 1:  memset(block, 0x10, 16); break;                            // valid, full block
+    case 2:  block[15] = 0x00; break;                                   // bad length byte
+    case 3:  memset(block, 0x10, 16); block[0] = 0x0F; break;           // byte 0 wrong (checked last)
+    default: memset(block + 8, 0x08, 8); block[9] ^= 0x01; break;       // byte 9 wrong (mid-way)
+    }
+}
+
+/* Mean / variance of ns per call for every class, samples interleaved
+ * across classes so drift (cache, interrupts, DFS) hits them all alike.
+ */
+static void time_unpad(unpad_fn_t fn, double mean[PAD_CLASSES], double var[PAD_CLASSES])
+{
+    uint8_t blocks[PAD_CLASSES][16];
+    double sum[PAD_CLASSES] = { 0 };
+    double sum2[PAD_CLASSES] = { 0 };
+    volatile size_t sink = 0;
+    size_t out_len = 0;
+
+    for (int c = 0; c < PAD_CLASSES; c++) {
+        make_pad_class(c, blocks[c]);
+    }
+
+    for (unsigned s = 0; s < PAD_SAMPLES; s++) {
+        for (int k = 0; k < PAD_CLASSES; k++) {
+            int c = (int)((s + (unsigned)k) % PAD_CLASSES);
+            int64_t t0 = esp_timer_get_time();
+            for (unsigned i = 0; i < PAD_BATCH; i++) {
+                sink += (size_t)fn(blocks[c], 16, &out_len);
+            }
+            double ns = (double)(esp_timer_get_time() - t0) * 1000.0 / PAD_BATCH;
+            sum[c] += ns;
+            sum2[c] += ns * ns;
+        }
+    }
+    (void)sink;
+
+    for (int c = 0; c < PAD_CLASSES; c++) {
+        mean[c] = sum[c] / PAD_SAMPLES;
+        var[c] = sum2[c] / PAD_SAMPLES - mean[c] * mean[c];
+    }
+}
+
+/**
+ * @brief Speed and timing variance of the PKCS#7 check, early-exit vs constant-time.
+ *
+ * Five classes of last block (two valid, three invalid at different
+ * positions) are timed with interleaved samples. For each class the
+ * Welch t value against class 0 is printed: |t| above ~4.5 means the
+ * classes can be told apart by timing (same threshold as dudect).
+ * Also runs on the linux target (idf.py --preview set-target linux),
+ * where the timer resolution makes the test much sharper.
+ */
+void bench_pkcs7_timing(void)
+{
+    static const char *const classes[PAD_CLASSES] = {
+        "pad 01", "pad 16x10", "len 00", "bad byte 0", "bad byte 9"
+    };
+    static const struct {
+        const char *name;
+        unpad_fn_t fn;
+    } impls[] = {
+        { "early exit", unpad_early_exit },
+        { "constant-time", pkcs7_unpad_16_inplace },
+    };
+    double mean[PAD_CLASSES];
+    double var[PAD_CLASSES];
+
+    ESP_LOGI(TAG, "PKCS#7 check of one block, %u x %u calls per class (ns/call, t vs %s)",
+             PAD_SAMPLES, PAD_BATCH, classes[0]);
+    for (size_t m = 0; m < sizeof(impls) / sizeof(impls[0]); m++) {
+        double t_max = 0.0;
+
+        time_unpad(impls[m].fn, mean, var);
+        for (int c = 0; c < PAD_CLASSES; c++) {
+            double se = sqrt((var[0] + var[c]) / PAD_SAMPLES);
+            double t = (c == 0 || se == 0.0) ? 0.0 : (mean[c] - mean[0]) / se;
+            if (fabs(t) > t_max) {
+                t_max = fabs(t);
+            }
+            ESP_LOGI(TAG, "  %-13s %-10s: %7.2f ns  (sd %5.2f, t %6.1f)", impls[m].name,
+                     classes[c], mean[c], sqrt(var[c] > 0.0 ? var[c] : 0.0), t);
+        }
+        ESP_LOGI(TAG, "  %-13s max |t| = %.1f -> %s", impls[m].name, t_max,
+                 t_max < 4.5 ? "no timing difference detected" : "TIMING LEAK");
+    }
+}
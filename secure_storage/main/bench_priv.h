@@ -0,0 +1,45 @@
+#ifndef BENCH_PRIV_H
+#define BENCH_PRIV_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, int64_t
+#include <stdbool.h>
+#include "esp_err.h"  // esp_err_t
+#include "aes_cbc.h"  // aes_cbc_key_t, AES_CBC_PKCS7_CIPHERTEXT_LEN
+
+/* Shared by the bench_*.c files only (one file per benchmarked feature) */
+
+#define BENCH_TAG       "BENCH"
+#define BENCH_MAX_MSG   1024     // largest message used by the benchmarks
+#define BENCH_BATCH     48       // records per batch (telemetry flush)
+
+// Static buffers: the task stack is kept for the crypto frames underneath
+extern uint8_t bench_msg[BENCH_MAX_MSG];
+extern uint8_t bench_ct[AES_CBC_PKCS7_CIPHERTEXT_LEN(BENCH_MAX_MSG)];
+extern uint8_t bench_pt[BENCH_MAX_MSG + 16];
+
+/* Random AES-256 key + IV and its keyed handle; bench_msg is refilled too */
+typedef struct {
+    uint8_t key[32];
+    uint8_t iv[16];
+    aes_cbc_key_t *handle;
+} bench_fixture_t;
+
+int  bench_fixture_init(bench_fixture_t *f);   // 0, or -1 (logged) if the handle failed
+void bench_fixture_free(bench_fixture_t *f);   // destroys the handle, wipes the key
+
+double bench_ops_per_s(int64_t elapsed_us, unsigned iterations);
+double bench_mb_per_s(int64_t elapsed_us, size_t bytes);   // 1 MB = 1e6 bytes
+
+// Config JSON or telemetry text of len bytes (compresses like the real records)
+void bench_make_payload(bool telemetry, unsigned seq, uint8_t *buf, size_t len);
+
+/* Storage reports: records go to the Sec_Store NVS partition (partitions.csv) */
+#define BENCH_STORE_PARTITION   "Sec_Store"
+#define BENCH_NVS_ENTRY_SIZE    32       // NVS allocates blob data in 32-byte entries
+
+size_t    bench_nvs_blob_entries(size_t len);   // entries one blob of len bytes uses
+bool      bench_store_writes_enabled(void);     // CONFIG_SECURE_STORAGE_BENCH_FLASH, logs when off
+esp_err_t bench_store_init(void);               // mount Sec_Store (logged on failure)
+
+#endif // BENCH_PRIV_H
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "nvs.h"
+#include "record.h"
+#include "record_cbc.h"
+#include "lzss.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+#define LZ_MIN_RECORD      64            // config / telemetry records
+#define LZ_RECORDS         100           // records per payload kind written to Sec_Store
+
+static uint8_t s_record[RECORD_CBC_MAX_LEN(BENCH_MAX_MSG)];
+static uint8_t s_lz[LZSS_BOUND(BENCH_MAX_MSG)];
+static lzss_work_t s_lzss;
+static uint16_t s_lz_lens[LZ_RECORDS];
+
+/* Seal LZ_RECORDS payloads of s_lz_lens into one namespace: bytes on the
+ * wire (record length) and NVS entries consumed in Sec_Store.
+ */
+static int store_sealed(const aes_cbc_key_t *handle, const char *ns, bool telemetry,
+                        bool compress, size_t *bytes, size_t *entries)
+{
+    nvs_handle_t nvs;
+    nvs_stats_t before, after;
+    char name[8];
+    size_t rec_len = 0;
+
+    if (nvs_open_from_partition(BENCH_STORE_PARTITION, ns, NVS_READWRITE, &nvs) != ESP_OK) {
+        return -1;
+    }
+    nvs_erase_all(nvs);
+    nvs_commit(nvs);
+    nvs_get_stats(BENCH_STORE_PARTITION, &before);
+
+    *bytes = 0;
+    for (unsigned i = 0; i < LZ_RECORDS; i++) {
+        bench_make_payload(telemetry, i, bench_msg, s_lz_lens[i]);
+        if (record_cbc_seal(handle, 1, compress ? &s_lzss : NULL, bench_msg, s_lz_lens[i],
+                            s_record, sizeof(s_record), &rec_len) != 0) {
+            nvs_close(nvs);
+            return -2;
+        }
+
+        snprintf(name, sizeof(name), "r%03u", i);
+        if (nvs_set_blob(nvs, name, s_record, rec_len) != ESP_OK) {
+            nvs_close(nvs);
+            return -2;
+        }
+        *bytes += rec_len;
+    }
+    nvs_commit(nvs);
+    nvs_get_stats(BENCH_STORE_PARTITION, &after);
+    *entries = after.used_entries - before.used_entries;
+
+    nvs_erase_all(nvs);              // leave the partition as we found it
+    nvs_commit(nvs);
+    nvs_close(nvs);
+    return 0;
+}
+
+/**
+ * @brief Compress-then-encrypt vs encrypt only, on config and telemetry text.
+ *
+ * Part 1, per record size: record bytes on the wire, LZSS cost in us per KB
+ * of plaintext (compress / decompress alone) and the full seal + open
+ * round trip with and without compression. Part 2 writes LZ_RECORDS
+ * records of LZ_MIN_RECORD..BENCH_MAX_MSG bytes to Sec_Store both ways and
+ * compares the bytes and NVS entries they occupy (only with
+ * CONFIG_SECURE_STORAGE_BENCH_FLASH).
+ */
+void bench_record_compression(void)
+{
+    static const size_t sizes[] = { 64, 128, 256, 512, 1024 };
+    const unsigned iterations = 200;
+    bench_fixture_t f;
+    size_t rec_len = 0;
+    size_t out_len = 0;
+    record_view_t view;
+
+    if (bench_fixture_init(&f) != 0) {
+        goto done;
+    }
+
+    for (int telemetry = 0; telemetry <= 1; telemetry++) {
+        ESP_LOGI(TAG, "LZSS + AES-256-CBC records, %s payload (%u iterations)",
+                 telemetry ? "telemetry" : "config JSON", iterations);
+        ESP_LOGI(TAG, "%6s | %8s %8s | %10s %10s | %10s %10s", "bytes", "raw rec", "lz rec",
+                 "lz us/KB", "unlz us/KB", "seal+open", "lz s+o");
+
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t len = sizes[s];
+            size_t raw_len = 0;
+            size_t lz_len = 0;
+            size_t c_len = 0;
+            int64_t t_lz = 0, t_unlz = 0, t_raw = 0, t_both = 0;
+
+            bench_make_payload(telemetry, (unsigned)s, bench_msg, len);
+
+            int64_t t0 = esp_timer_get_time();
+            for (unsigned i = 0; i < iterations; i++) {
+                lzss_compress(&s_lzss, bench_msg, len, s_lz, sizeof(s_lz), &c_len);
+            }
+            t_lz = esp_timer_get_time() - t0;
+
+            t0 = esp_timer_get_time();
+            for (unsigned i = 0; i < iterations; i++) {
+                lzss_decompress(s_lz, c_len, bench_pt, sizeof(bench_pt), &out_len);
+            }
+            t_unlz = esp_timer_get_time() - t0;
+            if (out_len != len || memcmp(bench_pt, bench_msg, len) != 0) {
+                ESP_LOGE(TAG, "LZSS round trip mismatch at %zu bytes", len);
+                goto done;
+            }
+
+            for (int lz = 0; lz <= 1; lz++) {
+                int ret = 0;
+                t0 = esp_timer_get_time();
+                for (unsigned i = 0; i < iterations && ret == 0; i++) {
+                    ret = record_cbc_seal(f.handle, 1, lz ? &s_lzss : NULL, bench_msg, len,
+                                          s_record, sizeof(s_record), &rec_len);
+                    if (ret == 0) {
+                        ret = record_parse(s_record, rec_len, &view, NULL);
+                    }
+                    if (ret == 0) {
+                        ret = record_cbc_open(f.handle, &view, bench_pt, sizeof(bench_pt), &out_len);
+                    }
+                }
+                int64_t t = esp_timer_get_time() - t0;
+                if (ret != 0 || out_len != len || memcmp(bench_pt, bench_msg, len) != 0) {
+                    ESP_LOGE(TAG, "record round trip failed at %zu bytes: %d", len, ret);
+                    goto done;
+                }
+                if (lz) {
+                    lz_len = rec_len;
+                    t_both = t;
+                } else {
+                    raw_len = rec_len;
+                    t_raw = t;
+                }
+            }
+
+            double kb = (double)len * iterations / 1024.0;
+            ESP_LOGI(TAG, "%6zu | %8zu %8zu | %10.1f %10.1f | %10.1f %10.1f", len, raw_len, lz_len,
+                     t_lz / kb, t_unlz / kb, t_raw / kb, t_both / kb);
+        }
+    }
+    ESP_LOGI(TAG, "  (seal+open columns: us per KB of plaintext for the full round trip)");
+
+    if (!bench_store_writes_enabled() || bench_store_init() != ESP_OK) {
+        goto done;
+    }
+
+    for (int telemetry = 0; telemetry <= 1; telemetry++) {
+        size_t bytes_raw = 0, bytes_lz = 0;
+        size_t entries_raw = 0, entries_lz = 0;
+
+        for (unsigned i = 0; i < LZ_RECORDS; i++) {
+            s_lz_lens[i] = LZ_MIN_RECORD + esp_random() % (BENCH_MAX_MSG - LZ_MIN_RECORD + 1);
+        }
+
+        if (store_sealed(f.handle, "st_raw", telemetry, false, &bytes_raw, &entries_raw) != 0 ||
+            store_sealed(f.handle, "st_lzss", telemetry, true, &bytes_lz, &entries_lz) != 0) {
+            ESP_LOGE(TAG, "writing records to %s failed", BENCH_STORE_PARTITION);
+            goto done;
+        }
+
+        ESP_LOGI(TAG, "%s: %u %s records of %u..%u bytes", BENCH_STORE_PARTITION, LZ_RECORDS,
+                 telemetry ? "telemetry" : "config JSON", LZ_MIN_RECORD, BENCH_MAX_MSG);
+        ESP_LOGI(TAG, "  encrypt only   : %7zu bytes over the air, %5zu entries", bytes_raw, entries_raw);
+        ESP_LOGI(TAG, "  LZSS + encrypt : %7zu bytes over the air, %5zu entries", bytes_lz, entries_lz);
+        if (bytes_raw > 0 && entries_raw > 0) {
+            ESP_LOGI(TAG, "  saves %.1f%% of the air bytes, %zu entries (%zu bytes of partition space)",
+                     100.0 * (double)(bytes_raw - bytes_lz) / (double)bytes_raw,
+                     entries_raw - entries_lz, (entries_raw - entries_lz) * BENCH_NVS_ENTRY_SIZE);
+        }
+    }
+
+done:
+    bench_fixture_free(&f);
+}
@@ -0,0 +1,43 @@
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "esp_random.h"
+#include "rng_service.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+/**
+ * @brief Cost of one 16-byte IV: esp_fill_random() vs the rng_service pool.
+ *
+ * The burst is larger than the pool on purpose: the misses column shows
+ * how many IVs had to come straight from the DRBG because the refill task
+ * (lowest priority) had no chance to run in between.
+ */
+void bench_rng_iv(void)
+{
+    const unsigned iterations = 4096;
+    uint8_t iv[16];
+    rng_stats_t before, after;
+
+    int64_t t0 = esp_timer_get_time();
+    for (unsigned i = 0; i < iterations; i++) {
+        esp_fill_random(iv, sizeof(iv));
+    }
+    int64_t raw = esp_timer_get_time() - t0;
+
+    rng_service_get_stats(&before);
+    t0 = esp_timer_get_time();
+    for (unsigned i = 0; i < iterations; i++) {
+        rng_service_get_iv(iv, sizeof(iv));
+    }
+    int64_t pool = esp_timer_get_time() - t0;
+    rng_service_get_stats(&after);
+
+    ESP_LOGI(TAG, "16-byte IV, %u draws: esp_fill_random %.0f/s, rng pool %.0f/s",
+             iterations, bench_ops_per_s(raw, iterations), bench_ops_per_s(pool, iterations));
+    ESP_LOGI(TAG, "  pool hits %u, misses %u, refills %u, reseeds %u",
+             (unsigned)(after.pops - before.pops), (unsigned)(after.misses - before.misses),
+             (unsigned)(after.refills - before.refills), (unsigned)after.reseeds);
+}
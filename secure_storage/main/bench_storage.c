@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "nvs.h"
+#include "aes_cbc.h"
+#include "aes_cbc_cts.h"
+#include "bench.h"
+#include "bench_priv.h"
+
+static const char *TAG = BENCH_TAG;
+
+#define STORE_RECORDS      200           // records written per mode
+#define STORE_MIN_RECORD   16            // CS3 needs at least one block
+#define STORE_MAX_RECORD   200           // typical small config/credential records
+
+static uint16_t s_store_lens[STORE_RECORDS];
+
+/* Stored record = IV || ciphertext */
+static size_t stored_len(size_t len, bool cs3)
+{
+    if (cs3 && len >= AES_CBC_CS3_MIN_LEN) {
+        return 16 + len;
+    }
+    return 16 + AES_CBC_PKCS7_CIPHERTEXT_LEN(len);   // short records stay padded
+}
+
+/* Write every record of s_store_lens into its own namespace and measure
+ * the NVS entries consumed (nvs_get_stats before / after).
+ */
+static int store_records(const aes_cbc_key_t *handle, const char *ns, bool cs3,
+                         size_t *bytes, size_t *entries)
+{
+    nvs_handle_t nvs;
+    nvs_stats_t before, after;
+    char name[8];
+    size_t ct_len = 0;
+
+    if (nvs_open_from_partition(BENCH_STORE_PARTITION, ns, NVS_READWRITE, &nvs) != ESP_OK) {
+        return -1;
+    }
+    nvs_erase_all(nvs);
+    nvs_commit(nvs);
+    nvs_get_stats(BENCH_STORE_PARTITION, &before);
+
+    *bytes = 0;
+    for (unsigned i = 0; i < STORE_RECORDS; i++) {
+        size_t len = s_store_lens[i];
+        uint8_t *iv = bench_ct;      // record layout: IV || C
+
+        esp_fill_random(iv, 16);
+        if (cs3) {
+            aes_cbc_cs3_encrypt_into(handle, iv, bench_msg, len, bench_ct + 16);
+            ct_len = len;
+        } else {
+            aes_cbc_key_encrypt_pkcs7_into(handle, iv, bench_msg, len, bench_ct + 16,
+                                           sizeof(bench_ct) - 16, &ct_len);
+        }
+
+        snprintf(name, sizeof(name), "r%03u", i);
+        if (nvs_set_blob(nvs, name, bench_ct, 16 + ct_len) != ESP_OK) {
+            nvs_close(nvs);
+            return -2;
+        }
+        *bytes += 16 + ct_len;
+    }
+    nvs_commit(nvs);
+    nvs_get_stats(BENCH_STORE_PARTITION, &after);
+    *entries = after.used_entries - before.used_entries;
+
+    nvs_erase_all(nvs);              // leave the partition as we found it
+    nvs_commit(nvs);
+    nvs_close(nvs);
+    return 0;
+}
+
+/**
+ * @brief Storage cost of PKCS#7-padded CBC vs CBC-CS3 in the Sec_Store NVS partition.
+ *
+ * PKCS#7 always adds 1..16 bytes (a whole block when the record is already
+ * aligned); CS3 keeps ciphertext == plaintext length. Because NVS allocates
+ * blob data in 32-byte entries, a few padding bytes can cost a full entry
+ * (and its flash write). Part 1 is the per-size math, part 2 writes real
+ * records to Sec_Store and reads the used-entry count from nvs_get_stats()
+ * (only with CONFIG_SECURE_STORAGE_BENCH_FLASH).
+ */
+void bench_cbc_storage_report(void)
+{
+    static const size_t sizes[] = { 16, 24, 31, 32, 48, 60, 64, 96, 100, 128, 200 };
+    size_t bytes_pkcs7 = 0, bytes_cs3 = 0;
+    size_t entries_pkcs7 = 0, entries_cs3 = 0;
+    bench_fixture_t f;
+
+    ESP_LOGI(TAG, "NVS storage, IV || ciphertext per record (%d-byte entries)", BENCH_NVS_ENTRY_SIZE);
+    ESP_LOGI(TAG, "%6s | %12s %12s | %12s %12s", "bytes",
+             "pkcs7 bytes", "pkcs7 ent.", "cs3 bytes", "cs3 ent.");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t pad = stored_len(sizes[s], false);
+        size_t cts = stored_len(sizes[s], true);
+        ESP_LOGI(TAG, "%6zu | %12zu %12zu | %12zu %12zu", sizes[s],
+                 pad, bench_nvs_blob_entries(pad), cts, bench_nvs_blob_entries(cts));
+    }
+
+    if (!bench_store_writes_enabled() || bench_store_init() != ESP_OK) {
+        return;
+    }
+
+    if (bench_fixture_init(&f) != 0) {
+        goto done;
+    }
+
+    /*  Workload 1: arbitrary lengths. Workload 2: block-aligned secrets
+     *  (keys, hashes), where PKCS#7 always adds a full block.
+     */
+    for (int aligned = 0; aligned <= 1; aligned++) {
+        for (unsigned i = 0; i < STORE_RECORDS; i++) {
+            s_store_lens[i] = aligned
+                ? 16 * (1 + esp_random() % (STORE_MAX_RECORD / 16))
+                : STORE_MIN_RECORD + esp_random() % (STORE_MAX_RECORD - STORE_MIN_RECORD + 1);
+        }
+
+        if (store_records(f.handle, "st_pkcs7", false, &bytes_pkcs7, &entries_pkcs7) != 0 ||
+            store_records(f.handle, "st_cs3", true, &bytes_cs3, &entries_cs3) != 0) {
+            ESP_LOGE(TAG, "writing records to %s failed", BENCH_STORE_PARTITION);
+            goto done;
+        }
+
+        ESP_LOGI(TAG, "%s: %u %s records of %u..%u bytes", BENCH_STORE_PARTITION, STORE_RECORDS,
+                 aligned ? "block-aligned" : "arbitrary", STORE_MIN_RECORD, STORE_MAX_RECORD);
+        ESP_LOGI(TAG, "  CBC+PKCS#7: %7zu bytes, %5zu entries", bytes_pkcs7, entries_pkcs7);
+        ESP_LOGI(TAG, "  CBC-CS3   : %7zu bytes, %5zu entries", bytes_cs3, entries_cs3);
+        if (entries_pkcs7 > 0) {
+            ESP_LOGI(TAG, "  CS3 saves %zu entries (%.1f%%) = %zu bytes of partition space",
+                     entries_pkcs7 - entries_cs3,
+                     100.0 * (double)(entries_pkcs7 - entries_cs3) / (double)entries_pkcs7,
+                     (entries_pkcs7 - entries_cs3) * BENCH_NVS_ENTRY_SIZE);
+        }
+    }
+
+done:
+    bench_fixture_free(&f);
+}
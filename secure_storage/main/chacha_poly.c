@@ -0,0 +1,434 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "mbedtls/chacha20.h"
+#include "mbedtls/poly1305.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "chacha_poly.h"
+
+#define CP_CHUNK  256                // ChaCha20 + Poly1305 interleave size (stays in cache)
+
+struct chacha_poly_key {
+    uint8_t key[CHACHA_POLY_KEY_LEN];// ChaCha20 has no key schedule: the key IS the state
+};
+
+static const uint8_t zeros[64];
+
+/* Poly1305 input is zero-padded to 16 bytes after the AAD and after the data */
+static int cp_pad16(chacha_poly_stream_t *ctx, uint64_t len)
+{
+    size_t rem = (size_t)(len % 16);
+    return rem ? mbedtls_poly1305_update(&ctx->poly, zeros, 16 - rem) : 0;
+}
+
+static int cp_enter_data(chacha_poly_stream_t *ctx)
+{
+    if (ctx->phase == 0) {
+        ctx->phase = 1;
+        return cp_pad16(ctx, ctx->aad_len);
+    }
+    return 0;
+}
+
+/* tag = Poly1305(AAD || pad || C || pad || le64(aad_len) || le64(data_len)) */
+static int cp_compute_tag(chacha_poly_stream_t *ctx, uint8_t tag[CHACHA_POLY_TAG_LEN])
+{
+    uint8_t lens[16];
+    int ret;
+
+    ret = cp_enter_data(ctx);
+    if (ret == 0) {
+        ret = cp_pad16(ctx, ctx->data_len);
+    }
+    for (int i = 0; i < 8; i++) {
+        lens[i]     = (uint8_t)(ctx->aad_len >> (8 * i));
+        lens[8 + i] = (uint8_t)(ctx->data_len >> (8 * i));
+    }
+    if (ret == 0) {
+        ret = mbedtls_poly1305_update(&ctx->poly, lens, sizeof(lens));
+    }
+    if (ret == 0) {
+        ret = mbedtls_poly1305_finish(&ctx->poly, tag);
+    }
+    ctx->phase = 2;
+    return ret;
+}
+
+/* Tag comparison without an early exit */
+static int cp_tag_equal(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+    for (int i = 0; i < CHACHA_POLY_TAG_LEN; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+/**
+ * @brief Create a ChaCha20-Poly1305 key handle.
+ *
+ * Constant-time in software (add/rotate/xor only, no tables), which makes
+ * it the better AEAD wherever AES has no hardware support.
+ *
+ * IMPORTANT NOTES:
+ *  - A (key, nonce) pair must NEVER be reused (same rule as AES-GCM).
+ *
+ * @param[in] key  32-byte key
+ *
+ * @return Handle on success, NULL on invalid args / no memory
+ */
+chacha_poly_key_t *chacha_poly_key_create(const uint8_t key[CHACHA_POLY_KEY_LEN])
+{
+    chacha_poly_key_t *self;
+
+    if (key == NULL) {
+        return NULL;
+    }
+
+    self = malloc(sizeof(*self));
+    if (self == NULL) {
+        return NULL;
+    }
+    memcpy(self->key, key, CHACHA_POLY_KEY_LEN);
+    return self;
+}
+
+/**
+ * @brief Wipe and free a handle from chacha_poly_key_create(). NULL is accepted.
+ */
+void chacha_poly_key_destroy(chacha_poly_key_t *self)
+{
+    if (self == NULL) {
+        return;
+    }
+    mbedtls_platform_zeroize(self, sizeof(*self));
+    free(self);
+}
+
+/**
+ * @brief Start a ChaCha20-Poly1305 message.
+ *
+ * Block 0 of the keystream becomes the one-time Poly1305 key, the data
+ * is encrypted from block 1 on (RFC 8439 section 2.8).
+ *
+ * @param[out] ctx    Stream context (caller memory)
+ * @param[in]  key    Handle from chacha_poly_key_create(), only read here
+ * @param[in]  mode   CHACHA_POLY_ENCRYPT or CHACHA_POLY_DECRYPT
+ * @param[in]  nonce  12-byte nonce, unique per message
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_start(chacha_poly_stream_t *ctx, const chacha_poly_key_t *key, int mode,
+                             const uint8_t nonce[CHACHA_POLY_NONCE_LEN])
+{
+    int ret;
+    uint8_t block0[64];
+
+    if (ctx == NULL || key == NULL || nonce == NULL ||
+        (mode != CHACHA_POLY_ENCRYPT && mode != CHACHA_POLY_DECRYPT)) {
+        return -1;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->mode = mode;
+    mbedtls_chacha20_init(&ctx->chacha);
+    mbedtls_poly1305_init(&ctx->poly);
+
+    ret = mbedtls_chacha20_setkey(&ctx->chacha, key->key);
+    if (ret == 0) {
+        ret = mbedtls_chacha20_starts(&ctx->chacha, nonce, 0);
+    }
+    if (ret == 0) {
+        ret = mbedtls_chacha20_update(&ctx->chacha, sizeof(block0), zeros, block0);
+    }
+    if (ret == 0) {
+        ret = mbedtls_poly1305_starts(&ctx->poly, block0);    // first 32 bytes
+    }
+
+    mbedtls_platform_zeroize(block0, sizeof(block0));
+    if (ret != 0) {
+        chacha_poly_stream_free(ctx);
+    }
+    return ret;                      // keystream now sits at block 1
+}
+
+/**
+ * @brief Feed additional authenticated data, only before the first update().
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 called after data was processed
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_aad(chacha_poly_stream_t *ctx, const uint8_t *aad, size_t aad_len)
+{
+    if (ctx == NULL || (aad == NULL && aad_len != 0)) {
+        return -1;
+    }
+    if (ctx->phase != 0) {
+        return -2;
+    }
+
+    ctx->aad_len += aad_len;
+    return aad_len ? mbedtls_poly1305_update(&ctx->poly, aad, aad_len) : 0;
+}
+
+/**
+ * @brief Encrypt or decrypt the next chunk (any size, output == input size).
+ *
+ * Single pass like aes_gcm_stream_update(): ChaCha20 and Poly1305 run over
+ * each CP_CHUNK slice while it is in cache. in == out is allowed.
+ *
+ * IMPORTANT NOTES:
+ *  - Streaming DECRYPT releases plaintext before chacha_poly_stream_verify():
+ *    discard it if verify fails, or use chacha_poly_decrypt_into().
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 called after finish/verify
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_update(chacha_poly_stream_t *ctx, const uint8_t *in, size_t len, uint8_t *out)
+{
+    int ret;
+
+    if (ctx == NULL || ((in == NULL || out == NULL) && len != 0)) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    ret = cp_enter_data(ctx);
+
+    while (ret == 0 && len > 0) {
+        size_t n = (len < CP_CHUNK) ? len : CP_CHUNK;
+
+        if (ctx->mode == CHACHA_POLY_DECRYPT) {
+            ret = mbedtls_poly1305_update(&ctx->poly, in, n);
+        }
+        if (ret == 0) {
+            ret = mbedtls_chacha20_update(&ctx->chacha, n, in, out);
+        }
+        if (ret == 0 && ctx->mode == CHACHA_POLY_ENCRYPT) {
+            ret = mbedtls_poly1305_update(&ctx->poly, out, n);
+        }
+
+        ctx->data_len += n;
+        in += n;
+        out += n;
+        len -= n;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Finish an ENCRYPT stream and output the 16-byte tag. Wipes the context.
+ *
+ * @return 0 on success
+ *         -1 invalid args / not an encrypt stream
+ *         -2 already finished
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_finish(chacha_poly_stream_t *ctx, uint8_t tag[CHACHA_POLY_TAG_LEN])
+{
+    int ret;
+
+    if (ctx == NULL || tag == NULL || ctx->mode != CHACHA_POLY_ENCRYPT) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    ret = cp_compute_tag(ctx, tag);
+    chacha_poly_stream_free(ctx);
+    return ret;
+}
+
+/**
+ * @brief Finish a DECRYPT stream and check the received tag. Wipes the context.
+ *
+ * @return 0 tag valid
+ *         -1 invalid args / not a decrypt stream
+ *         -2 already finished
+ *         -3 authentication failed
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_verify(chacha_poly_stream_t *ctx, const uint8_t tag[CHACHA_POLY_TAG_LEN])
+{
+    int ret;
+    uint8_t expected[CHACHA_POLY_TAG_LEN];
+
+    if (ctx == NULL || tag == NULL || ctx->mode != CHACHA_POLY_DECRYPT) {
+        return -1;
+    }
+    if (ctx->phase == 2) {
+        return -2;
+    }
+
+    ret = cp_compute_tag(ctx, expected);
+    if (ret == 0 && !cp_tag_equal(expected, tag)) {
+        ret = -3;
+    }
+
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+    chacha_poly_stream_free(ctx);
+    return ret;
+}
+
+/**
+ * @brief Finish a DECRYPT stream in one go: check the tag, then decrypt.
+ *
+ * Same contract as aes_gcm_stream_open(): after start + aad* only, Poly1305
+ * runs over the whole ciphertext first and ChaCha20 only starts when the
+ * tag matches. Wipes the context except on invalid args.
+ *
+ * @return 0 on success
+ *         -1 invalid args / not a decrypt stream
+ *         -2 data already processed (update() called) or already finished
+ *         -3 authentication failed (plaintext untouched)
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_stream_open(chacha_poly_stream_t *ctx, const uint8_t *ciphertext, size_t len,
+                            const uint8_t tag[CHACHA_POLY_TAG_LEN], uint8_t *plaintext)
+{
+    int ret;
+    uint8_t expected[CHACHA_POLY_TAG_LEN];
+
+    if (ctx == NULL || tag == NULL || ctx->mode != CHACHA_POLY_DECRYPT ||
+        ((ciphertext == NULL || plaintext == NULL) && len != 0)) {
+        return -1;
+    }
+    if (ctx->phase != 0) {
+        return -2;
+    }
+
+    /*  Pass 1: authenticate only */
+    ret = cp_enter_data(ctx);
+    if (ret == 0 && len > 0) {
+        ret = mbedtls_poly1305_update(&ctx->poly, ciphertext, len);
+    }
+    ctx->data_len = len;
+    if (ret == 0) {
+        ret = cp_compute_tag(ctx, expected);
+    }
+    if (ret == 0 && !cp_tag_equal(expected, tag)) {
+        ret = -3;
+    }
+
+    /*  Pass 2: decrypt (keystream still at block 1) */
+    if (ret == 0 && len > 0) {
+        ret = mbedtls_chacha20_update(&ctx->chacha, len, ciphertext, plaintext);
+    }
+
+    mbedtls_platform_zeroize(expected, sizeof(expected));
+    chacha_poly_stream_free(ctx);
+    return ret;
+}
+
+/**
+ * @brief Wipe a stream context. Safe to call more than once.
+ */
+void chacha_poly_stream_free(chacha_poly_stream_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+    mbedtls_chacha20_free(&ctx->chacha);
+    mbedtls_poly1305_free(&ctx->poly);
+    mbedtls_platform_zeroize(ctx, sizeof(*ctx));
+}
+
+/**
+ * @brief One-shot ChaCha20-Poly1305 encryption with a detached tag.
+ *
+ * @param[in]  key         Handle from chacha_poly_key_create()
+ * @param[in]  nonce       12-byte nonce, unique per message
+ * @param[in]  aad         Authenticated-only data (may be NULL if aad_len == 0)
+ * @param[in]  aad_len     AAD length in bytes
+ * @param[in]  plaintext   Input bytes
+ * @param[in]  len         Input length in bytes (ciphertext has the same length)
+ * @param[out] ciphertext  Output buffer, len bytes (may equal plaintext)
+ * @param[out] tag         16-byte authentication tag
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_encrypt_into(const chacha_poly_key_t *key,
+                             const uint8_t nonce[CHACHA_POLY_NONCE_LEN],
+                             const uint8_t *aad, size_t aad_len,
+                             const uint8_t *plaintext, size_t len,
+                             uint8_t *ciphertext, uint8_t tag[CHACHA_POLY_TAG_LEN])
+{
+    int ret;
+    chacha_poly_stream_t ctx;
+
+    if (tag == NULL) {
+        return -1;
+    }
+
+    ret = chacha_poly_stream_start(&ctx, key, CHACHA_POLY_ENCRYPT, nonce);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = chacha_poly_stream_aad(&ctx, aad, aad_len);
+    if (ret == 0) {
+        ret = chacha_poly_stream_update(&ctx, plaintext, len, ciphertext);
+    }
+    if (ret == 0) {
+        return chacha_poly_stream_finish(&ctx, tag);
+    }
+
+    chacha_poly_stream_free(&ctx);
+    return ret;
+}
+
+/**
+ * @brief One-shot ChaCha20-Poly1305 decryption, tag checked before any plaintext.
+ *
+ * Pass 1 runs Poly1305 over AAD + ciphertext; only a matching tag starts
+ * pass 2 (ChaCha20). Forged records cost one Poly1305 pass and the
+ * plaintext buffer is never written.
+ *
+ * @param[in]  key         Handle from chacha_poly_key_create()
+ * @param[in]  nonce       Nonce used for encryption
+ * @param[in]  aad         Authenticated-only data (may be NULL if aad_len == 0)
+ * @param[in]  aad_len     AAD length in bytes
+ * @param[in]  ciphertext  Input bytes
+ * @param[in]  len         Input length in bytes
+ * @param[in]  tag         Received 16-byte tag
+ * @param[out] plaintext   Output buffer, len bytes (may equal ciphertext)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -3 authentication failed (plaintext untouched)
+ *         otherwise: mbedTLS error code
+ */
+int chacha_poly_decrypt_into(const chacha_poly_key_t *key,
+                             const uint8_t nonce[CHACHA_POLY_NONCE_LEN],
+                             const uint8_t *aad, size_t aad_len,
+                             const uint8_t *ciphertext, size_t len,
+                             const uint8_t tag[CHACHA_POLY_TAG_LEN], uint8_t *plaintext)
+{
+    int ret;
+    chacha_poly_stream_t ctx;
+
+    ret = chacha_poly_stream_start(&ctx, key, CHACHA_POLY_DECRYPT, nonce);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = chacha_poly_stream_aad(&ctx, aad, aad_len);
+    if (ret == 0) {
+        ret = chacha_poly_stream_open(&ctx, ciphertext, len, tag, plaintext);
+    }
+
+    chacha_poly_stream_free(&ctx);
+    return ret;
+}
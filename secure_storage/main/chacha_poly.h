@@ -0,0 +1,61 @@
+#ifndef CHACHA_POLY_H
+#define CHACHA_POLY_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint64_t
+#include "mbedtls/chacha20.h"
+#include "mbedtls/poly1305.h"
+
+#define CHACHA_POLY_ENCRYPT    1
+#define CHACHA_POLY_DECRYPT    0
+
+#define CHACHA_POLY_KEY_LEN    32
+#define CHACHA_POLY_NONCE_LEN  12    // RFC 8439 96-bit nonce
+#define CHACHA_POLY_TAG_LEN    16
+
+/* ChaCha20-Poly1305 (RFC 8439) key handle (opaque), same shape as aes_gcm_key_t.
+ * Read-only after create, can be shared between tasks.
+ */
+typedef struct chacha_poly_key chacha_poly_key_t;
+
+chacha_poly_key_t *chacha_poly_key_create(const uint8_t key[CHACHA_POLY_KEY_LEN]);
+void               chacha_poly_key_destroy(chacha_poly_key_t *self);
+
+/* Streaming context (caller memory, treat the fields as private).
+ * Order: start -> aad* -> update* -> finish (encrypt) / verify (decrypt),
+ * or start -> aad* -> open (decrypt, tag checked before any plaintext)
+ */
+typedef struct {
+    int mode;                        // CHACHA_POLY_ENCRYPT / CHACHA_POLY_DECRYPT
+    int phase;                       // 0 = AAD, 1 = data, 2 = finished
+    mbedtls_chacha20_context chacha; // keystream, block counter 1..
+    mbedtls_poly1305_context poly;   // one-time key from block 0
+    uint64_t aad_len;
+    uint64_t data_len;
+} chacha_poly_stream_t;
+
+int  chacha_poly_stream_start(chacha_poly_stream_t *ctx, const chacha_poly_key_t *key, int mode,
+                              const uint8_t nonce[CHACHA_POLY_NONCE_LEN]);
+int  chacha_poly_stream_aad(chacha_poly_stream_t *ctx, const uint8_t *aad, size_t aad_len);
+int  chacha_poly_stream_update(chacha_poly_stream_t *ctx, const uint8_t *in, size_t len, uint8_t *out);
+int  chacha_poly_stream_finish(chacha_poly_stream_t *ctx, uint8_t tag[CHACHA_POLY_TAG_LEN]);
+int  chacha_poly_stream_verify(chacha_poly_stream_t *ctx, const uint8_t tag[CHACHA_POLY_TAG_LEN]);
+int  chacha_poly_stream_open(chacha_poly_stream_t *ctx, const uint8_t *ciphertext, size_t len,
+                             const uint8_t tag[CHACHA_POLY_TAG_LEN], uint8_t *plaintext);
+void chacha_poly_stream_free(chacha_poly_stream_t *ctx);
+
+/* One-shot: ciphertext size == plaintext size, tag is detached */
+int chacha_poly_encrypt_into(const chacha_poly_key_t *key,
+                             const uint8_t nonce[CHACHA_POLY_NONCE_LEN],
+                             const uint8_t *aad, size_t aad_len,
+                             const uint8_t *plaintext, size_t len,
+                             uint8_t *ciphertext, uint8_t tag[CHACHA_POLY_TAG_LEN]);
+
+// Verifies the tag BEFORE decrypting, like aes_gcm_decrypt_into()
+int chacha_poly_decrypt_into(const chacha_poly_key_t *key,
+                             const uint8_t nonce[CHACHA_POLY_NONCE_LEN],
+                             const uint8_t *aad, size_t aad_len,
+                             const uint8_t *ciphertext, size_t len,
+                             const uint8_t tag[CHACHA_POLY_TAG_LEN], uint8_t *plaintext);
+
+#endif // CHACHA_POLY_H
@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "crypto_arena.h"
+
+struct crypto_arena {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+    uint32_t fallbacks;
+};
+
+/* One arena per task: thread-local storage works for FreeRTOS tasks in
+ * ESP-IDF and for pthreads on the linux target alike.
+ */
+static __thread crypto_arena_t *s_task_arena;
+
+/**
+ * @brief Reserve a scratch arena of size bytes.
+ *
+ * The only heap allocation the arena ever makes; do it at init, before the
+ * heap gets fragmented, and keep the arena for the life of the task.
+ *
+ * @param[in] size  Usable bytes (rounded up to CRYPTO_ARENA_ALIGN)
+ *
+ * @return Arena, or NULL on invalid size / malloc failure
+ */
+crypto_arena_t *crypto_arena_create(size_t size)
+{
+    crypto_arena_t *arena = NULL;
+
+    if (size == 0) {
+        return NULL;
+    }
+    size = (size + CRYPTO_ARENA_ALIGN - 1) & ~(size_t)(CRYPTO_ARENA_ALIGN - 1);
+
+    arena = calloc(1, sizeof(*arena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->base = calloc(1, size);
+    if (arena->base == NULL) {
+        free(arena);
+        return NULL;
+    }
+    arena->size = size;
+    return arena;
+}
+
+/**
+ * @brief Wipe the whole arena (not only the used part) and free it.
+ *
+ * @param[in] arena  Arena from crypto_arena_create() (NULL is ignored)
+ */
+void crypto_arena_destroy(crypto_arena_t *arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+    if (s_task_arena == arena) {
+        s_task_arena = NULL;
+    }
+    mbedtls_platform_zeroize(arena->base, arena->size);
+    free(arena->base);
+    mbedtls_platform_zeroize(arena, sizeof(*arena));
+    free(arena);
+}
+
+/**
+ * @brief Bump-allocate len bytes (aligned to CRYPTO_ARENA_ALIGN).
+ *
+ * IMPORTANT NOTES:
+ *  - Not thread-safe: an arena belongs to one task
+ *  - Memory is zero on return only the first time; afterwards it is zero
+ *    because every release wipes it
+ *
+ * @param[in,out] arena  Arena
+ * @param[in]     len    Bytes requested (0 is allowed)
+ *
+ * @return Pointer into the arena, or NULL if it does not fit
+ */
+void *crypto_arena_alloc(crypto_arena_t *arena, size_t len)
+{
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    size_t start = (arena->used + CRYPTO_ARENA_ALIGN - 1) & ~(size_t)(CRYPTO_ARENA_ALIGN - 1);
+    if (start > arena->size || len > arena->size - start) {
+        return NULL;
+    }
+
+    arena->used = start + len;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    return arena->base + start;
+}
+
+/* Current fill level, to be handed back to crypto_arena_release() */
+size_t crypto_arena_mark(const crypto_arena_t *arena)
+{
+    return (arena != NULL) ? arena->used : 0;
+}
+
+/**
+ * @brief Free everything allocated after mark and zeroize it.
+ *
+ * mbedtls_platform_zeroize() goes through a volatile function pointer, so
+ * the wipe is not removed as a dead store even though the memory is only
+ * written afterwards.
+ *
+ * @param[in,out] arena  Arena
+ * @param[in]     mark   Value from crypto_arena_mark() (or an offset from
+ *                       crypto_scratch_free()); larger than used is ignored
+ */
+void crypto_arena_release(crypto_arena_t *arena, size_t mark)
+{
+    if (arena == NULL || mark >= arena->used) {
+        return;
+    }
+    mbedtls_platform_zeroize(arena->base + mark, arena->used - mark);
+    arena->used = mark;
+}
+
+/* Release everything (the arena stays reserved) */
+void crypto_arena_reset(crypto_arena_t *arena)
+{
+    crypto_arena_release(arena, 0);
+}
+
+void crypto_arena_get_stats(const crypto_arena_t *arena, crypto_arena_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (arena != NULL) {
+        out->size = arena->size;
+        out->used = arena->used;
+        out->high_water = arena->high_water;
+        out->fallbacks = arena->fallbacks;
+    }
+}
+
+/**
+ * @brief Reserve an arena and bind it to the calling task.
+ *
+ * @param[in] size  Arena size in bytes (0 -> CRYPTO_ARENA_DEFAULT_SIZE)
+ *
+ * @return 0 on success
+ *         -1 the task already has an arena
+ *         -2 out of memory
+ */
+int crypto_arena_task_init(size_t size)
+{
+    if (s_task_arena != NULL) {
+        return -1;
+    }
+
+    crypto_arena_t *arena = crypto_arena_create(size ? size : CRYPTO_ARENA_DEFAULT_SIZE);
+    if (arena == NULL) {
+        return -2;
+    }
+    s_task_arena = arena;
+    return 0;
+}
+
+/* Unbind and destroy the calling task's arena (call before the task exits) */
+void crypto_arena_task_deinit(void)
+{
+    crypto_arena_destroy(s_task_arena);
+    s_task_arena = NULL;
+}
+
+crypto_arena_t *crypto_arena_task_get(void)
+{
+    return s_task_arena;
+}
+
+/**
+ * @brief Bind an existing arena to the calling task (NULL unbinds).
+ *
+ * Lets a long-lived task swap arenas without a new allocation. The
+ * previous arena is returned, not destroyed.
+ *
+ * IMPORTANT NOTES:
+ *  - Refused while the bound arena still has live allocations (used != 0):
+ *    crypto_scratch_free() would no longer recognize those buffers and
+ *    would hand them to free(). Nothing changes and NULL is returned; use
+ *    crypto_arena_task_get() to tell this from "no previous arena"
+ *
+ * @param[in] arena  Arena to bind, or NULL
+ *
+ * @return Previous arena (NULL if none), or NULL if the rebind was refused
+ */
+crypto_arena_t *crypto_arena_task_bind(crypto_arena_t *arena)
+{
+    crypto_arena_t *prev = s_task_arena;
+
+    if (prev != NULL && prev != arena && prev->used != 0) {
+        return NULL;
+    }
+    s_task_arena = arena;
+    return prev;
+}
+
+/**
+ * @brief Temporary buffer for a crypto helper.
+ *
+ * Comes from the calling task's arena; from the heap if the task has no
+ * arena or it is full (counted in crypto_arena_stats_t.fallbacks), so
+ * callers work the same either way.
+ *
+ * @param[in] len  Bytes needed
+ *
+ * @return Buffer, or NULL on out of memory. Give it back with
+ *         crypto_scratch_free(), most recent allocation first.
+ */
+void *crypto_scratch_alloc(size_t len)
+{
+    crypto_arena_t *arena = s_task_arena;
+    void *p = NULL;
+
+    len = len ? len : 1;             // every buffer must lie inside the arena
+    p = crypto_arena_alloc(arena, len);
+    if (p != NULL) {
+        return p;
+    }
+    if (arena != NULL) {
+        arena->fallbacks++;
+    }
+    return malloc(len);
+}
+
+/**
+ * @brief Zeroize and release a buffer from crypto_scratch_alloc() (or any
+ *        malloc()'d buffer that held secrets).
+ *
+ * Arena memory is released back to p (everything allocated after p goes
+ * with it); heap memory is wiped for len bytes and freed.
+ *
+ * @param[in] p    Buffer (NULL is ignored)
+ * @param[in] len  Size that was requested / is in use
+ */
+void crypto_scratch_free(void *p, size_t len)
+{
+    crypto_arena_t *arena = s_task_arena;
+
+    if (p == NULL) {
+        return;
+    }
+
+    uintptr_t addr = (uintptr_t)p;
+    if (arena != NULL && addr >= (uintptr_t)arena->base &&
+        addr < (uintptr_t)arena->base + arena->size) {
+        crypto_arena_release(arena, (size_t)(addr - (uintptr_t)arena->base));
+        return;
+    }
+
+    mbedtls_platform_zeroize(p, len);
+    free(p);
+}
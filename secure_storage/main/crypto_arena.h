@@ -0,0 +1,47 @@
+#ifndef CRYPTO_ARENA_H
+#define CRYPTO_ARENA_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint32_t
+
+/* Scratch arena for crypto temporaries: one block reserved up front, bump
+ * allocation, LIFO release. Everything released is zeroized, so no
+ * plaintext or key material is left behind and the general heap is not
+ * churned by per-call malloc/free. Each task binds its own arena, so no
+ * locking is needed.
+ */
+#define CRYPTO_ARENA_DEFAULT_SIZE  4096
+#define CRYPTO_ARENA_ALIGN         8
+
+typedef struct crypto_arena crypto_arena_t;
+
+typedef struct {
+    size_t size;
+    size_t used;
+    size_t high_water;               // largest 'used' seen since create
+    uint32_t fallbacks;              // crypto_scratch_alloc() served from the heap (arena full)
+} crypto_arena_stats_t;
+
+crypto_arena_t *crypto_arena_create(size_t size);
+void            crypto_arena_destroy(crypto_arena_t *arena);   // zeroizes, NULL is ignored
+
+void  *crypto_arena_alloc(crypto_arena_t *arena, size_t len);   // NULL if it does not fit
+size_t crypto_arena_mark(const crypto_arena_t *arena);
+void   crypto_arena_release(crypto_arena_t *arena, size_t mark);  // zeroizes [mark, used)
+void   crypto_arena_reset(crypto_arena_t *arena);
+void   crypto_arena_get_stats(const crypto_arena_t *arena, crypto_arena_stats_t *out);
+
+// Arena of the calling task (FreeRTOS task or pthread)
+int             crypto_arena_task_init(size_t size);   // create + bind
+void            crypto_arena_task_deinit(void);        // unbind + destroy
+crypto_arena_t *crypto_arena_task_get(void);           // NULL if none bound
+crypto_arena_t *crypto_arena_task_bind(crypto_arena_t *arena);   // previous one, NULL if refused (used != 0)
+
+// Temporaries used by the secure_storage helpers: from the task arena when
+// one is bound and has room, from the heap otherwise. Free in LIFO order.
+// crypto_scratch_free() zeroizes, and also accepts the malloc()'d outputs
+// of aes_cbc_*_pkcs7() / pkcs7_*_16().
+void *crypto_scratch_alloc(size_t len);
+void  crypto_scratch_free(void *p, size_t len);
+
+#endif // CRYPTO_ARENA_H
@@ -0,0 +1,509 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "crypto_service.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <pthread.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#endif
+
+static const char *TAG = "CRYPTO_SVC";
+
+#define CRYPTO_SERVICE_STACK  4096
+#define CRYPTO_SERVICE_PRIO   3       // below Wi-Fi / event tasks: callers must not stall
+#define CRYPTO_SERVICE_CORE   ((portNUM_PROCESSORS > 1) ? 1 : 0)   // APP CPU, Wi-Fi runs on core 0
+
+static crypto_service_stats_t s_stats;
+static bool s_running = false;
+
+/* Execute one job on the service task */
+static void job_run(crypto_job_t *job)
+{
+    job->out_len = 0;
+
+    switch (job->op) {
+    case CRYPTO_OP_CBC_ENCRYPT:
+        job->status = aes_cbc_key_encrypt_pkcs7_into(job->key, job->iv, job->in, job->in_len,
+                                                     job->out, job->out_size, &job->out_len);
+        break;
+    case CRYPTO_OP_CBC_DECRYPT:
+        job->status = aes_cbc_key_decrypt_pkcs7_into(job->key, job->iv, job->in, job->in_len,
+                                                     job->out, job->out_size, &job->out_len);
+        break;
+    default:
+        job->status = -1;
+        break;
+    }
+}
+
+static int job_valid(const crypto_job_t *job)
+{
+    return job != NULL && job->key != NULL &&
+           (job->op == CRYPTO_OP_CBC_ENCRYPT || job->op == CRYPTO_OP_CBC_DECRYPT);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;       // queue + stats
+static pthread_cond_t s_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t s_job_done = PTHREAD_COND_INITIALIZER;     // for crypto_service_wait()
+static pthread_t s_thread;
+static crypto_job_t **s_ring;        // bounded queue of job pointers
+static size_t s_cap, s_head, s_count;
+static bool s_stop;
+
+#define STATS_LOCK()    pthread_mutex_lock(&s_lock)
+#define STATS_UNLOCK()  pthread_mutex_unlock(&s_lock)
+
+static void *service_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&s_lock);
+    for (;;) {
+        while (s_count == 0 && !s_stop) {
+            pthread_cond_wait(&s_not_empty, &s_lock);
+        }
+        if (s_count == 0) {
+            break;                   // stop requested and queue drained
+        }
+        crypto_job_t *job = s_ring[s_head];
+        s_head = (s_head + 1) % s_cap;
+        s_count--;
+        pthread_mutex_unlock(&s_lock);
+
+        job_run(job);
+        int64_t latency = esp_timer_get_time() - job->t_submit_us;
+        if (job->cb != NULL) {
+            job->cb(job);
+        }
+
+        pthread_mutex_lock(&s_lock);
+        s_stats.completed++;
+        s_stats.latency_sum_us += latency;
+        if (latency > s_stats.latency_max_us) {
+            s_stats.latency_max_us = latency;
+        }
+        job->done = 1;
+        pthread_cond_broadcast(&s_job_done);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return NULL;
+}
+
+/**
+ * @brief Start the service thread with a queue of queue_depth jobs.
+ *
+ * @param[in] queue_depth  Max queued jobs (0 = CRYPTO_SERVICE_DEFAULT_DEPTH)
+ *
+ * @return 0 on success (also if already running), -1 on allocation / thread failure
+ */
+int crypto_service_start(size_t queue_depth)
+{
+    pthread_mutex_lock(&s_lock);
+    if (s_running) {
+        pthread_mutex_unlock(&s_lock);
+        return 0;
+    }
+
+    s_cap = queue_depth ? queue_depth : CRYPTO_SERVICE_DEFAULT_DEPTH;
+    s_ring = calloc(s_cap, sizeof(*s_ring));
+    s_head = s_count = 0;
+    s_stop = false;
+    if (s_ring == NULL || pthread_create(&s_thread, NULL, service_thread, NULL) != 0) {
+        free(s_ring);
+        s_ring = NULL;
+        pthread_mutex_unlock(&s_lock);
+        return -1;
+    }
+    s_running = true;
+    pthread_mutex_unlock(&s_lock);
+
+    ESP_LOGI(TAG, "service thread started, queue depth %zu", s_cap);
+    return 0;
+}
+
+/**
+ * @brief Stop the service: queued jobs are still completed, then the thread exits.
+ */
+void crypto_service_stop(void)
+{
+    pthread_mutex_lock(&s_lock);
+    if (!s_running) {
+        pthread_mutex_unlock(&s_lock);
+        return;
+    }
+    s_stop = true;
+    pthread_cond_broadcast(&s_not_empty);
+    pthread_mutex_unlock(&s_lock);
+
+    pthread_join(s_thread, NULL);
+
+    pthread_mutex_lock(&s_lock);
+    free(s_ring);
+    s_ring = NULL;
+    s_running = false;
+    pthread_mutex_unlock(&s_lock);
+}
+
+/**
+ * @brief Queue a job and return immediately.
+ *
+ * @return 0 queued
+ *         -1 invalid job
+ *         -2 queue full (job not queued, counted in stats.rejected)
+ *         -3 service not running
+ */
+int crypto_service_submit(crypto_job_t *job)
+{
+    if (!job_valid(job)) {
+        return -1;
+    }
+
+    job->done = 0;
+    job->t_submit_us = esp_timer_get_time();
+
+    pthread_mutex_lock(&s_lock);
+    if (!s_running || s_stop) {
+        pthread_mutex_unlock(&s_lock);
+        return -3;
+    }
+    if (s_count == s_cap) {
+        s_stats.rejected++;
+        pthread_mutex_unlock(&s_lock);
+        return -2;
+    }
+    s_ring[(s_head + s_count) % s_cap] = job;
+    s_count++;
+    s_stats.submitted++;
+    if (s_count > s_stats.depth_max) {
+        s_stats.depth_max = (uint32_t)s_count;
+    }
+    pthread_cond_signal(&s_not_empty);
+    pthread_mutex_unlock(&s_lock);
+    return 0;
+}
+
+/**
+ * @brief Block the caller until a submitted job has completed.
+ *
+ * @return The job status, or -1 if job is NULL
+ */
+int crypto_service_wait(crypto_job_t *job)
+{
+    if (job == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    while (!job->done) {
+        pthread_cond_wait(&s_job_done, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return job->status;
+}
+
+/**
+ * @brief Number of jobs waiting in the queue.
+ */
+size_t crypto_service_depth(void)
+{
+    pthread_mutex_lock(&s_lock);
+    size_t depth = s_count;
+    pthread_mutex_unlock(&s_lock);
+    return depth;
+}
+
+#else // FreeRTOS
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;   // stats, s_running, s_submitting, job->done
+static QueueHandle_t s_queue = NULL;         // crypto_job_t *, NULL = stop request
+static SemaphoreHandle_t s_stopped = NULL;   // given by the task when it exits
+static TaskHandle_t s_task = NULL;
+static uint32_t s_submitting;                // submit calls past the s_running check
+static bool s_starting;                      // crypto_service_start() is creating the queue / task
+
+#define STATS_LOCK()    taskENTER_CRITICAL(&s_mux)
+#define STATS_UNLOCK()  taskEXIT_CRITICAL(&s_mux)
+
+/* Same shape as worker_task in 8_gp_timers: block, wake up, do the work */
+static void service_task(void *arg)
+{
+    crypto_job_t *job;
+
+    (void)arg;
+    for (;;) {
+        xQueueReceive(s_queue, &job, portMAX_DELAY);
+        if (job == NULL) {
+            break;                   // stop sentinel, queued after all real jobs
+        }
+
+        job_run(job);
+        int64_t latency = esp_timer_get_time() - job->t_submit_us;
+        if (job->cb != NULL) {
+            job->cb(job);
+        }
+
+        /*  notify is read together with done: crypto_service_wait() may
+         *  set it up to the moment done flips */
+        STATS_LOCK();
+        s_stats.completed++;
+        s_stats.latency_sum_us += latency;
+        if (latency > s_stats.latency_max_us) {
+            s_stats.latency_max_us = latency;
+        }
+        TaskHandle_t notify = job->notify;
+        job->done = 1;               // the caller owns the job from here on
+        STATS_UNLOCK();
+
+        if (notify != NULL) {
+            xTaskNotifyGive(notify);
+        }
+    }
+
+    xSemaphoreGive(s_stopped);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Start the service task (pinned to the APP core) with a queue of queue_depth jobs.
+ *
+ * @param[in] queue_depth  Max queued jobs (0 = CRYPTO_SERVICE_DEFAULT_DEPTH)
+ *
+ * @return 0 on success (also if already running), -1 on allocation failure
+ */
+int crypto_service_start(size_t queue_depth)
+{
+    /*  Test-and-set under the lock: two starts must not both create a queue */
+    STATS_LOCK();
+    while (s_starting) {
+        STATS_UNLOCK();
+        vTaskDelay(1);               // another start is creating the queue / task
+        STATS_LOCK();
+    }
+    if (s_running) {
+        STATS_UNLOCK();
+        return 0;
+    }
+    s_starting = true;
+    STATS_UNLOCK();
+
+    if (queue_depth == 0) {
+        queue_depth = CRYPTO_SERVICE_DEFAULT_DEPTH;
+    }
+
+    /*  +1 slot so the stop sentinel always fits behind a full queue */
+    s_queue = xQueueCreate(queue_depth + 1, sizeof(crypto_job_t *));
+    s_stopped = xSemaphoreCreateBinary();
+    if (s_queue == NULL || s_stopped == NULL) {
+        goto fail;
+    }
+
+    if (xTaskCreatePinnedToCore(service_task, "crypto_svc", CRYPTO_SERVICE_STACK, NULL,
+                                CRYPTO_SERVICE_PRIO, &s_task, CRYPTO_SERVICE_CORE) != pdPASS) {
+        goto fail;
+    }
+
+    STATS_LOCK();
+    s_running = true;
+    s_starting = false;
+    STATS_UNLOCK();
+    ESP_LOGI(TAG, "service task started on core %d, queue depth %u",
+             CRYPTO_SERVICE_CORE, (unsigned)queue_depth);
+    return 0;
+
+fail:
+    if (s_queue != NULL) {
+        vQueueDelete(s_queue);
+        s_queue = NULL;
+    }
+    if (s_stopped != NULL) {
+        vSemaphoreDelete(s_stopped);
+        s_stopped = NULL;
+    }
+    STATS_LOCK();
+    s_starting = false;
+    STATS_UNLOCK();
+    return -1;
+}
+
+/**
+ * @brief Stop the service: queued jobs are still completed, then the task exits.
+ *
+ * Submissions already past the running check are waited for, so no job can
+ * land behind the stop sentinel or touch the queue after it is deleted.
+ */
+void crypto_service_stop(void)
+{
+    crypto_job_t *stop = NULL;
+
+    STATS_LOCK();
+    bool running = s_running;
+    s_running = false;               // new submissions get -3
+    STATS_UNLOCK();
+    if (!running) {
+        return;
+    }
+
+    for (;;) {
+        STATS_LOCK();
+        uint32_t busy = s_submitting;
+        STATS_UNLOCK();
+        if (busy == 0) {
+            break;
+        }
+        vTaskDelay(1);               // a submit never blocks, this is at most a tick or two
+    }
+
+    xQueueSend(s_queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(s_stopped, portMAX_DELAY);
+
+    vQueueDelete(s_queue);
+    vSemaphoreDelete(s_stopped);
+    s_queue = NULL;
+    s_stopped = NULL;
+    s_task = NULL;
+}
+
+/**
+ * @brief Queue a job and return immediately (never blocks, not from an ISR).
+ *
+ * Set job->notify to the calling task to be woken with a task notification.
+ *
+ * @return 0 queued
+ *         -1 invalid job
+ *         -2 queue full (job not queued, counted in stats.rejected)
+ *         -3 service not running
+ */
+int crypto_service_submit(crypto_job_t *job)
+{
+    int ret = 0;
+
+    if (!job_valid(job)) {
+        return -1;
+    }
+
+    /*  crypto_service_stop() drains s_submitting before the sentinel goes in */
+    STATS_LOCK();
+    if (!s_running) {
+        STATS_UNLOCK();
+        return -3;
+    }
+    s_submitting++;
+    STATS_UNLOCK();
+
+    job->done = 0;
+    job->t_submit_us = esp_timer_get_time();
+
+    /*  Keep the spare slot for the stop sentinel */
+    if (uxQueueSpacesAvailable(s_queue) <= 1 ||
+        xQueueSend(s_queue, &job, 0) != pdTRUE) {
+        ret = -2;
+    }
+    UBaseType_t depth = uxQueueMessagesWaiting(s_queue);
+
+    STATS_LOCK();
+    if (ret == 0) {
+        s_stats.submitted++;
+        if (depth > s_stats.depth_max) {
+            s_stats.depth_max = (uint32_t)depth;
+        }
+    } else {
+        s_stats.rejected++;
+    }
+    s_submitting--;
+    STATS_UNLOCK();
+    return ret;
+}
+
+/**
+ * @brief Block the caller until a submitted job has completed.
+ *
+ * Sleeps on the task notification. A job submitted with notify == NULL is
+ * switched to the calling task (under the same lock the service task takes
+ * to set done, so the wake-up cannot be missed).
+ *
+ * IMPORTANT NOTES:
+ *  - When the notification targets the calling task, this call consumes it,
+ *    also if the job was already done: do not take it yourself first, and
+ *    no stale count is left for the next ulTaskNotifyTake() of the task.
+ *  - If job->notify is another task, that task gets the notification and
+ *    this call falls back to polling once per tick.
+ *
+ * @return The job status, or -1 if job is NULL
+ */
+int crypto_service_wait(crypto_job_t *job)
+{
+    if (job == NULL) {
+        return -1;
+    }
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool borrowed = false;
+    STATS_LOCK();
+    if (!job->done && job->notify == NULL) {
+        job->notify = self;
+        borrowed = true;
+    }
+    bool notified = (job->notify == self);
+    STATS_UNLOCK();
+
+    if (notified) {
+        /*  The service task gives exactly one notification, right after done
+         *  flips: take it even when done is already set, or it stays pending */
+        do {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } while (!job->done);
+    } else {
+        while (!job->done) {
+            vTaskDelay(1);
+        }
+    }
+    if (borrowed) {
+        job->notify = NULL;          // done: the job is ours again, leave it as submitted
+    }
+    return job->status;
+}
+
+/**
+ * @brief Number of jobs waiting in the queue.
+ */
+size_t crypto_service_depth(void)
+{
+    return (s_queue != NULL) ? (size_t)uxQueueMessagesWaiting(s_queue) : 0;
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
+
+/**
+ * @brief Copy of the counters (queue depth high-water mark, latency).
+ *
+ * Average latency = latency_sum_us / completed.
+ */
+void crypto_service_get_stats(crypto_service_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    STATS_LOCK();
+    *out = s_stats;
+    STATS_UNLOCK();
+}
+
+/**
+ * @brief Zero all counters.
+ */
+void crypto_service_reset_stats(void)
+{
+    STATS_LOCK();
+    s_stats = (crypto_service_stats_t){ 0 };
+    STATS_UNLOCK();
+}
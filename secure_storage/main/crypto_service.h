@@ -0,0 +1,70 @@
+#ifndef CRYPTO_SERVICE_H
+#define CRYPTO_SERVICE_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint32_t, int64_t
+#include "sdkconfig.h"
+#include "aes_cbc.h"  // aes_cbc_key_t
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+/* Asynchronous crypto service: one worker task pinned to the APP core
+ * (a thread on the linux target) fed by a bounded job queue. Submitting
+ * never blocks; completion is signalled by callback and/or task notification.
+ */
+#define CRYPTO_SERVICE_DEFAULT_DEPTH  16
+
+enum {
+    CRYPTO_OP_CBC_ENCRYPT = 1,       // aes_cbc_key_encrypt_pkcs7_into()
+    CRYPTO_OP_CBC_DECRYPT = 2,       // aes_cbc_key_decrypt_pkcs7_into()
+};
+
+typedef struct crypto_job crypto_job_t;
+typedef void (*crypto_job_cb_t)(crypto_job_t *job);
+
+/* Caller-owned job, must stay valid until it completes */
+struct crypto_job {
+    /* request */
+    int op;                          // CRYPTO_OP_*
+    const aes_cbc_key_t *key;
+    uint8_t iv[16];
+    const uint8_t *in;
+    size_t in_len;
+    uint8_t *out;
+    size_t out_size;
+    crypto_job_cb_t cb;              // runs on the service task, may be NULL
+    void *user;                      // free for the caller (e.g. for cb)
+#if !CONFIG_IDF_TARGET_LINUX
+    TaskHandle_t notify;             // gets xTaskNotifyGive() on completion, may be NULL
+#endif
+    /* result */
+    size_t out_len;
+    int status;                      // return code of the crypto call
+    volatile int done;               // set last; the job may be reused afterwards
+    /* private */
+    int64_t t_submit_us;
+};
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t rejected;               // queue full
+    uint32_t depth_max;              // high-water mark of the queue
+    int64_t  latency_sum_us;         // submit -> completion
+    int64_t  latency_max_us;
+} crypto_service_stats_t;
+
+int  crypto_service_start(size_t queue_depth);
+void crypto_service_stop(void);      // finishes the queued jobs first
+
+int  crypto_service_submit(crypto_job_t *job);
+int  crypto_service_wait(crypto_job_t *job);     // block until job->done
+
+void   crypto_service_get_stats(crypto_service_stats_t *out);
+void   crypto_service_reset_stats(void);
+size_t crypto_service_depth(void);  // jobs waiting right now
+
+#endif // CRYPTO_SERVICE_H
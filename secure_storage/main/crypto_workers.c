@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "crypto_workers.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <pthread.h>
+#include <unistd.h>              // sysconf()
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#endif
+
+static const char *TAG = "CRYPTO_W";
+
+#define CRYPTO_WORKER_STACK   4096
+#define CRYPTO_WORKER_PRIO    5
+
+typedef struct {
+    crypto_work_fn_t fn;             // job of the current batch
+    void *arg;
+    bool stop;                       // ask the worker to exit
+#if CONFIG_IDF_TARGET_LINUX
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool pending;                    // job posted, not finished yet
+#else
+    TaskHandle_t task;
+    SemaphoreHandle_t done;          // given by the worker when the job is finished
+#endif
+} crypto_worker_t;
+
+static crypto_worker_t s_workers[CRYPTO_WORKERS_MAX];
+static size_t s_count = 0;
+
+#if CONFIG_IDF_TARGET_LINUX
+
+static pthread_mutex_t s_run_lock = PTHREAD_MUTEX_INITIALIZER;   // one batch at a time
+
+static void *worker_thread(void *arg)
+{
+    crypto_worker_t *w = (crypto_worker_t *)arg;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->pending && !w->stop) {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        if (w->stop) {
+            break;
+        }
+        pthread_mutex_unlock(&w->lock);
+
+        w->fn(w->arg);
+
+        pthread_mutex_lock(&w->lock);
+        w->pending = false;
+        pthread_cond_broadcast(&w->cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+/**
+ * @brief Start one worker thread per online CPU (max CRYPTO_WORKERS_MAX).
+ *
+ * @return 0 on success (also if already started), -1 if no thread could be created
+ */
+int crypto_workers_start(void)
+{
+    pthread_mutex_lock(&s_run_lock);
+    if (s_count > 0) {
+        pthread_mutex_unlock(&s_run_lock);
+        return 0;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = (cpus < 1) ? 1 : (size_t)cpus;
+    if (wanted > CRYPTO_WORKERS_MAX) {
+        wanted = CRYPTO_WORKERS_MAX;
+    }
+
+    for (size_t i = 0; i < wanted; i++) {
+        crypto_worker_t *w = &s_workers[i];
+        w->stop = false;
+        w->pending = false;
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->cond, NULL);
+        if (pthread_create(&w->thread, NULL, worker_thread, w) != 0) {
+            pthread_cond_destroy(&w->cond);
+            pthread_mutex_destroy(&w->lock);
+            break;
+        }
+        s_count++;
+    }
+    pthread_mutex_unlock(&s_run_lock);
+
+    ESP_LOGI(TAG, "%zu worker thread(s) started", s_count);
+    return (s_count > 0) ? 0 : -1;
+}
+
+/**
+ * @brief Stop and join all worker threads.
+ */
+void crypto_workers_stop(void)
+{
+    pthread_mutex_lock(&s_run_lock);
+    for (size_t i = 0; i < s_count; i++) {
+        crypto_worker_t *w = &s_workers[i];
+        pthread_mutex_lock(&w->lock);
+        w->stop = true;
+        pthread_cond_broadcast(&w->cond);
+        pthread_mutex_unlock(&w->lock);
+        pthread_join(w->thread, NULL);
+        pthread_cond_destroy(&w->cond);
+        pthread_mutex_destroy(&w->lock);
+    }
+    s_count = 0;
+    pthread_mutex_unlock(&s_run_lock);
+}
+
+/**
+ * @brief Run fn(args[i]) on worker i (i < n) and block until all are done.
+ *
+ * IMPORTANT: must not be called from inside a job (it would deadlock).
+ *
+ * @return 0 on success, -1 invalid args / n larger than the pool
+ */
+int crypto_workers_run(crypto_work_fn_t fn, void *const args[], size_t n)
+{
+    if (fn == NULL || args == NULL || n == 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&s_run_lock);
+    if (n > s_count) {
+        pthread_mutex_unlock(&s_run_lock);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        crypto_worker_t *w = &s_workers[i];
+        pthread_mutex_lock(&w->lock);
+        w->fn = fn;
+        w->arg = args[i];
+        w->pending = true;
+        pthread_cond_broadcast(&w->cond);
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        crypto_worker_t *w = &s_workers[i];
+        pthread_mutex_lock(&w->lock);
+        while (w->pending) {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    pthread_mutex_unlock(&s_run_lock);
+    return 0;
+}
+
+#else // FreeRTOS
+
+static SemaphoreHandle_t s_run_lock = NULL;                      // one batch at a time
+
+static void worker_task(void *arg)
+{
+    crypto_worker_t *w = (crypto_worker_t *)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (w->stop) {
+            break;
+        }
+        w->fn(w->arg);
+        xSemaphoreGive(w->done);
+    }
+
+    xSemaphoreGive(w->done);         // acknowledge the stop request
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Start one worker task pinned to each core.
+ *
+ * @return 0 on success (also if already started), -1 on allocation failure
+ */
+int crypto_workers_start(void)
+{
+    if (s_run_lock == NULL) {
+        s_run_lock = xSemaphoreCreateMutex();
+        if (s_run_lock == NULL) {
+            return -1;
+        }
+    }
+
+    xSemaphoreTake(s_run_lock, portMAX_DELAY);
+    if (s_count > 0) {
+        xSemaphoreGive(s_run_lock);
+        return 0;
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS && core < CRYPTO_WORKERS_MAX; core++) {
+        crypto_worker_t *w = &s_workers[s_count];
+        char name[configMAX_TASK_NAME_LEN];
+
+        w->stop = false;
+        w->done = xSemaphoreCreateBinary();
+        if (w->done == NULL) {
+            break;
+        }
+
+        snprintf(name, sizeof(name), "crypto_w%d", core);
+        if (xTaskCreatePinnedToCore(worker_task, name, CRYPTO_WORKER_STACK, w,
+                                    CRYPTO_WORKER_PRIO, &w->task, core) != pdPASS) {
+            vSemaphoreDelete(w->done);
+            break;
+        }
+        s_count++;
+    }
+    xSemaphoreGive(s_run_lock);
+
+    ESP_LOGI(TAG, "%u worker task(s) started", (unsigned)s_count);
+    return (s_count > 0) ? 0 : -1;
+}
+
+/**
+ * @brief Stop all worker tasks (waits until each one acknowledged).
+ */
+void crypto_workers_stop(void)
+{
+    if (s_run_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_run_lock, portMAX_DELAY);
+    for (size_t i = 0; i < s_count; i++) {
+        crypto_worker_t *w = &s_workers[i];
+        w->stop = true;
+        xTaskNotifyGive(w->task);
+        xSemaphoreTake(w->done, portMAX_DELAY);
+        vSemaphoreDelete(w->done);
+    }
+    s_count = 0;
+    xSemaphoreGive(s_run_lock);
+}
+
+/**
+ * @brief Run fn(args[i]) on worker i (i < n) and block until all are done.
+ *
+ * IMPORTANT: must not be called from inside a job (it would deadlock).
+ *
+ * @return 0 on success, -1 invalid args / n larger than the pool
+ */
+int crypto_workers_run(crypto_work_fn_t fn, void *const args[], size_t n)
+{
+    if (fn == NULL || args == NULL || n == 0 || s_run_lock == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(s_run_lock, portMAX_DELAY);
+    if (n > s_count) {
+        xSemaphoreGive(s_run_lock);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        s_workers[i].fn = fn;
+        s_workers[i].arg = args[i];
+        xTaskNotifyGive(s_workers[i].task);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        xSemaphoreTake(s_workers[i].done, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(s_run_lock);
+    return 0;
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
+
+/**
+ * @brief Number of running workers (0 before crypto_workers_start()).
+ */
+size_t crypto_workers_count(void)
+{
+    return s_count;
+}
@@ -0,0 +1,21 @@
+#ifndef CRYPTO_WORKERS_H
+#define CRYPTO_WORKERS_H
+
+#include <stddef.h>   // size_t
+
+/* Small pool of crypto worker tasks, one pinned to each core
+ * (one pthread per CPU, up to CRYPTO_WORKERS_MAX, on the linux target).
+ * Used to split bulk operations at block boundaries.
+ */
+#define CRYPTO_WORKERS_MAX 8
+
+typedef void (*crypto_work_fn_t)(void *arg);
+
+int    crypto_workers_start(void);
+void   crypto_workers_stop(void);
+size_t crypto_workers_count(void);
+
+// Run fn(args[i]) on worker i for i < n (n <= count) and wait for all of them
+int    crypto_workers_run(crypto_work_fn_t fn, void *const args[], size_t n);
+
+#endif // CRYPTO_WORKERS_H
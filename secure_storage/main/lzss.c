@@ -0,0 +1,183 @@
+#include <string.h>
+#include "lzss.h"
+
+static inline uint32_t lzss_hash(const uint8_t *p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - LZSS_HASH_BITS);
+}
+
+/**
+ * @brief Compress in with greedy LZSS (one candidate per hash bucket).
+ *
+ * Meant for small, repetitive records (config JSON, telemetry text): no
+ * heap and 2 KB of caller-provided state. Matches are searched in the
+ * input itself (the last LZSS_WINDOW bytes of in), never in out. Tokens
+ * are grouped by 8 behind one flag byte (bit i set = literal, clear =
+ * match):
+ *
+ *     literal: 1 byte
+ *     match:   2 bytes, (offset - 1) << 4 | (length - 3), big-endian
+ *
+ * IMPORTANT NOTES:
+ *  - out_size < LZSS_BOUND(in_len) is allowed: the call stops with -2 as
+ *    soon as the output would not fit. Passing in_len - 1 is the cheap way
+ *    to ask "compress only if it saves something"
+ *  - The stream has no length header; the container stores its length
+ *  - in and out must not overlap
+ *
+ * @param[in,out] work      Hash table, any content (reset here)
+ * @param[in]     in        Input bytes
+ * @param[in]     in_len    Input length in bytes
+ * @param[out]    out       Compressed stream
+ * @param[in]     out_size  Output buffer size in bytes
+ * @param[out]    out_len   Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output does not fit in out_size
+ */
+int lzss_compress(lzss_work_t *work, const uint8_t *in, size_t in_len,
+                  uint8_t *out, size_t out_size, size_t *out_len)
+{
+    size_t i = 0;
+    size_t o = 0;
+    size_t flag_pos = 0;
+    unsigned bit = 8;                // tokens in the current group
+
+    if (work == NULL || (in == NULL && in_len != 0) || out == NULL || out_len == NULL) {
+        return -1;
+    }
+
+    /*  Empty bucket = 0xFFFF: gives off = i + 1 below, which is always rejected */
+    memset(work->head, 0xFF, sizeof(work->head));
+
+    while (i < in_len) {
+        size_t best_len = 0;
+        size_t best_off = 0;
+
+        if (bit == 8) {              // new group: reserve its flag byte
+            if (o >= out_size) {
+                return -2;
+            }
+            flag_pos = o++;
+            out[flag_pos] = 0;
+            bit = 0;
+        }
+
+        if (in_len - i >= LZSS_MIN_MATCH) {
+            uint32_t h = lzss_hash(in + i);
+            /*  Positions are kept modulo 2^16; the byte compare below
+             *  confirms the candidate, so a stale entry only costs a miss.
+             */
+            size_t off = (uint16_t)((uint16_t)i - work->head[h]);
+            work->head[h] = (uint16_t)i;
+
+            if (off > 0 && off <= LZSS_WINDOW && off <= i) {
+                const uint8_t *cand = in + i - off;
+                size_t max = in_len - i;
+                size_t n = 0;
+
+                if (max > LZSS_MAX_MATCH) {
+                    max = LZSS_MAX_MATCH;
+                }
+                while (n < max && cand[n] == in[i + n]) {
+                    n++;
+                }
+                if (n >= LZSS_MIN_MATCH) {
+                    best_len = n;
+                    best_off = off;
+                }
+            }
+        }
+
+        if (best_len > 0) {
+            if (out_size - o < 2) {
+                return -2;
+            }
+            uint16_t tok = (uint16_t)(((best_off - 1) << 4) | (best_len - LZSS_MIN_MATCH));
+            out[o++] = (uint8_t)(tok >> 8);
+            out[o++] = (uint8_t)tok;
+
+            /*  Index the covered positions too: repeated runs stay findable */
+            for (size_t k = i + 1; k < i + best_len && in_len - k >= LZSS_MIN_MATCH; k++) {
+                work->head[lzss_hash(in + k)] = (uint16_t)k;
+            }
+            i += best_len;
+        } else {
+            if (o >= out_size) {
+                return -2;
+            }
+            out[flag_pos] |= (uint8_t)(1u << bit);
+            out[o++] = in[i++];
+        }
+        bit++;
+    }
+
+    *out_len = o;
+    return 0;
+}
+
+/**
+ * @brief Expand a stream produced by lzss_compress().
+ *
+ * Every match is checked against the bytes already produced, so a corrupt
+ * or hostile stream can neither read before out nor write past out_size.
+ *
+ * @param[in]  in        Compressed stream
+ * @param[in]  in_len    Stream length in bytes
+ * @param[out] out       Decompressed data
+ * @param[in]  out_size  Output buffer size in bytes
+ * @param[out] out_len   Bytes written to out
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small
+ *         -3 corrupt stream (offset before start of output / truncated match)
+ */
+int lzss_decompress(const uint8_t *in, size_t in_len,
+                    uint8_t *out, size_t out_size, size_t *out_len)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    if ((in == NULL && in_len != 0) || out == NULL || out_len == NULL) {
+        return -1;
+    }
+
+    while (i < in_len) {
+        uint8_t flags = in[i++];
+
+        for (unsigned bit = 0; bit < 8 && i < in_len; bit++) {
+            if (flags & (1u << bit)) {
+                if (o >= out_size) {
+                    return -2;
+                }
+                out[o++] = in[i++];
+                continue;
+            }
+
+            if (in_len - i < 2) {
+                return -3;
+            }
+            uint16_t tok = (uint16_t)((in[i] << 8) | in[i + 1]);
+            size_t off = (size_t)(tok >> 4) + 1;
+            size_t len = (size_t)(tok & 0x0F) + LZSS_MIN_MATCH;
+            i += 2;
+
+            if (off > o) {
+                return -3;
+            }
+            if (out_size - o < len) {
+                return -2;
+            }
+            /*  Byte by byte on purpose: off < len repeats the last bytes */
+            for (size_t k = 0; k < len; k++, o++) {
+                out[o] = out[o - off];
+            }
+        }
+    }
+
+    *out_len = o;
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint16_t
+
+// LZSS with a 4 KB window: 12-bit offset, 4-bit length (3..18), one flag
+// byte per 8 tokens. Decompression needs no memory besides the output.
+#define LZSS_WINDOW      4096
+#define LZSS_MIN_MATCH   3
+#define LZSS_MAX_MATCH   18
+#define LZSS_HASH_BITS   10
+
+// Worst case (nothing matches): every byte a literal + one flag byte per 8
+#define LZSS_BOUND(len)  ((len) + ((len) + 7) / 8)
+
+/* Compressor state: last position seen per 3-byte hash (2 KB, caller memory) */
+typedef struct {
+    uint16_t head[1u << LZSS_HASH_BITS];
+} lzss_work_t;
+
+int lzss_compress(lzss_work_t *work, const uint8_t *in, size_t in_len,
+                  uint8_t *out, size_t out_size, size_t *out_len);
+
+int lzss_decompress(const uint8_t *in, size_t in_len,
+                    uint8_t *out, size_t out_size, size_t *out_len);
+
+#endif // LZSS_H
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "esp_log.h"
 #include "esp_system.h"          // esp_fill_random()
+#include "pkcs_7.h"
 #define AES_BLOCK_SIZE 16 
 
 /**
@@ -19,7 +20,8 @@
  *
  * Memory:
  *   - Output buffer is dynamically allocated
- *   - Caller is responsible for calling free()
+ *   - Caller is responsible for calling free() (crypto_scratch_free()
+ *     wipes the padded plaintext first)
  *
  * @param[in]  input        Pointer to input data
  * @param[in]  input_len    Length of input data in bytes
@@ -93,13 +95,129 @@ int pkcs7_pad_16(const uint8_t *input, size_t input_len,
 }
 
 
+/**
+ * @brief Build the final PKCS#7 padded block for AES-CBC.
+ *
+ * Only the last partial block of a message ever needs padding, so instead
+ * of copying the whole plaintext (what pkcs7_pad_16 does) the caller can
+ * encrypt every full block straight from its own buffer and use this
+ * function for the tail only.
+ *
+ * Example: tail_len = 5 -> block = t0 t1 t2 t3 t4 0B 0B ... 0B (11 x 0x0B)
+ *          tail_len = 0 -> block = 10 10 ... 10 (a full block of padding)
+ *
+ * Memory:
+ *   - No allocation, the block lives in caller memory (usually the stack)
+ *
+ * @param[in]  tail       Last (message_len % 16) bytes of the message
+ * @param[in]  tail_len   Number of tail bytes, must be 0..15
+ * @param[out] block      16-byte block that receives tail + padding
+ *
+ * @return 0 on success
+ * @return -1 invalid parameters
+ */
+int pkcs7_pad_block_16(const uint8_t *tail, size_t tail_len,
+                       uint8_t block[AES_BLOCK_SIZE])
+{
+    if (block == NULL || tail_len >= AES_BLOCK_SIZE ||
+        (tail == NULL && tail_len != 0)) {
+        return -1;
+    }
+
+    size_t padding_len = AES_BLOCK_SIZE - tail_len;   // 1..16, never 0
+
+    if (tail_len != 0) {
+        memcpy(block, tail, tail_len);
+    }
+    memset(block + tail_len, (uint8_t)padding_len, padding_len);
+
+    return 0;
+}
+
+
+/**
+ * @brief Validate PKCS#7 padding in place and return the unpadded length.
+ *
+ * Same checks as pkcs7_unpad_16, but nothing is copied: the plaintext is
+ * simply the first *output_len bytes of input.
+ *
+ * Constant time: the last block is checked as four 32-bit words with
+ * masks, so the running time does not depend on the padding value or on
+ * where a mismatch is. An early-exit byte loop would tell an attacker how
+ * many padding bytes were right (padding oracle on AES-CBC).
+ *
+ *   mask byte j = 0xFF where j >= 16 - pad, i.e. where (j + pad) >= 16,
+ *   which is bit 4 of the byte-wise sum j + pad (no carries for pad <= 16)
+ *
+ * Both the index vector and the data are loaded the same way, so the
+ * check does not depend on the CPU byte order.
+ *
+ * IMPORTANT NOTES:
+ *  - Only the length checks (public values) branch
+ *  - A wrong padding length and wrong padding bytes give the same error
+ *
+ * @param[in]  input       Decrypted data that still contains PKCS#7 padding
+ * @param[in]  input_len   Length of input in bytes (must be multiple of 16)
+ * @param[out] output_len  Plaintext length (without padding), 0 on error
+ *
+ * @return  0  Success
+ * @return -1  Invalid arguments (NULL pointers)
+ * @return -2  Invalid length (0 or not multiple of 16)
+ * @return -3  Invalid padding (length byte not 1..16 or bytes do not match)
+ */
+int pkcs7_unpad_16_inplace(const uint8_t *input, size_t input_len,
+                           size_t *output_len)
+{
+    static const uint8_t index[AES_BLOCK_SIZE] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+    };
+    uint32_t data[4];
+    uint32_t idx[4];
+    uint32_t bad = 0;
+
+    // Basic argument validation
+    if (input == NULL || output_len == NULL) {
+        return -1;
+    }
+
+    // AES-CBC plaintext after decryption must be block-aligned (16 bytes)
+    if (input_len == 0 || (input_len % AES_BLOCK_SIZE) != 0) {
+        return -2;
+    }
+
+    memcpy(data, input + input_len - AES_BLOCK_SIZE, sizeof(data));
+    memcpy(idx, index, sizeof(idx));
+
+    // The last byte indicates how many padding bytes were added (PKCS#7)
+    uint32_t pad = input[input_len - 1];
+
+    // Valid length is 1..16: (pad - 1) must not have any bit above bit 3
+    bad |= (pad - 1) & ~(uint32_t)0x0F;
+
+    uint32_t pad4 = pad * 0x01010101u;                   // pad in every byte
+    for (int w = 0; w < 4; w++) {
+        uint32_t sum  = idx[w] + (pad4 & 0x1F1F1F1Fu);   // <= 15 + 31 per byte, no carry
+        uint32_t mask = ((sum >> 4) & 0x01010101u) * 0xFFu;
+        bad |= (data[w] ^ pad4) & mask;
+    }
+
+    // bad != 0 -> all ones, bad == 0 -> 0 (no branch on the padding)
+    uint32_t fail = (uint32_t)0 - ((bad | ((uint32_t)0 - bad)) >> 31);
+
+    *output_len = (input_len - (size_t)pad) & ~(size_t)(int32_t)fail;
+
+    return (int)(fail & (uint32_t)-3);
+}
+
+
 /**
  * @brief Remove PKCS#7 padding for AES (16-byte block size).
  *
  * Input must be a multiple of 16 bytes (AES block size).
  * Valid PKCS#7 padding values for AES: 1..16.
  *
- * Output buffer is allocated with malloc; caller must free().
+ * Output buffer is allocated with malloc; caller must free() (or use
+ * crypto_scratch_free(), which wipes the plaintext first).
  *
  * @param[in]  input       Decrypted data that still contains PKCS#7 padding
  * @param[in]  input_len   Length of input in bytes (must be multiple of 16)
@@ -109,8 +227,7 @@ int pkcs7_pad_16(const uint8_t *input, size_t input_len,
  * @return  0  Success
  * @return -1  Invalid arguments (NULL pointers)
  * @return -2  Invalid length (0 or not multiple of 16)
- * @return -3  Invalid padding length byte (must be 1..16)
- * @return -4  Padding bytes do not match expected PKCS#7 pattern
+ * @return -3  Invalid padding (same code for every kind of mismatch)
  * @return -5  Memory allocation failure
  */
 int pkcs7_unpad_16(const uint8_t *input,
@@ -123,30 +240,13 @@ int pkcs7_unpad_16(const uint8_t *input,
         return -1;
     }
 
-    // AES-CBC plaintext after decryption must be block-aligned (16 bytes)
-    if (input_len == 0 || (input_len % AES_BLOCK_SIZE) != 0) {
-        return -2;
-    }
-
-    // The last byte indicates how many padding bytes were added (PKCS#7)
-    uint8_t pad = input[input_len - 1];
-
-    // For AES block size 16, valid padding length is 1..16
-    if (pad == 0 || pad > AES_BLOCK_SIZE) {
-        return -3;
-    }
-
-    //Validate that the last 'pad' bytes all equal 'pad'
-    //    Example: if pad=0x04, the last 4 bytes must be 04 04 04 04
-    for (size_t i = 0; i < (size_t)pad; i++) {
-        if (input[input_len - 1 - i] != pad) {
-            return -4;
-        }
+    // Validate length and padding, get the length without padding
+    size_t plain_len = 0;
+    int ret = pkcs7_unpad_16_inplace(input, input_len, &plain_len);
+    if (ret != 0) {
+        return ret;
     }
 
-    // Compute length without padding
-    size_t plain_len = input_len - (size_t)pad;
-
     // Allocate output (+1 optional null terminator for debugging prints)
     uint8_t *buf = (uint8_t *)malloc(plain_len + 1);
     if (buf == NULL) {
@@ -10,6 +10,13 @@ int pkcs7_pad_16(const uint8_t *input, size_t input_len,
 int pkcs7_unpad_16(const uint8_t *input, size_t input_len,
                    uint8_t **output, size_t *output_len);
 
+// Zero-copy variants (no malloc): pad only the last block / unpad in place
+int pkcs7_pad_block_16(const uint8_t *tail, size_t tail_len,
+                       uint8_t block[16]);
+
+int pkcs7_unpad_16_inplace(const uint8_t *input, size_t input_len,
+                           size_t *output_len);
+
 
 
 #endif // PKCS_7_H
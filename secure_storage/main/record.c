@@ -0,0 +1,222 @@
+#include <string.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "record.h"
+
+static void put_be16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief Lay out a record in out and return where the ciphertext and tag go.
+ *
+ * Writes everything except the ciphertext and tag bytes, so an encrypt
+ * function can write its output directly into the record (no staging
+ * buffer, no copy). Example with AES-CBC:
+ *
+ *     record_write_begin(buf, sizeof(buf), RECORD_ALG_AES_CBC_PKCS7, 0, 1, iv, 16,
+ *                        AES_CBC_PKCS7_CIPHERTEXT_LEN(len), 0, &ct, NULL, &rec_len);
+ *     aes_cbc_encrypt_pkcs7_into(key, 256, iv, pt, len, ct, ct_size, &ct_len);
+ *
+ * IMPORTANT NOTES:
+ *  - ct_len must be the exact final ciphertext length (known up front for
+ *    every mode here, e.g. AES_CBC_PKCS7_CIPHERTEXT_LEN())
+ *  - iv may point into out at the IV position (it is then not copied twice)
+ *
+ * @param[out] out       Output buffer
+ * @param[in]  out_size  Output buffer size in bytes
+ * @param[in]  alg       RECORD_ALG_*
+ * @param[in]  flags     RECORD_FLAG_LZSS or 0 (RECORD_FLAG_TAG is set from tag_len)
+ * @param[in]  key_id    Key identifier stored in clear
+ * @param[in]  iv        IV / nonce (may be NULL if iv_len == 0)
+ * @param[in]  iv_len    0..RECORD_MAX_IV_LEN
+ * @param[in]  ct_len    Ciphertext length in bytes (< 4 GiB)
+ * @param[in]  tag_len   0 (no tag) .. RECORD_MAX_TAG_LEN
+ * @param[out] ct_out    Where the ciphertext must be written
+ * @param[out] tag_out   Where the tag must be written (may be NULL if tag_len == 0)
+ * @param[out] rec_len   Total record length, RECORD_LEN(iv_len, ct_len, tag_len)
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small
+ *         -4 iv_len / tag_len / ct_len out of range, unknown flags
+ */
+int record_write_begin(uint8_t *out, size_t out_size, uint8_t alg, uint8_t flags, uint16_t key_id,
+                       const uint8_t *iv, size_t iv_len, size_t ct_len, size_t tag_len,
+                       uint8_t **ct_out, uint8_t **tag_out, size_t *rec_len)
+{
+    if (out == NULL || ct_out == NULL || rec_len == NULL ||
+        (iv == NULL && iv_len != 0) || (tag_out == NULL && tag_len != 0)) {
+        return -1;
+    }
+    if (iv_len > RECORD_MAX_IV_LEN || tag_len > RECORD_MAX_TAG_LEN ||
+        (flags & ~RECORD_FLAGS_KNOWN) != 0) {
+        return -4;
+    }
+#if SIZE_MAX > UINT32_MAX
+    if (ct_len > UINT32_MAX) {
+        return -4;
+    }
+#endif
+
+    // Header + tag first, then ct_len against what is left (RECORD_LEN() could wrap)
+    size_t overhead = RECORD_LEN(iv_len, 0, tag_len);
+    if (out_size < overhead || ct_len > out_size - overhead) {
+        return -2;
+    }
+    size_t total = overhead + ct_len;
+
+    uint8_t *p = out;
+    *p++ = RECORD_MAGIC;
+    *p++ = RECORD_VERSION;
+    *p++ = alg;
+    *p++ = (uint8_t)((flags & ~RECORD_FLAG_TAG) | (tag_len ? RECORD_FLAG_TAG : 0));
+    put_be16(p, key_id);
+    p += 2;
+    *p++ = (uint8_t)iv_len;
+    if (iv_len > 0 && iv != p) {
+        memmove(p, iv, iv_len);
+    }
+    p += iv_len;
+    put_be32(p, (uint32_t)ct_len);
+    p += 4;
+
+    *ct_out = p;
+    p += ct_len;
+    if (tag_len > 0) {
+        *p++ = (uint8_t)tag_len;
+        *tag_out = p;
+    } else if (tag_out != NULL) {
+        *tag_out = NULL;
+    }
+
+    *rec_len = total;
+    return 0;
+}
+
+/**
+ * @brief Serialize a record whose ciphertext / tag already exist.
+ *
+ * @param[in]  rec       Fields to write (rec->version is ignored, RECORD_VERSION is written)
+ * @param[out] out       Output buffer (must not overlap rec->ct / rec->tag)
+ * @param[in]  out_size  Output buffer size in bytes
+ * @param[out] rec_len   Bytes written
+ *
+ * @return Same codes as record_write_begin()
+ */
+int record_write(const record_view_t *rec, uint8_t *out, size_t out_size, size_t *rec_len)
+{
+    uint8_t *ct = NULL;
+    uint8_t *tag = NULL;
+    int ret;
+
+    if (rec == NULL || (rec->ct == NULL && rec->ct_len != 0) ||
+        (rec->tag == NULL && rec->tag_len != 0)) {
+        return -1;
+    }
+
+    ret = record_write_begin(out, out_size, rec->alg, rec->flags, rec->key_id,
+                             rec->iv, rec->iv_len, rec->ct_len, rec->tag_len,
+                             &ct, &tag, rec_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (rec->ct_len > 0) {
+        memcpy(ct, rec->ct, rec->ct_len);
+    }
+    if (rec->tag_len > 0) {
+        memcpy(tag, rec->tag, rec->tag_len);
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse the record at the start of in (zero-copy).
+ *
+ * Every length is checked against the bytes actually available before it
+ * is used, so a truncated or corrupted record never makes a view point
+ * past in + in_len. The views stay valid as long as in does.
+ *
+ * IMPORTANT NOTES:
+ *  - The header is NOT authenticated by the container itself: pass the
+ *    header bytes as AAD to an AEAD mode if alg / key_id must be bound
+ *  - Unknown alg values are returned as-is; the caller decides
+ *
+ * @param[in]  in        Input bytes
+ * @param[in]  in_len    Input length in bytes
+ * @param[out] rec       Views into in
+ * @param[out] consumed  Length of this record (may be NULL); records can be
+ *                       stored back-to-back and parsed in a loop
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 truncated record
+ *         -3 bad magic / unsupported version / unknown flags
+ */
+int record_parse(const uint8_t *in, size_t in_len, record_view_t *rec, size_t *consumed)
+{
+    size_t off = 0;
+
+    if (in == NULL || rec == NULL) {
+        return -1;
+    }
+    if (in_len < 7) {
+        return -2;
+    }
+    if (in[0] != RECORD_MAGIC || in[1] != RECORD_VERSION || (in[3] & ~RECORD_FLAGS_KNOWN) != 0) {
+        return -3;
+    }
+
+    rec->version = in[1];
+    rec->alg = in[2];
+    rec->flags = in[3];
+    rec->key_id = (uint16_t)((in[4] << 8) | in[5]);
+    rec->iv_len = in[6];
+    off = 7;
+
+    if (in_len - off < rec->iv_len + 4) {
+        return -2;
+    }
+    rec->iv = rec->iv_len ? in + off : NULL;
+    off += rec->iv_len;
+
+    rec->ct_len = get_be32(in + off);
+    off += 4;
+    if (in_len - off < rec->ct_len) {
+        return -2;
+    }
+    rec->ct = in + off;
+    off += rec->ct_len;
+
+    rec->tag = NULL;
+    rec->tag_len = 0;
+    if (in[3] & RECORD_FLAG_TAG) {
+        if (in_len - off < 1 || in_len - off - 1 < in[off]) {
+            return -2;
+        }
+        rec->tag_len = in[off];
+        rec->tag = in + off + 1;
+        off += 1 + rec->tag_len;
+    }
+
+    if (consumed != NULL) {
+        *consumed = off;
+    }
+    return 0;
+}
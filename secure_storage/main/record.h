@@ -0,0 +1,58 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint16_t
+#include "aead.h"     // AEAD_ALG_* (same numbering)
+
+/* Self-describing encrypted record (all integers big-endian):
+ *
+ *   magic(1) version(1) alg(1) flags(1) key_id(2) iv_len(1) iv[iv_len]
+ *   ct_len(4) ct[ct_len] [tag_len(1) tag[tag_len]]   (tag if RECORD_FLAG_TAG)
+ */
+#define RECORD_MAGIC      0xE5
+#define RECORD_VERSION    1
+#define RECORD_FLAG_TAG   0x01   // tag_len + tag follow the ciphertext
+#define RECORD_FLAG_LZSS  0x02   // plaintext was LZSS-compressed before encryption
+#define RECORD_FLAGS_KNOWN (RECORD_FLAG_TAG | RECORD_FLAG_LZSS)
+
+#define RECORD_ALG_AES_GCM            AEAD_ALG_AES_GCM
+#define RECORD_ALG_CHACHA20_POLY1305  AEAD_ALG_CHACHA20_POLY1305
+#define RECORD_ALG_AES_CBC_PKCS7      0x10   // aes_cbc_*_pkcs7()
+#define RECORD_ALG_AES_CBC_CS3        0x11   // aes_cbc_cs3_*()
+#define RECORD_ALG_AES_CBC_HMAC       0x12   // aes_cbc_hmac_*(), tag = HMAC-SHA256
+#define RECORD_ALG_AES_CTR            0x13   // aes_ctr_*()
+
+#define RECORD_MAX_IV_LEN   255
+#define RECORD_MAX_TAG_LEN  255
+
+// Serialized size of a record
+#define RECORD_LEN(iv_len, ct_len, tag_len) \
+    (7 + (size_t)(iv_len) + 4 + (size_t)(ct_len) + ((tag_len) ? 1 + (size_t)(tag_len) : 0))
+
+/* Parsed record: views into the input buffer, nothing is copied */
+typedef struct {
+    uint8_t version;
+    uint8_t alg;                     // RECORD_ALG_*
+    uint8_t flags;                   // RECORD_FLAG_* (TAG is derived from tag_len on write)
+    uint16_t key_id;                 // which key (slot / NVS key name index)
+    const uint8_t *iv;
+    size_t iv_len;
+    const uint8_t *ct;
+    size_t ct_len;
+    const uint8_t *tag;              // NULL if the record has no tag
+    size_t tag_len;
+} record_view_t;
+
+// Header + IV, then the cipher writes straight into *ct_out / *tag_out
+int record_write_begin(uint8_t *out, size_t out_size, uint8_t alg, uint8_t flags, uint16_t key_id,
+                       const uint8_t *iv, size_t iv_len, size_t ct_len, size_t tag_len,
+                       uint8_t **ct_out, uint8_t **tag_out, size_t *rec_len);
+
+// Same with ciphertext / tag that already exist (copied in)
+int record_write(const record_view_t *rec, uint8_t *out, size_t out_size, size_t *rec_len);
+
+// Parse one record from the front of in; *consumed allows back-to-back records
+int record_parse(const uint8_t *in, size_t in_len, record_view_t *rec, size_t *consumed);
+
+#endif // RECORD_H
@@ -0,0 +1,173 @@
+#include <string.h>
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "record_cbc.h"
+#include "rng_service.h"
+#include "crypto_arena.h"
+
+#define RECORD_CBC_CT_OFFSET  RECORD_LEN(16, 0, 0)   // header + IV + ct_len
+
+/**
+ * @brief Encrypt pt into a self-describing AES-CBC record, compressing it
+ *        first when that makes the record smaller.
+ *
+ * Compression has to happen before encryption: ciphertext looks random
+ * and does not compress. The compressed stream is written straight into
+ * the ciphertext slot of out and encrypted in place, so no staging buffer
+ * is needed. It is only kept if it saves at least one AES block (CBC
+ * rounds every length up to 16 bytes anyway); otherwise the record holds
+ * the raw plaintext and RECORD_FLAG_LZSS stays clear.
+ *
+ * IMPORTANT NOTES:
+ *  - Compression leaks the compressibility of the plaintext through the
+ *    record length. Do not compress records that mix secrets with
+ *    attacker-controlled data (CRIME/BREACH style attacks)
+ *  - out_size >= RECORD_CBC_MAX_LEN(len) is always enough
+ *  - pt and out must not overlap
+ *  - The IV comes from rng_service_get_iv()
+ *
+ * @param[in]     key       Keyed handle from aes_cbc_key_create()
+ * @param[in]     key_id    Key identifier stored in the record header
+ * @param[in,out] work      LZSS state (2 KB), or NULL to store uncompressed
+ * @param[in]     pt        Plaintext (may be NULL if len == 0)
+ * @param[in]     len       Plaintext length in bytes
+ * @param[out]    out       Record buffer
+ * @param[in]     out_size  Record buffer size in bytes
+ * @param[out]    rec_len   Record length in bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 output buffer too small
+ *         otherwise: mbedTLS error code
+ */
+int record_cbc_seal(const aes_cbc_key_t *key, uint16_t key_id, lzss_work_t *work,
+                    const uint8_t *pt, size_t len,
+                    uint8_t *out, size_t out_size, size_t *rec_len)
+{
+    int ret = 0;
+    uint8_t iv[16];
+    uint8_t *ct = NULL;
+    const uint8_t *payload = pt;
+    size_t payload_len = len;
+    size_t ct_len = 0;
+    size_t dirty = 0;                // bytes after RECORD_CBC_CT_OFFSET lzss_compress() may have written
+    uint8_t flags = 0;
+
+    if (key == NULL || (pt == NULL && len != 0) || out == NULL || rec_len == NULL) {
+        return -1;
+    }
+
+    if (work != NULL && out_size > RECORD_CBC_CT_OFFSET) {
+        /*  Keep the compressed form only if it ends up at least one block
+         *  shorter, and only if its record fits in out_size.
+         */
+        size_t limit = len - (len % 16);
+        size_t room = (out_size - RECORD_CBC_CT_OFFSET) & ~(size_t)15;
+        size_t c_len = 0;
+
+        if (room < limit) {
+            limit = room;
+        }
+        if (limit > 0) {
+            /*  Even a failed attempt may leave compressed plaintext behind */
+            dirty = limit - 1;
+            if (lzss_compress(work, pt, len, out + RECORD_CBC_CT_OFFSET, limit - 1, &c_len) == 0) {
+                payload = out + RECORD_CBC_CT_OFFSET;
+                payload_len = c_len;
+                flags = RECORD_FLAG_LZSS;
+            }
+        }
+    }
+
+    rng_service_get_iv(iv, sizeof(iv));
+    ret = record_write_begin(out, out_size, RECORD_ALG_AES_CBC_PKCS7, flags, key_id,
+                             iv, sizeof(iv), AES_CBC_PKCS7_CIPHERTEXT_LEN(payload_len), 0,
+                             &ct, NULL, rec_len);
+    if (ret != 0) {
+        ret = (ret == -4) ? -1 : ret;
+        goto cleanup;
+    }
+    if (payload == NULL) {
+        payload = ct;                // len == 0: nothing is read, any valid pointer will do
+    }
+
+    /*  ct == payload when compressed: CBC encryption in place */
+    ret = aes_cbc_key_encrypt_pkcs7_into(key, iv, payload, payload_len,
+                                         ct, AES_CBC_PKCS7_CIPHERTEXT_LEN(payload_len), &ct_len);
+
+cleanup:
+    if (ret != 0 && dirty > 0) {
+        /*  out may still hold (part of) the compressed plaintext. On success
+         *  the ciphertext, at least len + 1 bytes, has overwritten it.
+         */
+        mbedtls_platform_zeroize(out + RECORD_CBC_CT_OFFSET, dirty);
+    }
+    return ret;
+}
+
+/**
+ * @brief Decrypt (and decompress) a record written by record_cbc_seal().
+ *
+ * Parse the record with record_parse() first, pick the key from
+ * rec->key_id, then call this. Uncompressed records decrypt straight
+ * into pt; compressed ones go through a scratch buffer of rec->ct_len
+ * bytes (task arena, see crypto_scratch_alloc()) that is wiped on release.
+ *
+ * @param[in]  key      Keyed handle for rec->key_id
+ * @param[in]  rec      View from record_parse()
+ * @param[out] pt       Plaintext buffer
+ * @param[in]  pt_size  Plaintext buffer size in bytes
+ * @param[out] pt_len   Plaintext length in bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         -2 not an AES-CBC record / invalid IV or ciphertext length
+ *         -3 plaintext buffer too small
+ *         -4 invalid PKCS#7 padding
+ *         -5 corrupt compressed payload
+ *         -6 out of memory
+ *         otherwise: mbedTLS error code
+ */
+int record_cbc_open(const aes_cbc_key_t *key, const record_view_t *rec,
+                    uint8_t *pt, size_t pt_size, size_t *pt_len)
+{
+    int ret = 0;
+    uint8_t *tmp = NULL;
+    size_t tmp_len = 0;
+
+    if (key == NULL || rec == NULL || pt == NULL || pt_len == NULL) {
+        return -1;
+    }
+    if (rec->alg != RECORD_ALG_AES_CBC_PKCS7 || rec->iv_len != 16 || rec->ct_len == 0) {
+        return -2;
+    }
+
+    if ((rec->flags & RECORD_FLAG_LZSS) == 0) {
+        return aes_cbc_key_decrypt_pkcs7_into(key, rec->iv, rec->ct, rec->ct_len,
+                                              pt, pt_size, pt_len);
+    }
+
+    tmp = crypto_scratch_alloc(rec->ct_len);
+    if (tmp == NULL) {
+        return -6;
+    }
+
+    ret = aes_cbc_key_decrypt_pkcs7_into(key, rec->iv, rec->ct, rec->ct_len,
+                                         tmp, rec->ct_len, &tmp_len);
+    if (ret != 0) {
+        goto cleanup;
+    }
+
+    ret = lzss_decompress(tmp, tmp_len, pt, pt_size, pt_len);
+    if (ret == -2) {
+        ret = -3;
+    } else if (ret != 0) {
+        ret = -5;
+    }
+    if (ret != 0) {
+        mbedtls_platform_zeroize(pt, pt_size);   // never hand out partial plaintext
+    }
+
+cleanup:
+    crypto_scratch_free(tmp, rec->ct_len);
+    return ret;
+}
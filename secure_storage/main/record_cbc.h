@@ -0,0 +1,22 @@
+#ifndef RECORD_CBC_H
+#define RECORD_CBC_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint16_t
+#include "aes_cbc.h"  // aes_cbc_key_t, AES_CBC_PKCS7_CIPHERTEXT_LEN
+#include "record.h"   // record_view_t
+#include "lzss.h"     // lzss_work_t
+
+// Largest record record_cbc_seal() can produce for len plaintext bytes
+#define RECORD_CBC_MAX_LEN(len)  RECORD_LEN(16, AES_CBC_PKCS7_CIPHERTEXT_LEN(len), 0)
+
+// [optional LZSS] -> AES-CBC + PKCS#7 -> record. work == NULL: never compress
+int record_cbc_seal(const aes_cbc_key_t *key, uint16_t key_id, lzss_work_t *work,
+                    const uint8_t *pt, size_t len,
+                    uint8_t *out, size_t out_size, size_t *rec_len);
+
+// Parsed record -> plaintext (decompressed if RECORD_FLAG_LZSS is set)
+int record_cbc_open(const aes_cbc_key_t *key, const record_view_t *rec,
+                    uint8_t *pt, size_t pt_size, size_t *pt_len);
+
+#endif // RECORD_CBC_H
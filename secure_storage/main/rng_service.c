@@ -0,0 +1,426 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"           // esp_timer_get_time()
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/platform_util.h" // mbedtls_platform_zeroize()
+#include "rng_service.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#endif
+
+static const char *TAG = "RNG_SVC";
+
+#define RNG_SLOT_LEN     16
+#define RNG_TASK_STACK   3072
+#define RNG_TASK_PRIO    1           // just above idle: refilling is never urgent
+#define RNG_PERS         "secure_storage-iv"
+
+/* Single producer (refill task) / multiple consumers ring.
+ * head and tail only grow (wrap at 2^32, RNG_POOL_SLOTS divides it):
+ * slots [head, tail) are filled, the producer owns [tail, head + SLOTS).
+ */
+static uint8_t s_pool[RNG_POOL_SLOTS][RNG_SLOT_LEN];
+static volatile uint32_t s_head;     // next slot to pop (consumers, CAS)
+static volatile uint32_t s_tail;     // next slot to fill (producer only)
+
+static mbedtls_ctr_drbg_context s_drbg;
+static rng_stats_t s_stats;
+static volatile bool s_running = false;
+static bool s_starting = false;      // rng_service_start() in progress (under STATE_LOCK)
+static volatile bool s_stop = false;
+static int64_t s_last_reseed_us;
+
+/* mbedTLS entropy callback: the hardware RNG (RF noise / SAR ADC on the ESP32) */
+static int rng_entropy(void *ctx, unsigned char *out, size_t len)
+{
+    (void)ctx;
+    esp_fill_random(out, len);
+    return 0;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+static pthread_mutex_t s_drbg_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t s_thread;
+
+static pthread_mutex_t s_state_lock = PTHREAD_MUTEX_INITIALIZER;   // s_running / s_starting
+
+#define DRBG_LOCK()    pthread_mutex_lock(&s_drbg_lock)
+#define DRBG_UNLOCK()  pthread_mutex_unlock(&s_drbg_lock)
+#define STATE_LOCK()   pthread_mutex_lock(&s_state_lock)
+#define STATE_UNLOCK() pthread_mutex_unlock(&s_state_lock)
+#define STATE_YIELD()  sched_yield()
+
+static void refill_wake(void)
+{
+    pthread_cond_signal(&s_wake);
+}
+
+#else // FreeRTOS
+
+static SemaphoreHandle_t s_drbg_lock = NULL;
+static SemaphoreHandle_t s_stopped = NULL;
+static TaskHandle_t s_task = NULL;
+
+static portMUX_TYPE s_state_mux = portMUX_INITIALIZER_UNLOCKED;   // s_running / s_starting
+
+#define DRBG_LOCK()    xSemaphoreTake(s_drbg_lock, portMAX_DELAY)
+#define DRBG_UNLOCK()  xSemaphoreGive(s_drbg_lock)
+#define STATE_LOCK()   taskENTER_CRITICAL(&s_state_mux)
+#define STATE_UNLOCK() taskEXIT_CRITICAL(&s_state_mux)
+#define STATE_YIELD()  vTaskDelay(1)
+
+static void refill_wake(void)
+{
+    if (s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
+
+/* Producer: fill every free slot, in contiguous runs (one DRBG call per run) */
+static void pool_refill(void)
+{
+    bool filled = false;
+
+    DRBG_LOCK();
+    for (;;) {
+        uint32_t tail = s_tail;
+        uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+        uint32_t free_slots = RNG_POOL_SLOTS - (tail - head);
+        if (free_slots == 0) {
+            break;
+        }
+
+        uint32_t idx = tail % RNG_POOL_SLOTS;
+        uint32_t run = RNG_POOL_SLOTS - idx;                  // up to the wrap
+        if (run > free_slots) {
+            run = free_slots;
+        }
+        if (run > MBEDTLS_CTR_DRBG_MAX_REQUEST / RNG_SLOT_LEN) {
+            run = MBEDTLS_CTR_DRBG_MAX_REQUEST / RNG_SLOT_LEN;
+        }
+
+        if (mbedtls_ctr_drbg_random(&s_drbg, s_pool[idx], run * RNG_SLOT_LEN) != 0) {
+            ESP_LOGE(TAG, "DRBG failed, pool not refilled");
+            break;
+        }
+        __atomic_store_n(&s_tail, tail + run, __ATOMIC_RELEASE);
+        filled = true;
+    }
+    if (filled) {
+        s_stats.refills++;
+    }
+    DRBG_UNLOCK();
+}
+
+static void drbg_reseed_if_due(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (now - s_last_reseed_us < (int64_t)RNG_RESEED_PERIOD_MS * 1000) {
+        return;
+    }
+    DRBG_LOCK();
+    if (mbedtls_ctr_drbg_reseed(&s_drbg, NULL, 0) == 0) {
+        s_stats.reseeds++;
+        s_last_reseed_us = now;
+    } else {
+        ESP_LOGE(TAG, "DRBG reseed failed");
+    }
+    DRBG_UNLOCK();
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+static void *refill_thread(void *arg)
+{
+    (void)arg;
+
+    while (!s_stop) {
+        pool_refill();
+        drbg_reseed_if_due();
+
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += 1;              // also wakes up for the reseed schedule
+        DRBG_LOCK();
+        if (!s_stop) {
+            pthread_cond_timedwait(&s_wake, &s_drbg_lock, &ts);
+        }
+        DRBG_UNLOCK();
+    }
+    return NULL;
+}
+
+static int refill_task_start(void)
+{
+    return (pthread_create(&s_thread, NULL, refill_thread, NULL) == 0) ? 0 : -1;
+}
+
+static void refill_task_stop(void)
+{
+    DRBG_LOCK();
+    s_stop = true;
+    pthread_cond_signal(&s_wake);
+    DRBG_UNLOCK();
+    pthread_join(s_thread, NULL);
+}
+
+#else // FreeRTOS
+
+static void refill_task(void *arg)
+{
+    (void)arg;
+
+    while (!s_stop) {
+        pool_refill();
+        drbg_reseed_if_due();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));   // low water or reseed tick
+    }
+
+    xSemaphoreGive(s_stopped);
+    vTaskDelete(NULL);
+}
+
+static int refill_task_start(void)
+{
+    if (s_drbg_lock == NULL) {
+        s_drbg_lock = xSemaphoreCreateMutex();
+    }
+    if (s_stopped == NULL) {
+        s_stopped = xSemaphoreCreateBinary();
+    }
+    if (s_drbg_lock == NULL || s_stopped == NULL) {
+        return -1;
+    }
+    return (xTaskCreate(refill_task, "rng_refill", RNG_TASK_STACK, NULL,
+                        RNG_TASK_PRIO, &s_task) == pdPASS) ? 0 : -1;
+}
+
+static void refill_task_stop(void)
+{
+    s_stop = true;
+    xTaskNotifyGive(s_task);
+    xSemaphoreTake(s_stopped, portMAX_DELAY);
+    s_task = NULL;
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
+
+/**
+ * @brief Seed the CTR_DRBG, fill the IV pool and start the refill task.
+ *
+ * The DRBG (AES-256 CTR_DRBG, SP 800-90A) is seeded from esp_fill_random()
+ * and reseeded from it every RNG_RESEED_PERIOD_MS by the refill task.
+ *
+ * IMPORTANT NOTES:
+ *  - On the ESP32, esp_fill_random() is only a true RNG while RF (Wi-Fi/BT)
+ *    or the bootloader entropy source is enabled; start the service after
+ *    Wi-Fi, or with the SAR ADC entropy source (bootloader_random_enable())
+ *
+ * @return 0 on success (also if already running)
+ *         -1 task/thread creation failed
+ *         otherwise: mbedTLS error code (seeding failed)
+ */
+int rng_service_start(void)
+{
+    int ret;
+
+    /*  Test-and-set under the state lock: concurrent starts seed the DRBG once */
+    STATE_LOCK();
+    while (s_starting) {
+        STATE_UNLOCK();
+        STATE_YIELD();
+        STATE_LOCK();
+    }
+    if (s_running) {
+        STATE_UNLOCK();
+        return 0;
+    }
+    s_starting = true;
+    STATE_UNLOCK();
+
+    mbedtls_ctr_drbg_init(&s_drbg);
+    ret = mbedtls_ctr_drbg_seed(&s_drbg, rng_entropy, NULL,
+                                (const unsigned char *)RNG_PERS, sizeof(RNG_PERS) - 1);
+    if (ret != 0) {
+        goto fail;
+    }
+    s_last_reseed_us = esp_timer_get_time();
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_head = s_tail = 0;
+    s_stop = false;
+
+    if (refill_task_start() != 0) {
+        ret = -1;
+        goto fail;
+    }
+
+    STATE_LOCK();
+    __atomic_store_n(&s_running, true, __ATOMIC_RELEASE);
+    s_starting = false;
+    STATE_UNLOCK();
+    refill_wake();
+
+    ESP_LOGI(TAG, "CTR_DRBG seeded, IV pool of %d slots", RNG_POOL_SLOTS);
+    return 0;
+
+fail:
+    mbedtls_ctr_drbg_free(&s_drbg);
+    STATE_LOCK();
+    s_starting = false;
+    STATE_UNLOCK();
+    return ret;
+}
+
+/**
+ * @brief Stop the refill task and wipe the DRBG state and every pooled IV.
+ *
+ * Consumers that race the stop fall back to esp_fill_random(): a pop
+ * re-checks the running flag after its CAS, and the DRBG path checks it
+ * under the DRBG lock, which the wipe below also takes.
+ */
+void rng_service_stop(void)
+{
+    STATE_LOCK();
+    bool running = s_running;
+    __atomic_store_n(&s_running, false, __ATOMIC_SEQ_CST);   // consumers fall back to esp_fill_random()
+    STATE_UNLOCK();
+    if (!running) {
+        return;
+    }
+    refill_task_stop();
+
+    DRBG_LOCK();
+    mbedtls_ctr_drbg_free(&s_drbg);  // zeroizes the key and V
+    mbedtls_platform_zeroize(s_pool, sizeof(s_pool));
+    s_head = s_tail = 0;
+    DRBG_UNLOCK();
+}
+
+/**
+ * @brief Take a fresh IV / nonce (hot path).
+ *
+ * Lock-free: copy the slot at head, then claim it with a CAS on head. If
+ * another task claimed it first, the copy is dropped and the pop retried.
+ * The producer only writes a slot once head has moved past it.
+ *
+ * IMPORTANT NOTES:
+ *  - Pool empty (burst faster than the refill): served from the DRBG
+ *    under its lock, counted in stats.misses
+ *  - Service stopped: esp_fill_random(), so callers never need a check
+ *
+ * @param[out] out  IV / nonce buffer
+ * @param[in]  len  1..16 bytes
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code (fallback path)
+ */
+int rng_service_get_iv(uint8_t *out, size_t len)
+{
+    uint8_t slot[RNG_SLOT_LEN];
+
+    if (out == NULL || len == 0 || len > RNG_SLOT_LEN) {
+        return -1;
+    }
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        esp_fill_random(out, len);
+        return 0;
+    }
+
+    uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            __atomic_add_fetch(&s_stats.misses, 1, __ATOMIC_RELAXED);
+            refill_wake();
+            return rng_service_random(out, len);
+        }
+
+        memcpy(slot, s_pool[head % RNG_POOL_SLOTS], RNG_SLOT_LEN);
+        if (__atomic_compare_exchange_n(&s_head, &head, head + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            break;                   // on failure head was reloaded
+        }
+    }
+
+    /*  A stop may have wiped the pool while the slot was copied */
+    if (!__atomic_load_n(&s_running, __ATOMIC_SEQ_CST)) {
+        mbedtls_platform_zeroize(slot, sizeof(slot));
+        esp_fill_random(out, len);
+        return 0;
+    }
+
+    memcpy(out, slot, len);
+    mbedtls_platform_zeroize(slot, sizeof(slot));
+    __atomic_add_fetch(&s_stats.pops, 1, __ATOMIC_RELAXED);
+
+    if (s_tail - (head + 1) == RNG_POOL_LOW_WATER) {
+        refill_wake();               // once per crossing of the low-water mark
+    }
+    return 0;
+}
+
+/**
+ * @brief Random bytes straight from the DRBG (serialized, not for the hot path).
+ *
+ * @return 0 on success
+ *         -1 invalid args
+ *         otherwise: mbedTLS error code
+ */
+int rng_service_random(uint8_t *out, size_t len)
+{
+    int ret = 0;
+
+    if (out == NULL && len != 0) {
+        return -1;
+    }
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        esp_fill_random(out, len);
+        return 0;
+    }
+
+    DRBG_LOCK();
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        DRBG_UNLOCK();               // stopped meanwhile: the DRBG is freed
+        esp_fill_random(out, len);
+        return 0;
+    }
+    while (ret == 0 && len > 0) {
+        size_t n = (len < MBEDTLS_CTR_DRBG_MAX_REQUEST) ? len : MBEDTLS_CTR_DRBG_MAX_REQUEST;
+        ret = mbedtls_ctr_drbg_random(&s_drbg, out, n);
+        out += n;
+        len -= n;
+    }
+    DRBG_UNLOCK();
+    return ret;
+}
+
+/**
+ * @brief Copy of the pool counters.
+ */
+void rng_service_get_stats(rng_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    out->pops = __atomic_load_n(&s_stats.pops, __ATOMIC_RELAXED);
+    out->misses = __atomic_load_n(&s_stats.misses, __ATOMIC_RELAXED);
+    out->refills = __atomic_load_n(&s_stats.refills, __ATOMIC_RELAXED);
+    out->reseeds = __atomic_load_n(&s_stats.reseeds, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,33 @@
+#ifndef RNG_SERVICE_H
+#define RNG_SERVICE_H
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint8_t, uint32_t
+
+/* Randomness service: CTR_DRBG seeded from esp_fill_random() plus a ring of
+ * pre-generated 16-byte IVs / nonces, kept topped up by a low-priority task
+ * (a thread on the linux target). Taking an IV is a lock-free pop.
+ */
+#define RNG_POOL_SLOTS          64       // power of two, 16 bytes each
+#define RNG_POOL_LOW_WATER      (RNG_POOL_SLOTS / 4)
+#define RNG_RESEED_PERIOD_MS    60000    // DRBG reseed from esp_fill_random()
+
+typedef struct {
+    uint32_t pops;                   // IVs served from the pool
+    uint32_t misses;                 // pool empty: served straight from the DRBG
+    uint32_t refills;                // refill rounds of the background task
+    uint32_t reseeds;
+} rng_stats_t;
+
+int  rng_service_start(void);
+void rng_service_stop(void);         // zeroizes the DRBG state and the pool
+
+// len <= 16. Falls back to esp_fill_random() while the service is stopped.
+int  rng_service_get_iv(uint8_t *out, size_t len);
+
+// Bulk bytes straight from the DRBG (keys, salts), serialized by a lock
+int  rng_service_random(uint8_t *out, size_t len);
+
+void rng_service_get_stats(rng_stats_t *out);
+
+#endif // RNG_SERVICE_H
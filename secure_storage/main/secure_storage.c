@@ -1,7 +1,25 @@
 #include <stdio.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "aes_cbc.h"
+#include "aes_cbc_stream.h"
+#include "aes_cbc_iov.h"
+#include "aes_ctr.h"
+#include "aes_gcm.h"
+#include "aes_cbc_hmac.h"
+#include "aead.h"
+#include "record.h"
+#include "pkcs_7.h"
+#include "rng_service.h"
+#include "crypto_arena.h"
+#include "bench.h"
 #include "esp_log.h"
 #include "esp_system.h"          // esp_fill_random()
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "mbedtls/aes.h"
 #include "esp_random.h"
 
@@ -15,6 +33,407 @@ static void print_hex(const char *label, const uint8_t *buf, size_t len)
     printf("\n");
 }
 
+/* Encrypt msg in small chunks with the streaming API and check that the
+ * result matches the one-shot ciphertext (same key, same IV).
+ */
+static void demo_stream(const uint8_t *key, unsigned keybits, const uint8_t iv[16],
+                        const uint8_t *msg, size_t msg_len,
+                        const uint8_t *expected, size_t expected_len)
+{
+    uint8_t ct[AES_CBC_PKCS7_CIPHERTEXT_LEN(128)];
+    size_t ct_len = 0;
+    size_t n = 0;
+    const size_t chunk = 7;          // deliberately not a multiple of 16
+
+    if (AES_CBC_PKCS7_CIPHERTEXT_LEN(msg_len) > sizeof(ct)) {
+        return;
+    }
+
+    aes_cbc_key_t *handle = aes_cbc_key_create(key, keybits);
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "aes_cbc_key_create failed");
+        return;
+    }
+
+    aes_cbc_stream_t stream;
+    aes_cbc_stream_init(&stream, handle, AES_CBC_ENCRYPT, iv);
+
+    for (size_t off = 0; off < msg_len; off += chunk) {
+        size_t len = (msg_len - off < chunk) ? (msg_len - off) : chunk;
+        aes_cbc_stream_update(&stream, msg + off, len, ct + ct_len, sizeof(ct) - ct_len, &n);
+        ct_len += n;
+    }
+    aes_cbc_stream_final(&stream, ct + ct_len, sizeof(ct) - ct_len, &n);
+    ct_len += n;
+
+    bool same = (ct_len == expected_len) && memcmp(ct, expected, ct_len) == 0;
+    ESP_LOGI(TAG, "Streaming encrypt (%zu-byte chunks): %s one-shot", chunk,
+             same ? "matches" : "DIFFERS from");
+
+    aes_cbc_stream_free(&stream);
+    aes_cbc_key_destroy(handle);
+}
+
+/* A record built from separate fragments: header struct + payload + trailer.
+ * Encrypted with gather (no concatenation buffer) and decrypted with scatter
+ * straight back into the three destinations.
+ */
+typedef struct {
+    uint16_t type;
+    uint16_t seq;
+    uint32_t timestamp;
+} demo_record_hdr_t;
+
+static void demo_iov(const uint8_t *key, unsigned keybits, const uint8_t iv[16])
+{
+    demo_record_hdr_t hdr = { .type = 1, .seq = 42, .timestamp = 123456 };
+    const char *payload = "temperature=23.5;humidity=40";
+    const char trailer[4] = "END";
+
+    uint8_t ct[AES_CBC_PKCS7_CIPHERTEXT_LEN(sizeof(hdr) + 64 + sizeof(trailer))];
+    size_t ct_len = 0;
+
+    aes_cbc_key_t *handle = aes_cbc_key_create(key, keybits);
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "aes_cbc_key_create failed");
+        return;
+    }
+
+    aes_cbc_seg_t segs[] = {
+        { (const uint8_t *)&hdr, sizeof(hdr) },
+        { (const uint8_t *)payload, strlen(payload) },
+        { (const uint8_t *)trailer, sizeof(trailer) },
+    };
+    int ret = aes_cbc_key_encryptv_pkcs7_into(handle, iv, segs, 3, ct, sizeof(ct), &ct_len);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Gather encrypt failed: %d", ret);
+        aes_cbc_key_destroy(handle);
+        return;
+    }
+    print_hex("CIPHERTEXT (gather)", ct, ct_len);
+
+    demo_record_hdr_t hdr_out;
+    char payload_out[64] = { 0 };
+    char trailer_out[4];
+    size_t pt_len = 0;
+
+    aes_cbc_buf_t bufs[] = {
+        { (uint8_t *)&hdr_out, sizeof(hdr_out) },
+        { (uint8_t *)payload_out, strlen(payload) },   // receiver knows the layout
+        { (uint8_t *)trailer_out, sizeof(trailer_out) },
+    };
+    ret = aes_cbc_key_decryptv_pkcs7_into(handle, iv, ct, ct_len, bufs, 3, &pt_len);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Scatter decrypt failed: %d", ret);
+    } else {
+        ESP_LOGI(TAG, "Scatter decrypt: seq=%u payload=%s trailer=%s",
+                 hdr_out.seq, payload_out, trailer_out);
+    }
+
+    aes_cbc_key_destroy(handle);
+}
+
+/* Encrypt a 4 KB blob with AES-CTR, then read 64 bytes from its middle
+ * without touching anything before them (O(1) seek).
+ */
+static void demo_ctr(const uint8_t *key, unsigned keybits)
+{
+    const size_t blob_len = 4096;
+    const size_t offset = 2000;
+    uint8_t nonce[16] = { 0 };
+    uint8_t window[64];
+
+    rng_service_get_iv(nonce, 12);   // 96-bit random nonce, 32-bit block counter
+
+    uint8_t *blob = crypto_scratch_alloc(blob_len);
+    aes_cbc_key_t *handle = aes_cbc_key_create(key, keybits);
+    if (blob == NULL || handle == NULL) {
+        ESP_LOGE(TAG, "demo_ctr: out of memory");
+        goto done;
+    }
+
+    for (size_t i = 0; i < blob_len; i++) {
+        blob[i] = (uint8_t)i;        // known pattern
+    }
+    aes_ctr_crypt_at(handle, nonce, 0, blob, blob_len, blob);          // encrypt in place
+
+    aes_ctr_crypt_at(handle, nonce, offset, blob + offset, sizeof(window), window);
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(window); i++) {
+        ok &= (window[i] == (uint8_t)(offset + i));
+    }
+    ESP_LOGI(TAG, "CTR random access: %u bytes at offset %u %s", (unsigned)sizeof(window),
+             (unsigned)offset, ok ? "decrypted correctly" : "MISMATCH");
+
+done:
+    aes_cbc_key_destroy(handle);
+    crypto_scratch_free(blob, blob_len);
+}
+
+/* AES-GCM: encrypt + authenticate a record, then show a flipped bit is rejected */
+static void demo_gcm(const uint8_t *key, unsigned keybits, const uint8_t *msg, size_t len)
+{
+    static const uint8_t aad[] = "record-id:7";   // authenticated, stored in clear
+    uint8_t nonce[AES_GCM_IV_LEN];
+    uint8_t tag[AES_GCM_TAG_LEN];
+
+    rng_service_get_iv(nonce, sizeof(nonce));
+
+    uint8_t *ct = crypto_scratch_alloc(len);
+    uint8_t *pt = crypto_scratch_alloc(len + 1);
+    aes_gcm_key_t *handle = aes_gcm_key_create(key, keybits);
+    if (ct == NULL || pt == NULL || handle == NULL) {
+        ESP_LOGE(TAG, "demo_gcm: out of memory");
+        goto done;
+    }
+
+    int ret = aes_gcm_encrypt_into(handle, nonce, sizeof(nonce), aad, sizeof(aad) - 1,
+                                   msg, len, ct, tag);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "GCM encrypt failed: -0x%04X", (unsigned)(-ret));
+        goto done;
+    }
+    print_hex("GCM TAG", tag, sizeof(tag));
+
+    ret = aes_gcm_decrypt_into(handle, nonce, sizeof(nonce), aad, sizeof(aad) - 1,
+                               ct, len, tag, pt);
+    pt[ret == 0 ? len : 0] = '\0';
+    ESP_LOGI(TAG, "GCM decrypt: %s", ret == 0 ? (char *)pt : "FAILED");
+
+    ct[0] ^= 0x01;                   // tamper with one ciphertext bit
+    ret = aes_gcm_decrypt_into(handle, nonce, sizeof(nonce), aad, sizeof(aad) - 1,
+                               ct, len, tag, pt);
+    ESP_LOGI(TAG, "GCM tampered record: %s", ret == -3 ? "rejected" : "ACCEPTED");
+
+done:
+    aes_gcm_key_destroy(handle);
+    crypto_scratch_free(pt, len + 1);
+    crypto_scratch_free(ct, len);
+}
+
+/* AES-CBC + HMAC-SHA256 (encrypt-then-MAC) for CBC-only peers */
+static void demo_etm(const uint8_t *key, unsigned keybits, const uint8_t *msg, size_t len)
+{
+    // Demo MAC key; derive enc/mac keys independently (HKDF) in production
+    static const uint8_t mac_key[32] = {
+        0x4b,0x61,0x75,0x74,0x68,0x2d,0x64,0x65,0x6d,0x6f,0x2d,0x6b,0x65,0x79,0x2d,0x30,
+        0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x61,0x62,0x63,0x64,0x65,0x66,0x67,
+    };
+    static const uint8_t aad[] = "record-id:8";
+    uint8_t iv[16];
+    size_t sealed_len = 0;
+    size_t pt_len = 0;
+
+    rng_service_get_iv(iv, sizeof(iv));
+
+    uint8_t *sealed = crypto_scratch_alloc(AES_CBC_HMAC_SEALED_LEN(len));
+    uint8_t *pt = crypto_scratch_alloc(len + 1);
+    aes_cbc_hmac_key_t *handle = aes_cbc_hmac_key_create(key, keybits, mac_key, sizeof(mac_key));
+    if (sealed == NULL || pt == NULL || handle == NULL) {
+        ESP_LOGE(TAG, "demo_etm: out of memory");
+        goto done;
+    }
+
+    int ret = aes_cbc_hmac_encrypt_into(handle, iv, aad, sizeof(aad) - 1, msg, len,
+                                        sealed, AES_CBC_HMAC_SEALED_LEN(len), &sealed_len);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "CBC-HMAC encrypt failed: -0x%04X", (unsigned)(-ret));
+        goto done;
+    }
+    print_hex("CBC-HMAC TAG", sealed + sealed_len - AES_CBC_HMAC_TAG_LEN, AES_CBC_HMAC_TAG_LEN);
+
+    ret = aes_cbc_hmac_decrypt_into(handle, aad, sizeof(aad) - 1, sealed, sealed_len,
+                                    pt, len, &pt_len);
+    pt[ret == 0 ? pt_len : 0] = '\0';
+    ESP_LOGI(TAG, "CBC-HMAC decrypt: %s", ret == 0 ? (char *)pt : "FAILED");
+
+    sealed[20] ^= 0x01;              // tamper with one ciphertext bit
+    ret = aes_cbc_hmac_decrypt_into(handle, aad, sizeof(aad) - 1, sealed, sealed_len,
+                                    pt, len, &pt_len);
+    ESP_LOGI(TAG, "CBC-HMAC tampered record: %s", ret == -5 ? "rejected before decrypt" : "ACCEPTED");
+
+done:
+    aes_cbc_hmac_key_destroy(handle);
+    crypto_scratch_free(pt, len + 1);
+    crypto_scratch_free(sealed, AES_CBC_HMAC_SEALED_LEN(len));
+}
+
+/* Same record sealed with each AEAD, the header byte picks the algorithm on open */
+static void demo_aead(const uint8_t *key, const uint8_t *msg, size_t len)
+{
+    static const uint8_t algs[] = { AEAD_ALG_AES_GCM, AEAD_ALG_CHACHA20_POLY1305 };
+    static const uint8_t aad[] = "record-id:9";
+    uint8_t nonce[AEAD_NONCE_LEN];
+
+    uint8_t *sealed = crypto_scratch_alloc(AEAD_SEALED_LEN(len));
+    uint8_t *pt = crypto_scratch_alloc(len + 1);
+    aead_key_t *handle = aead_key_create(key);
+    if (sealed == NULL || pt == NULL || handle == NULL) {
+        ESP_LOGE(TAG, "demo_aead: out of memory");
+        goto done;
+    }
+
+    for (size_t a = 0; a < sizeof(algs) / sizeof(algs[0]); a++) {
+        size_t sealed_len = 0;
+        size_t pt_len = 0;
+
+        rng_service_get_iv(nonce, sizeof(nonce));
+        int ret = aead_seal(handle, algs[a], nonce, aad, sizeof(aad) - 1, msg, len,
+                            sealed, AEAD_SEALED_LEN(len), &sealed_len);
+        if (ret != 0) {
+            ESP_LOGE(TAG, "%s seal failed: %d", aead_alg_name(algs[a]), ret);
+            continue;
+        }
+        print_hex(aead_alg_name(algs[a]), sealed + sealed_len - AEAD_TAG_LEN, AEAD_TAG_LEN);
+
+        ret = aead_open(handle, aad, sizeof(aad) - 1, sealed, sealed_len, pt, len, &pt_len);
+        pt[ret == 0 ? pt_len : 0] = '\0';
+        ESP_LOGI(TAG, "%s open: %s", aead_alg_name(sealed[0]), ret == 0 ? (char *)pt : "FAILED");
+
+        sealed[0] ^= AEAD_ALG_AES_GCM ^ AEAD_ALG_CHACHA20_POLY1305;   // swap the algorithm byte
+        ret = aead_open(handle, aad, sizeof(aad) - 1, sealed, sealed_len, pt, len, &pt_len);
+        ESP_LOGI(TAG, "%s with swapped alg byte: %s", aead_alg_name(algs[a]),
+                 ret == -3 ? "rejected" : "ACCEPTED");
+    }
+
+done:
+    aead_key_destroy(handle);
+    crypto_scratch_free(pt, len + 1);
+    crypto_scratch_free(sealed, AEAD_SEALED_LEN(len));
+}
+
+/* IV + ciphertext stored together: the record says how to decrypt itself */
+static void demo_record(const uint8_t *key, const uint8_t *msg, size_t len)
+{
+    uint8_t iv[16];
+    uint8_t *ct = NULL;
+    record_view_t view;
+    size_t rec_len = 0;
+    size_t ct_len = 0;
+    size_t used = 0;
+
+    size_t cap = RECORD_LEN(sizeof(iv), AES_CBC_PKCS7_CIPHERTEXT_LEN(len), 0);
+    uint8_t *rec = crypto_scratch_alloc(cap);
+    uint8_t *pt = crypto_scratch_alloc(len + 1);
+    if (rec == NULL || pt == NULL) {
+        ESP_LOGE(TAG, "demo_record: out of memory");
+        goto done;
+    }
+
+    rng_service_get_iv(iv, sizeof(iv));
+    int ret = record_write_begin(rec, cap, RECORD_ALG_AES_CBC_PKCS7, 0, 1, iv, sizeof(iv),
+                                 AES_CBC_PKCS7_CIPHERTEXT_LEN(len), 0, &ct, NULL, &rec_len);
+    if (ret == 0) {
+        ret = aes_cbc_encrypt_pkcs7_into(key, 256, iv, msg, len,
+                                         ct, AES_CBC_PKCS7_CIPHERTEXT_LEN(len), &ct_len);
+    }
+    if (ret != 0) {
+        ESP_LOGE(TAG, "record write failed: %d", ret);
+        goto done;
+    }
+    print_hex("RECORD", rec, rec_len);
+
+    // Only the record is needed from here on: IV, key id and length come from it
+    ret = record_parse(rec, rec_len, &view, &used);
+    if (ret != 0 || view.alg != RECORD_ALG_AES_CBC_PKCS7 || view.iv_len != 16) {
+        ESP_LOGE(TAG, "record parse failed: %d", ret);
+        goto done;
+    }
+
+    size_t pt_len = 0;
+    ret = aes_cbc_decrypt_pkcs7_into(key, 256, view.iv, view.ct, view.ct_len, pt, len, &pt_len);
+    pt[ret == 0 ? pt_len : 0] = '\0';
+    ESP_LOGI(TAG, "Record (key %u, %zu bytes): %s", (unsigned)view.key_id, used,
+             ret == 0 ? (char *)pt : "FAILED");
+
+done:
+    crypto_scratch_free(pt, len + 1);
+    crypto_scratch_free(rec, cap);
+}
+
+/* Known answers for the padding check every CBC decrypt path relies on:
+ * each padding length 0..16, valid and corrupted. A failed call must not
+ * touch *output / *output_len, the in-place variant reports length 0.
+ */
+static void check_pkcs7_unpad(void)
+{
+    uint8_t buf[32];
+    uint8_t sentinel = 0;
+
+    for (unsigned pad = 0; pad <= 16; pad++) {
+        for (int corrupt = 0; corrupt <= 1; corrupt++) {
+            uint8_t *out = &sentinel;
+            size_t out_len = 12345;
+            size_t in_len = 12345;
+
+            for (size_t i = 0; i < sizeof(buf); i++) {
+                buf[i] = (uint8_t)(0xA0 + i);    // never a valid padding byte
+            }
+            memset(buf + sizeof(buf) - pad, (int)pad, pad);
+            if (corrupt) {
+                // first padding byte, or the length byte itself for pad 0..1
+                buf[sizeof(buf) - (pad > 1 ? pad : 1)] ^= (pad > 1) ? 0x01 : 0x40;
+            }
+            bool valid = (pad > 0 && !corrupt);
+
+            int ret = pkcs7_unpad_16(buf, sizeof(buf), &out, &out_len);
+            int ret_in = pkcs7_unpad_16_inplace(buf, sizeof(buf), &in_len);
+            if (valid) {
+                assert(ret == 0 && ret_in == 0);
+                assert(out_len == sizeof(buf) - pad && in_len == out_len);
+                assert(out != &sentinel && memcmp(out, buf, out_len) == 0);
+                free(out);
+            } else {
+                assert(ret == -3 && ret_in == -3);
+                assert(out == &sentinel && out_len == 12345);
+                assert(in_len == 0);
+            }
+        }
+    }
+
+    uint8_t *out = &sentinel;
+    size_t out_len = 12345;
+    assert(pkcs7_unpad_16(buf, 0, &out, &out_len) == -2);
+    assert(pkcs7_unpad_16(buf, 15, &out, &out_len) == -2);
+    assert(pkcs7_unpad_16(NULL, 16, &out, &out_len) == -1);
+    assert(out == &sentinel && out_len == 12345);
+
+    ESP_LOGI(TAG, "PKCS#7 unpad self-check passed");
+}
+
+#if CONFIG_SECURE_STORAGE_RUN_BENCHMARKS
+/* Development images only (menuconfig: Secure storage example). The
+ * benchmarks get their own task and stack, the main task stays small.
+ */
+static void bench_task(void *arg)
+{
+    (void)arg;
+
+    // The arena is per task: the main task's one is not visible here
+    if (crypto_arena_task_init(CRYPTO_ARENA_DEFAULT_SIZE) != 0) {
+        ESP_LOGW(TAG, "bench: no scratch arena, temporaries use the heap");
+    }
+
+    bench_cbc_keyed();
+    bench_cbc_parallel();
+    bench_cbc_storage_report();
+    bench_aes_backends();
+    bench_aead();
+    bench_cbc_multibuffer();
+    bench_cbc_batch();
+    bench_crypto_service();
+    bench_rng_iv();
+    bench_record_compression();
+    bench_pkcs7_timing();
+    bench_scratch_arena();
+
+    ESP_LOGI(TAG, "bench: done, %u bytes of stack never used",
+             (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    crypto_arena_task_deinit();
+    vTaskDelete(NULL);
+}
+#endif
 
 void app_main(void)
 {
@@ -26,9 +445,21 @@ void app_main(void)
         0x2b,0x73,0xae,0xf0,0x85,0x7d,0x77,0x81, 
     };
 
+    check_pkcs7_unpad();
+
+    // IVs / nonces come from the CTR_DRBG pool (esp_fill_random() until it is started)
+    if (rng_service_start() != 0) {
+        ESP_LOGW(TAG, "rng_service_start failed, using esp_fill_random()");
+    }
+
+    // Scratch arena for this task's crypto temporaries, reserved before the heap fragments
+    if (crypto_arena_task_init(CRYPTO_ARENA_DEFAULT_SIZE) != 0) {
+        ESP_LOGW(TAG, "crypto_arena_task_init failed, temporaries use the heap");
+    }
+
     // CBC needs a fresh unpredictable IV per encryption; store/transmit IV alongside ciphertext.
     uint8_t iv[16];
-    esp_fill_random(iv, sizeof(iv));
+    rng_service_get_iv(iv, sizeof(iv));
 
     char *msg = "Hello ESP32! AES-CBC with PKCS#7 padding Espero que esten bien y tenga el gusto de conocerme";
     uint8_t *plaintext = (uint8_t *)msg;
@@ -49,8 +480,16 @@ void app_main(void)
 
     print_hex("CIPHERTEXT", ciphertext, ciphertext_len);
 
+    demo_stream(key, 256, iv, plaintext, plaintext_len, ciphertext, ciphertext_len);
+    demo_iov(key, 256, iv);
+    demo_ctr(key, 256);
+    demo_gcm(key, 256, plaintext, plaintext_len);
+    demo_etm(key, 256, plaintext, plaintext_len);
+    demo_aead(key, plaintext, plaintext_len);
+    demo_record(key, plaintext, plaintext_len);
+
     // IMPORTANT: for decryption use the *same original IV*. Since our encrypt function copied iv_in,
-    // iv[] still contains the original IV. In real usage, you would send/store IV with ciphertext.
+    // iv[] still contains the original IV. In real usage the IV travels with the ciphertext (see demo_record).
     uint8_t *decrypted = NULL;
     size_t decrypted_len = 0;
 
@@ -63,5 +502,34 @@ void app_main(void)
     }
 
     ESP_LOGI(TAG, "Decrypted (%zu bytes): %s", decrypted_len, (char *)decrypted);
-    free(decrypted);
+    crypto_scratch_free(decrypted, decrypted_len + 1);   // wipe the plaintext, then free
+
+    // Same round trip without any heap traffic: caller owned (stack) buffers.
+    uint8_t ct_buf[AES_CBC_PKCS7_CIPHERTEXT_LEN(128)];
+    uint8_t pt_buf[128];
+    size_t ct_len = 0;
+    size_t pt_len = 0;
+
+    ret = aes_cbc_encrypt_pkcs7_into(key, 256, iv, plaintext, plaintext_len,
+                                     ct_buf, sizeof(ct_buf), &ct_len);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Encrypt (into) failed: -0x%04X", (unsigned)(-ret));
+        return;
+    }
+
+    ret = aes_cbc_decrypt_pkcs7_into(key, 256, iv, ct_buf, ct_len,
+                                     pt_buf, sizeof(pt_buf), &pt_len);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Decrypt (into) failed: -0x%04X", (unsigned)(-ret));
+        return;
+    }
+
+    ESP_LOGI(TAG, "Decrypted (into, %zu bytes): %.*s", pt_len, (int)pt_len, (char *)pt_buf);
+
+#if CONFIG_SECURE_STORAGE_RUN_BENCHMARKS
+    if (xTaskCreate(bench_task, "bench", CONFIG_SECURE_STORAGE_BENCH_STACK_SIZE,
+                    NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "bench task not started: out of memory");
+    }
+#endif
 }